@@ -0,0 +1,146 @@
+#include "Benchmark.h"
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <algorithm>
+
+#include "../Chat/Chat.h"
+#include "../Console/Console.h"
+
+
+namespace{
+  using Clock = std::chrono::steady_clock;
+
+  //Параметры замера переходов автомата чата (без запросов серверу)
+  const size_t TRANSITION_STEPS = 2000000;   //Шагов одного чата
+  const size_t FLEET_SESSIONS = 4000;        //Чатов в одном процессе
+  const size_t FLEET_STEPS = 500;            //Шагов каждого чата
+}
+
+
+//Шаги автомата одного чата: неверный ввод в меню и путь по меню регистрации
+static void benchmarkTransitions();
+
+//Шаги автомата многих чатов в потоках на всех ядрах
+static void benchmarkFleet();
+
+//Сценарий из повторяющихся строк
+static std::string repeat(const std::string& lines, size_t count);
+
+//Время от заданного момента, мс
+static double elapsedMs(Clock::time_point start);
+
+
+
+void benchmark::run()
+{
+  benchmarkTransitions();
+  benchmarkFleet();
+}
+
+
+
+static void benchmarkTransitions()
+{
+  std::cout << "Chat transitions: " << TRANSITION_STEPS << " steps, no server requests\n";
+  console::setSilent(true);
+  auto chat = Chat::create();
+
+  //Неверный ввод - снова то же состояние
+  std::istringstream invalid(repeat("x\n", TRANSITION_STEPS));
+  console::setInput(&invalid);
+  auto start = Clock::now();
+  for (size_t i = 0; i < TRANSITION_STEPS; ++i) {
+    chat->process();
+  }
+  const double invalidMs = elapsedMs(start);
+
+  //Меню занятого Логина: неверный ввод -> назад к регистрации -> недопустимый Логин
+  const size_t cycles = TRANSITION_STEPS / 3;
+  std::istringstream menu(repeat("x\n2\n!\n", cycles));
+  console::setInput(&menu);
+  start = Clock::now();
+  for (size_t i = 0; i < cycles; ++i) {
+    chat->transitionTo<LoginRegistered>();
+    chat->process();
+    chat->process();
+    chat->process();
+  }
+  const double menuMs = elapsedMs(start);
+
+  console::setInput(nullptr);
+  console::setSilent(false);
+  std::cout << "  " << std::fixed << std::setprecision(0)
+            << "invalid input: " << TRANSITION_STEPS / invalidMs * 1000 << " steps/s, "
+            << std::setprecision(1) << invalidMs * 1e6 / TRANSITION_STEPS << " ns per step\n"
+            << "  " << std::setprecision(0)
+            << "menu path:     " << cycles * 3 / menuMs * 1000 << " steps/s, "
+            << std::setprecision(1) << menuMs * 1e6 / (cycles * 3) << " ns per step" << std::endl;
+}
+
+
+
+static void benchmarkFleet()
+{
+  const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+  std::cout << "Chat fleet: " << FLEET_SESSIONS << " sessions, " << FLEET_STEPS
+            << " steps each, " << cores << " threads\n";
+
+  std::vector<std::unique_ptr<Chat> > chats;
+  for (size_t i = 0; i < FLEET_SESSIONS; ++i) {
+    chats.push_back(Chat::create());
+  }
+
+  //Поток ведёт свою часть чатов по очереди, по шагу каждого
+  console::setSilent(true);
+  std::vector<std::thread> threads;
+  const auto start = Clock::now();
+  for (size_t thread = 0; thread < cores; ++thread) {
+    threads.emplace_back([&chats, thread, cores]() {
+      const size_t first = chats.size() * thread / cores;
+      const size_t last = chats.size() * (thread + 1) / cores;
+      std::istringstream input(repeat("x\n", (last - first) * FLEET_STEPS));
+      console::setInput(&input);
+      for (size_t step = 0; step < FLEET_STEPS; ++step) {
+        for (size_t i = first; i < last; ++i) {
+          chats[i]->process();
+        }
+      }
+      console::setInput(nullptr);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  const double time = elapsedMs(start);
+  console::setSilent(false);
+
+  const double steps = static_cast<double>(FLEET_SESSIONS) * FLEET_STEPS;
+  std::cout << "  " << std::fixed << std::setprecision(0) << steps / time * 1000
+            << " steps/s all threads, " << std::setprecision(1) << time << " ms" << std::endl;
+}
+
+
+
+static std::string repeat(const std::string& lines, size_t count)
+{
+  std::string result;
+  result.reserve(lines.size() * count);
+  for (size_t i = 0; i < count; ++i) {
+    result += lines;
+  }
+  return result;
+}
+
+
+
+static double elapsedMs(Clock::time_point start)
+{
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
\ No newline at end of file
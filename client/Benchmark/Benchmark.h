@@ -0,0 +1,15 @@
+/**
+\file Benchmark.h
+\brief Модуль "Замеры" - содержит замеры производительности модулей клиента
+Запускается вместо клиента: ./client benchmark
+*/
+
+#pragma once
+
+
+namespace benchmark{
+  /**
+  Выполнить все замеры и вывести результаты в консоль
+  */
+  void run();
+}
\ No newline at end of file
@@ -1,119 +1,284 @@
-﻿#include "Chat.h"
-
-#include <iostream>
-#include <vector>
-
-#include "../Server/Server.h"
-
-
-//Начальная инициализация указателя на статический объект класса
-Chat* Chat::instance_ = nullptr;
-
-
-
-Chat* Chat::getInstance()
-{
-  if (instance_ == nullptr) {
-    instance_ = new Chat();
-  }
-  return instance_;
-}
-
-
-
-void Chat::process()
-{
-  state_->handle(*this);
-}
-
-
-
-Chat::Chat() : state_(std::make_unique<Start>()),
-               user_(std::make_shared<User>()),
-               isRun_(nullptr)
-{
-
-};
-
-
-
-void Chat::transitionTo(std::unique_ptr<State> newState)
-{
-  state_ = std::move(newState);
-}
-
-
-
-std::shared_ptr<User> Chat::getUser()
-{
-  return user_;
-}
-
-
-
-void Chat::attach(std::shared_ptr<bool> isRun)
-{
-  isRun_ = isRun;
-}
-
-
-
-void Chat::exit()
-{
-  *isRun_ = false;
-}
-
-
-
-void Chat::printUserList()
-{
-  auto nicknames = std::make_shared<std::vector<std::string> >();
-  server::getAllNicknames(nicknames);
-	for (const auto& name : *nicknames) {
-		std::cout << name << "; ";
-	}
-	std::cout << std::endl;
-}
-
-
-
-void Chat::printMessagesToUser()
-{
-  //Загрузить сообщения и вывести на экран
-  auto messagesToUser = std::make_shared<std::list<Message> >();
-  server::getMessages(user_->getLogin(), messagesToUser);
-  
-  if (messagesToUser->empty()) {
-    std::cout << "Вам сообщений нет.\n";
-  }
-  else {
-    for (const auto& message : *messagesToUser) {
-      std::cout << message.getNameFrom() << ": "
-          << message.getText() << std::endl;
-    }
-  }
-}
-
-
-
-void Chat::removeAccount()
-{
-  // database::removeUser(user_->getLogin());
-  server::removeUser(user_->getLogin());
-  user_->reset();
-  std::cout << "Аккаунт удалён.\n";
-}
-
-
-
-bool Chat::isCorrectValue(const std::string& inputValue)
-{
-  //Можно вводить символы латинского алфавита и арабские цифры
-  const std::string permissionedChars =
-    "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
-  size_t pos = inputValue.find_first_not_of(permissionedChars);
-  if (pos != std::string::npos) {
-    return false;
-  }
-  return true;
+﻿#include "Chat.h"
+
+#include <iostream>
+#include <vector>
+#include <stdexcept>
+
+#include "../Server/Server.h"
+#include "../Directory/Directory.h"
+#include "../History/History.h"
+#include "../Server/Exceptions/SocketConnection_Exception.h"
+#include "../Server/Exceptions/SocketTimeout_Exception.h"
+
+
+namespace {
+  //Количество сообщений переписки на одной странице
+  const size_t CONVERSATION_PAGE = 20;
+  //Количество последних сообщений истории, выводимых при просмотре
+  const size_t HISTORY_TAIL = 50;
+}
+
+
+//Начальная инициализация указателя на статический объект класса
+Chat* Chat::instance_ = nullptr;
+
+
+
+Chat* Chat::getInstance()
+{
+  if (instance_ == nullptr) {
+    instance_ = new Chat();
+  }
+  return instance_;
+}
+
+
+
+std::unique_ptr<Chat> Chat::create()
+{
+  return std::unique_ptr<Chat>(new Chat());
+}
+
+
+
+void Chat::process()
+{
+  //Сервер недоступен или не ответил - остаться в том же состоянии
+  try {
+    state_->handle(*this);
+  }
+  catch (const SocketConnection_Exception&) {
+    std::cout << "Нет связи с сервером, повторите действие.\n";
+  }
+  catch (const SocketTimeout_Exception&) {
+    std::cout << "Сервер не ответил, повторите действие.\n";
+  }
+  //Ответ сервера не разобран
+  catch (const std::invalid_argument&) {
+    std::cout << "Некорректный ответ сервера, повторите действие.\n";
+  }
+}
+
+
+
+Chat::Chat() : state_(nullptr),
+               user_(std::make_shared<User>()),
+               isRun_(nullptr)
+{
+  transitionTo<Start>();
+};
+
+
+
+std::shared_ptr<User> Chat::getUser()
+{
+  return user_;
+}
+
+
+
+void Chat::attach(std::shared_ptr<bool> isRun)
+{
+  isRun_ = isRun;
+}
+
+
+
+void Chat::exit()
+{
+  *isRun_ = false;
+}
+
+
+
+void Chat::printUserList()
+{
+  //Получить с сервера только изменения списка с прошлого раза
+  directory::sync();
+  auto nicknames = std::make_shared<std::vector<std::string> >();
+  directory::loadNicknames(nicknames);
+	for (const auto& name : *nicknames) {
+		std::cout << name << "; ";
+	}
+	std::cout << std::endl;
+}
+
+
+
+void Chat::printMessagesToUser()
+{
+  //Загрузить с сервера только сообщения после сохранённых в истории и вывести
+  //историю на экран. Сервер недоступен - вывести то, что уже сохранено.
+  //Сводка непрочитанных - до загрузки: в ней только сообщения, которые уже
+  //лежат у сервера и попадут в историю
+  history::open(user_->getLogin());
+  bool isOnline = true;
+  bool isSynced = false;
+  std::vector<server::UnreadCount> counts;
+  try {
+    server::getUnreadSummary(user_->getLogin(), counts);
+    isSynced = history::sync(user_->getLogin());
+  }
+  catch (const SocketConnection_Exception&) {
+    isOnline = false;
+  }
+  catch (const SocketTimeout_Exception&) {
+    isOnline = false;
+  }
+
+  std::list<Message> messagesToUser;
+  const size_t total = history::loadMessages(user_->getLogin(), messagesToUser, HISTORY_TAIL);
+  if (!isOnline) {
+    std::cout << "Нет связи с сервером - показаны сохранённые сообщения.\n";
+  }
+  if (messagesToUser.empty()) {
+    std::cout << "Вам сообщений нет.\n";
+  }
+  else {
+    if (total > messagesToUser.size()) {
+      std::cout << "Показаны последние " << messagesToUser.size() << " из " << total
+          << " сообщений (остальные - в переписке с отправителем).\n";
+    }
+    for (const auto& message : messagesToUser) {
+      std::cout << message.getNameFrom() << ": "
+          << message.getText() << std::endl;
+    }
+  }
+  //Подтвердить прочтение только показанных сообщений: пришедшие после сводки
+  //остаются непрочитанными, недозагруженная история не подтверждается
+  if (!isOnline || !isSynced) {
+    return;
+  }
+  std::vector<std::pair<std::string, uint64_t> > acknowledgements;
+  for (const auto& count : counts) {
+    acknowledgements.emplace_back(count.name, count.lastSequence);
+  }
+  server::acknowledgeRead(user_->getLogin(), acknowledgements);
+}
+
+
+
+void Chat::printUnreadSummary()
+{
+  //Без связи с сервером сводки нет, но меню чата доступно - историю можно
+  //смотреть и без сервера
+  std::vector<server::UnreadCount> counts;
+  size_t total = 0;
+  try {
+    total = server::getUnreadSummary(user_->getLogin(), counts);
+  }
+  catch (const SocketConnection_Exception&) {
+  }
+  catch (const SocketTimeout_Exception&) {
+  }
+  if (total == 0) {
+    return;
+  }
+
+  //Непрочитанных сообщений: 3 (G: 2, S: 1)
+  std::cout << "Непрочитанных сообщений: " << total << " (";
+  for (size_t i = 0; i < counts.size(); ++i) {
+    std::cout << (i == 0 ? "" : ", ") << counts[i].name << ": " << counts[i].count;
+  }
+  std::cout << ")\n";
+}
+
+
+
+void Chat::printRecentMessages()
+{
+  std::string input;
+  console::readLine("За сколько последних часов показать сообщения: ", input);
+  long hours = 0;
+  try {
+    hours = std::stol(input);
+  }
+  catch (const std::exception&) {
+  }
+  if (hours <= 0) {
+    std::cout << "Некорректное количество часов.\n";
+    return;
+  }
+
+  const std::time_t now = std::time(nullptr);
+  auto messages = std::make_shared<std::list<Message> >();
+  server::getMessagesByTime(user_->getLogin(), now - hours * 3600, now, messages);
+  if (messages->empty()) {
+    std::cout << "За этот период сообщений нет.\n";
+  }
+  for (const auto& message : *messages) {
+    std::cout << message.getNameFrom() << ": "
+              << message.getText() << std::endl;
+  }
+}
+
+
+
+void Chat::printConversation()
+{
+  std::string peer;
+  console::readLine("Введите Ник собеседника: ", peer);
+
+  //Загружать страницы от последних сообщений, пока пользователь просит продолжить
+  uint64_t before = 0;
+  while (true) {
+    auto messages = std::make_shared<std::list<Message> >();
+    uint64_t firstSequence = 0;
+    if (!server::getConversation(user_->getLogin(), peer, before, CONVERSATION_PAGE,
+                                 messages, firstSequence)) {
+      std::cout << "Пользователь с таким Ником не зарегистрирован.\n";
+      return;
+    }
+    if (messages->empty()) {
+      std::cout << (before == 0 ? "Переписки нет.\n" : "Более ранних сообщений нет.\n");
+      return;
+    }
+    for (const auto& message : *messages) {
+      std::cout << message.getNameFrom() << ": "
+                << message.getText() << std::endl;
+    }
+
+    //Первая страница заканчивается последним сообщением переписки
+    if (before == 0) {
+      server::acknowledgeRead(user_->getLogin(),
+                              {{peer, firstSequence + messages->size() - 1}});
+    }
+
+    //Показано первое сообщение переписки. Размер страницы не признак конца:
+    //длинные сообщения сервер присылает меньшими страницами
+    if (firstSequence <= 1) {
+      return;
+    }
+    std::string answer;
+    console::readLine("Показать более ранние сообщения? (y/n): ", answer);
+    if (answer != "y") {
+      return;
+    }
+    before = firstSequence;
+  }
+}
+
+
+
+void Chat::removeAccount()
+{
+  // database::removeUser(user_->getLogin());
+  server::removeUser(user_->getLogin());
+  history::remove(user_->getLogin());
+  user_->reset();
+  std::cout << "Аккаунт удалён.\n";
+}
+
+
+
+bool Chat::isCorrectValue(const std::string& inputValue)
+{
+  //Можно вводить символы латинского алфавита и арабские цифры
+  const std::string permissionedChars =
+    "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+  size_t pos = inputValue.find_first_not_of(permissionedChars);
+  if (pos != std::string::npos) {
+    return false;
+  }
+  return true;
 }
\ No newline at end of file
@@ -1,54 +1,166 @@
-﻿#include "AddresseeInput.h"
-
-#include <iostream>
-#include <memory>
-
-#include "../../Server/Server.h"
-
-
-AddresseeInput::AddresseeInput() : State("AddresseeInput")
-{
-};
-
-
-
-void AddresseeInput::handle(Chat& chat)
-{
-  std::cout << "Введите Ник адресата (all - отправить всем): ";
-  std::string nameAdressee;
-  std::getline(std::cin >> std::ws, nameAdressee);
-
-  //Зарегистрирован только один пользователь
-  if (server::getNumberUsers() == 1) {
-    std::cout << "Вы единственный пользователь чата\n";
-    chat.transitionTo(std::move(std::make_unique<UserInChat>()));
-  }
-
-  //Неверное имя адресата
-  else if ( (nameAdressee != "all") &&
-            (!server::isNicknameRegistered(nameAdressee)) ) {
-    std::cout << "Пользователь с таким Ником не зарегистрирован.\n";
-    chat.transitionTo(std::move(std::make_unique<AddresseeMissing>()));
-  }
-
-  //Адресат корректный
-  else {
-    std::cout << "Введите сообщение: ";
-    std::string textMessage;
-    std::getline(std::cin >> std::ws, textMessage);
-
-    //Текст введён
-    if (!textMessage.empty()) {
-      server::addMessage(nameAdressee,
-                        chat.getUser()->getName(),
-                        textMessage);
-      std::cout << "Сообщение отправлено\n";
-    }
-
-    //Текст не введён
-    else {
-      std::cout << "Сообщение не отправлено (отсутствует текст сообщения)\n";
-    }
-    chat.transitionTo(std::move(std::make_unique<UserInChat>()));
-  }
+﻿#include "AddresseeInput.h"
+
+#include <iostream>
+#include <memory>
+
+#include "../../Server/Server.h"
+#include "../../../Directory/Directory.h"
+
+
+namespace {
+  //Признак ввода начала Ника вместо Ника целиком
+  const char COMPLETION_MARK = '*';
+  //Количество подсказок за раз
+  const size_t COMPLETION_LIMIT = 10;
+  //Разделитель Ников нескольких адресатов
+  const char ADDRESSEE_DELIMITER = ',';
+}
+
+
+
+AddresseeInput::AddresseeInput() : State("AddresseeInput")
+{
+};
+
+
+
+void AddresseeInput::handle(Chat& chat)
+{
+  //Текст приглашения собирается один раз
+  static const std::string prompt = std::string("Введите Ник адресата (all - отправить всем, ") +
+                                    "начало Ника и " + COMPLETION_MARK + " - подсказка, " +
+                                    "несколько Ников через '" + ADDRESSEE_DELIMITER + "'): ";
+  std::string nameAdressee;
+  console::readLine(prompt, nameAdressee);
+
+  //Несколько адресатов - одним запросом
+  if (nameAdressee.find(ADDRESSEE_DELIMITER) != std::string::npos) {
+    sendToMany(chat, nameAdressee);
+    chat.transitionTo<UserInChat>();
+    return;
+  }
+
+  //Введено начало Ника - дополнить
+  if (!nameAdressee.empty() && nameAdressee.back() == COMPLETION_MARK) {
+    nameAdressee.pop_back();
+    if (!complete(nameAdressee)) {
+      chat.transitionTo<AddresseeInput>();
+      return;
+    }
+    std::cout << "Адресат: " << nameAdressee << std::endl;
+  }
+
+  //Зарегистрирован только один пользователь
+  if (directory::getNumberUsers() == 1) {
+    std::cout << "Вы единственный пользователь чата\n";
+    chat.transitionTo<UserInChat>();
+  }
+
+  //Неверное имя адресата
+  else if ( (nameAdressee != "all") &&
+            (!directory::isRegistered(nameAdressee)) ) {
+    std::cout << "Пользователь с таким Ником не зарегистрирован.\n";
+    chat.transitionTo<AddresseeMissing>();
+  }
+
+  //Адресат корректный
+  else {
+    std::string textMessage;
+    console::readLine("Введите сообщение: ", textMessage);
+
+    //Текст введён
+    if (!textMessage.empty()) {
+      server::addMessage(nameAdressee,
+                        chat.getUser()->getName(),
+                        textMessage);
+      std::cout << "Сообщение отправлено\n";
+    }
+
+    //Текст не введён
+    else {
+      std::cout << "Сообщение не отправлено (отсутствует текст сообщения)\n";
+    }
+    chat.transitionTo<UserInChat>();
+  }
+}
+
+
+
+bool AddresseeInput::complete(std::string& nameAdressee)
+{
+  //Запросить на одну подсказку больше - чтобы знать, есть ли ещё
+  auto nicknames = std::make_shared<std::vector<std::string> >();
+  directory::findNicknames(nameAdressee, COMPLETION_LIMIT + 1, nicknames);
+
+  //Единственный вариант - дополнить Ник
+  if (nicknames->size() == 1) {
+    nameAdressee = nicknames->front();
+    return true;
+  }
+
+  if (nicknames->empty()) {
+    std::cout << "Нет пользователей, Ник которых начинается с \""
+              << nameAdressee << "\"\n";
+    return false;
+  }
+
+  //Несколько вариантов - показать их
+  for (size_t i = 0; i < nicknames->size() && i < COMPLETION_LIMIT; ++i) {
+    std::cout << nicknames->at(i) << "; ";
+  }
+  if (nicknames->size() > COMPLETION_LIMIT) {
+    std::cout << "...";
+  }
+  std::cout << std::endl;
+  return false;
+}
+
+
+
+void AddresseeInput::sendToMany(Chat& chat, const std::string& namesAdressee)
+{
+  //Разделить ввод на Ники
+  std::vector<std::string> names;
+  size_t begin = 0;
+  while (begin <= namesAdressee.size()) {
+    size_t end = namesAdressee.find(ADDRESSEE_DELIMITER, begin);
+    if (end == std::string::npos) {
+      end = namesAdressee.size();
+    }
+    const std::string name = namesAdressee.substr(begin, end - begin);
+    if (!name.empty()) {
+      if (!chat.isCorrectValue(name)) {
+        std::cout << "Некорректный Ник: " << name << std::endl;
+        return;
+      }
+      names.push_back(name);
+    }
+    begin = end + 1;
+  }
+
+  if (names.empty()) {
+    std::cout << "Адресаты не введены.\n";
+    return;
+  }
+
+  std::string textMessage;
+  console::readLine("Введите сообщение: ", textMessage);
+  if (textMessage.empty()) {
+    std::cout << "Сообщение не отправлено (отсутствует текст сообщения)\n";
+    return;
+  }
+
+  std::vector<bool> delivered;
+  server::addMessage(names, chat.getUser()->getName(), textMessage, delivered);
+  size_t numberDelivered = 0;
+  for (size_t i = 0; i < names.size(); ++i) {
+    if (i < delivered.size() && delivered[i]) {
+      ++numberDelivered;
+    }
+    else {
+      std::cout << "Пользователь " << names[i] << " не зарегистрирован.\n";
+    }
+  }
+  std::cout << "Сообщение отправлено адресатам: " << numberDelivered
+            << " из " << names.size() << std::endl;
 }
\ No newline at end of file
@@ -1,22 +1,38 @@
-﻿/**
-\file AddresseeInput.h
-\brief Класс-обработчик состояния "ВВОД АДРЕСАТА"
-*/
-
-#pragma once
-
-#include "../../../State/State.h"
-#include "../../Chat.h"
-
-class AddresseeInput : public State {
-  public:
-    /**
-    Конструктор по-умолчанию
-    */
-    AddresseeInput();
-
-    /**
-    Обработчик состояния "ВВОД АДРЕСАТА"
-    */
-    virtual void handle(Chat& chat) override;
+﻿/**
+\file AddresseeInput.h
+\brief Класс-обработчик состояния "ВВОД АДРЕСАТА"
+*/
+
+#pragma once
+
+#include "../../../State/State.h"
+#include "../../Chat.h"
+
+class AddresseeInput : public State {
+  public:
+    /**
+    Конструктор по-умолчанию
+    */
+    AddresseeInput();
+
+    /**
+    Обработчик состояния "ВВОД АДРЕСАТА"
+    */
+    virtual void handle(Chat& chat) override;
+
+  private:
+    /**
+    Дополнить начало Ника по списку зарегистрированных пользователей
+    Если подходящих Ников несколько - вывести их в консоль
+    \param[in] nameAdressee Начало Ника, при успехе - Ник целиком
+    \return Признак того, что Ник дополнен однозначно
+    */
+    bool complete(std::string& nameAdressee);
+
+    /**
+    Отправить одно сообщение нескольким адресатам и вывести, кому оно не доставлено
+    \param[in] chat Указатель на объект чата
+    \param[in] namesAdressee Ники адресатов через разделитель
+    */
+    void sendToMany(Chat& chat, const std::string& namesAdressee);
 };
\ No newline at end of file
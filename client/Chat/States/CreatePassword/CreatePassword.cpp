@@ -1,40 +1,54 @@
-﻿#include "CreatePassword.h"
-
-#include <iostream>
-#include <memory>
-
-// #include "../../DataBase/DataBase.h"
-#include "../../Server/Server.h"
-#include "../../SHA_1/SHA_1_Wrapper.h"
-
-
-CreatePassword::CreatePassword() : State("CreatePassword")
-{
-};
-
-
-
-void CreatePassword::handle(Chat& chat)
-{
-  std::cout << "Придумайте Пароль: ";
-  std::string password;
-  std::getline(std::cin >> std::ws, password);
-
-  //Допустимые символы
-  if (chat.isCorrectValue(password)) {
-    server::addUser(chat.getUser()->getName(),
-                    chat.getUser()->getLogin(),
-                    sha_1::hash(password));
-
-    std::cout << "Вы успешно зарегистрированы!\n"
-        << chat.getUser()->getName() << ", добро пожаловать в Чат!\n";
-    chat.transitionTo(std::move(std::make_unique<UserInChat>()));
-  }
-
-  //Недопустимые символы
-  else {
-    std::cout << "Некорректные символы.\n";
-    std::cin.clear();
-    chat.transitionTo(std::move(std::make_unique<CreatePassword>()));
-  }
+﻿#include "CreatePassword.h"
+
+#include <iostream>
+#include <memory>
+
+// #include "../../DataBase/DataBase.h"
+#include "../../Server/Server.h"
+#include "../../SHA_1/SHA_1_Wrapper.h"
+
+
+CreatePassword::CreatePassword() : State("CreatePassword")
+{
+};
+
+
+
+void CreatePassword::handle(Chat& chat)
+{
+  std::string password;
+  console::readLine("Придумайте Пароль: ", password);
+
+  //Допустимые символы
+  if (chat.isCorrectValue(password)) {
+    const server::AuthResult result = server::addUser(chat.getUser()->getName(),
+                                                      chat.getUser()->getLogin(),
+                                                      sha_1::hash(password));
+
+    //Пользователь добавлен
+    if (result == server::ACCEPTED) {
+      std::cout << "Вы успешно зарегистрированы!\n"
+          << chat.getUser()->getName() << ", добро пожаловать в Чат!\n";
+      chat.transitionTo<UserInChat>();
+    }
+
+    //Сервер занят - пользователь не добавлен, ввести Пароль ещё раз
+    else if (result == server::BUSY) {
+      std::cout << "Сервер занят, попробуйте ещё раз.\n";
+      chat.transitionTo<CreatePassword>();
+    }
+
+    //Логин или Ник заняли, пока шла регистрация - начать её заново
+    else {
+      std::cout << "Логин или Ник уже заняты, регистрация не выполнена.\n";
+      chat.transitionTo<CreateLogin>();
+    }
+  }
+
+  //Недопустимые символы
+  else {
+    std::cout << "Некорректные символы.\n";
+    std::cin.clear();
+    chat.transitionTo<CreatePassword>();
+  }
 }
\ No newline at end of file
@@ -1,66 +1,57 @@
-﻿#include "LoginUnregistered.h"
-
-#include <iostream>
-#include <memory>
-
-
-namespace {
-  //Возможный выбор пользователя
-  enum {
-    INPUT_AGAIN = 1,
-    REGISTRATION
-  };
-}
-
-
-
-LoginUnregistered::LoginUnregistered() : State("LoginUnregistered")
-{
-};
-
-
-
-void LoginUnregistered::handle(Chat& chat)
-{
-  std::cout << "| 1 - Ввести Логин заново | 2 - Регистрация | :  ";
-  std::string input;
-  std::getline(std::cin >> std::ws, input);
-
-  //Введено более одного символа
-  if (input.length() > 1) {
-    chat.transitionTo(std::move(std::make_unique<LoginUnregistered>()));
-  }
-  //Введён один символ
-  else {
-    //Попытка преобразовать символ в число
-    try {
-      int choice = std::stoi(input);
-      handleChoice(chat, choice);
-    }
-    //Символ не число - вернуться в начало ко вводу
-    catch (const std::invalid_argument&) {
-      chat.transitionTo(std::move(std::make_unique<LoginUnregistered>()));
-    }
-  }
-}
-
-
-
-void LoginUnregistered::handleChoice(Chat& chat, int choice)
-{
-  switch (choice) {
-    case INPUT_AGAIN: {
-      chat.transitionTo(std::move(std::make_unique<LoginInput>()));
-      break;
-    }
-    case REGISTRATION: {
-      chat.transitionTo(std::move(std::make_unique<CreateLogin>()));
-      break;
-    }
-    default: {
-      std::cin.clear();
-      chat.transitionTo(std::move(std::make_unique<LoginUnregistered>()));
-      break;
-    }
-  }
+﻿#include "LoginUnregistered.h"
+
+#include <iostream>
+#include <memory>
+
+
+namespace {
+  //Возможный выбор пользователя
+  enum {
+    INPUT_AGAIN = 1,
+    REGISTRATION
+  };
+}
+
+
+
+LoginUnregistered::LoginUnregistered() : State("LoginUnregistered")
+{
+};
+
+
+
+void LoginUnregistered::handle(Chat& chat)
+{
+  std::string input;
+  console::readLine("| 1 - Ввести Логин заново | 2 - Регистрация | :  ", input);
+
+  //Выбор - одна цифра, иначе вернуться в начало ко вводу
+  const int choice = parseChoice(input);
+  if (choice < 0) {
+    chat.transitionTo<LoginUnregistered>();
+  }
+  else {
+    handleChoice(chat, choice);
+  }
+}
+
+
+
+void LoginUnregistered::handleChoice(Chat& chat, int choice)
+{
+  switch (choice) {
+    case INPUT_AGAIN: {
+      chat.transitionTo<LoginInput>();
+      break;
+    }
+    case REGISTRATION: {
+      chat.transitionTo<CreateLogin>();
+      break;
+    }
+    default: {
+      std::cin.clear();
+      chat.transitionTo<LoginUnregistered>();
+      break;
+    }
+  }
 }
\ No newline at end of file
@@ -0,0 +1,152 @@
+﻿#include "Rooms.h"
+
+#include <iostream>
+#include <memory>
+
+#include "../../Server/Server.h"
+
+
+namespace {
+  //Возможный выбор пользователя
+  enum {
+    SHOW_ROOMS = 1,
+    CREATE_ROOM,
+    JOIN_ROOM,
+    LEAVE_ROOM,
+    SEND_MESSAGE,
+    READ_MESSAGES,
+    BACK
+  };
+}
+
+
+
+Rooms::Rooms() : State("Rooms")
+{
+};
+
+
+
+void Rooms::handle(Chat& chat)
+{
+  //Текст меню собирается один раз
+  static const std::string menu = "| " +
+  std::to_string(SHOW_ROOMS) + " - Мои комнаты | " +
+  std::to_string(CREATE_ROOM) + " - Создать | " +
+  std::to_string(JOIN_ROOM) + " - Вступить | " +
+  std::to_string(LEAVE_ROOM) + " - Выйти | " +
+  std::to_string(SEND_MESSAGE) + " - Написать | " +
+  std::to_string(READ_MESSAGES) + " - Прочитать | " +
+  std::to_string(BACK) + " - Назад : ";
+
+  std::string input;
+  console::readLine(menu, input);
+
+  //Выбор - одна цифра, иначе вернуться в начало ко вводу
+  const int choice = parseChoice(input);
+  if (choice < 0) {
+    chat.transitionTo<Rooms>();
+  }
+  else {
+    handleChoice(chat, choice);
+  }
+}
+
+
+
+void Rooms::handleChoice(Chat& chat, int choice)
+{
+  const std::string login = chat.getUser()->getLogin();
+  std::string room;
+  switch (choice) {
+    case SHOW_ROOMS: {
+      auto rooms = std::make_shared<std::vector<std::string> >();
+      server::getRooms(login, rooms);
+      if (rooms->empty()) {
+        std::cout << "Вы не состоите ни в одной комнате.\n";
+      }
+      for (const auto& name : *rooms) {
+        std::cout << name << "; ";
+      }
+      std::cout << std::endl;
+      break;
+    }
+    case CREATE_ROOM: {
+      if (inputRoom(chat, room)) {
+        std::cout << (server::createRoom(login, room) ?
+                      "Комната создана.\n" : "Комната с таким названием уже есть.\n");
+      }
+      break;
+    }
+    case JOIN_ROOM: {
+      if (inputRoom(chat, room)) {
+        std::cout << (server::joinRoom(login, room) ?
+                      "Вы вступили в комнату.\n" : "Комнаты с таким названием нет.\n");
+      }
+      break;
+    }
+    case LEAVE_ROOM: {
+      if (inputRoom(chat, room)) {
+        std::cout << (server::leaveRoom(login, room) ?
+                      "Вы вышли из комнаты.\n" : "Вы не состоите в этой комнате.\n");
+      }
+      break;
+    }
+    case SEND_MESSAGE: {
+      if (!inputRoom(chat, room)) {
+        break;
+      }
+      std::string textMessage;
+      console::readLine("Введите сообщение: ", textMessage);
+      if (textMessage.empty()) {
+        std::cout << "Сообщение не отправлено (отсутствует текст сообщения)\n";
+      }
+      else if (server::postToRoom(login, room, textMessage)) {
+        std::cout << "Сообщение отправлено\n";
+      }
+      else {
+        std::cout << "Вы не состоите в этой комнате.\n";
+      }
+      break;
+    }
+    case READ_MESSAGES: {
+      if (!inputRoom(chat, room)) {
+        break;
+      }
+      auto messages = std::make_shared<std::list<Message> >();
+      if (!server::getRoomMessages(login, room, messages)) {
+        std::cout << "Вы не состоите в этой комнате.\n";
+      }
+      else if (messages->empty()) {
+        std::cout << "Новых сообщений нет.\n";
+      }
+      for (const auto& message : *messages) {
+        std::cout << message.getNameFrom() << ": "
+                  << message.getText() << std::endl;
+      }
+      break;
+    }
+    case BACK: {
+      chat.transitionTo<UserInChat>();
+      break;
+    }
+    default: {
+      std::cin.clear();
+      chat.transitionTo<Rooms>();
+      break;
+    }
+  }
+}
+
+
+
+bool Rooms::inputRoom(Chat& chat, std::string& room)
+{
+  console::readLine("Введите название комнаты: ", room);
+  //Название - как Ник: только латинские буквы и цифры
+  if (room.empty() || !chat.isCorrectValue(room)) {
+    std::cout << "Недопустимое название комнаты.\n";
+    return false;
+  }
+  return true;
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+﻿/**
+\file Rooms.h
+\brief Класс-обработчик состояния "КОМНАТЫ"
+*/
+
+#pragma once
+
+#include "../../../State/State.h"
+#include "../../Chat.h"
+
+class Rooms : public State {
+  public:
+    /**
+    Конструктор по-умолчанию
+    */
+    Rooms();
+
+    /**
+    Обработчик состояния "КОМНАТЫ"
+    */
+    virtual void handle(Chat& chat) override;
+
+  private:
+    /**
+    Обработчик ввода пользователя в зависимости от введённого числа
+    \param[in] chat Указатель на объект чата для которого выполнять обработку
+    \param[in] choice Число которое ввёл пользователь
+    */
+    void handleChoice(Chat& chat, int choice);
+
+    /**
+    Запросить у пользователя название комнаты
+    \param[in] chat Указатель на объект чата (для проверки названия)
+    \param[in] room Введённое название
+    \return Признак корректного названия
+    */
+    bool inputRoom(Chat& chat, std::string& room);
+};
\ No newline at end of file
@@ -0,0 +1,296 @@
+#include "Console.h"
+
+#include <iostream>
+#include <mutex>
+#include <vector>
+#include <csignal>
+#include <cerrno>
+#include <unistd.h>
+#include <termios.h>
+#include <sys/ioctl.h>
+#include <assert.h>
+
+
+namespace{
+  const char BACKSPACE = 127;       //Стирание символа (и '\b')
+  const char END_OF_INPUT = 4;      //Ctrl-D
+  const char ESCAPE = 27;           //Начало управляющей последовательности (стрелки и т.п.)
+
+  //Весь вывод консоли и набранная строка - под одной блокировкой
+  std::mutex mutex;
+  bool isReading = false;             //Сейчас вводится строка
+  std::string prompt;                 //Приглашение вводимой строки
+  std::string typed;                  //Набранный текст вводимой строки
+  std::vector<std::string> pending;   //Уведомления до следующего приглашения
+  bool isInputOver = false;           //Ввод консоли закончился
+
+  termios savedTerminal;              //Режим терминала до ввода строки
+
+  //Строки потока читаются из сценария (nullptr - из консоли)
+  thread_local std::istream* script = nullptr;
+
+  //Буфер, отбрасывающий вывод
+  class NullBuffer : public std::streambuf {
+    protected:
+      int overflow(int symbol) override
+      {
+        return traits_type::not_eof(symbol);
+      }
+      std::streamsize xsputn(const char*, std::streamsize count) override
+      {
+        return count;
+      }
+  };
+  NullBuffer nothing;
+  std::streambuf* savedOutput = nullptr;  //Буфер std::cout до отключения вывода
+}
+
+
+//Ввод и вывод - терминал (иначе строка читается как обычно)
+static bool isTerminal();
+
+//Прочитать строку посимвольно: терминал без эха и без построчного режима
+static void readTerminalLine(std::string& line);
+
+//Вернуть терминалу прежний режим при прерывании программы во время ввода
+static void restoreTerminal(int signal);
+
+//Количество символов в строке UTF-8 (позиций на экране)
+static size_t countSymbols(const std::string& text);
+
+//Стереть последний символ строки UTF-8 (все его байты)
+static void eraseLastSymbol(std::string& text);
+
+//Сколько строк экрана занимает текст при заданной ширине терминала
+static size_t countRows(size_t symbols, size_t columns);
+
+
+
+void console::readLine(const std::string& promptText, std::string& line)
+{
+  //Сценарий - без уведомлений и без терминала
+  if (script != nullptr) {
+    std::cout << promptText;
+    line.clear();
+    std::getline(*script >> std::ws, line);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& text : pending) {
+      std::cout << text << "\n";
+    }
+    pending.clear();
+    std::cout << promptText << std::flush;
+    prompt = promptText;
+    typed.clear();
+    isReading = true;
+  }
+
+  if (isTerminal()) {
+    readTerminalLine(line);
+  }
+  else {
+    std::getline(std::cin >> std::ws, line);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  isReading = false;
+  //Состояния чата сбрасывают флаги std::cin - конец ввода запоминается отдельно
+  isInputOver = isInputOver || std::cin.eof();
+}
+
+
+
+bool console::isFinished()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  return isInputOver;
+}
+
+
+
+void console::notify(const std::string& text)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!isReading) {
+    pending.push_back(text);
+    return;
+  }
+
+  if (!isTerminal()) {
+    std::cout << "\n" << text << "\n" << prompt << std::flush;
+    return;
+  }
+
+  //Подняться к началу приглашения, стереть его вместе с набранным текстом,
+  //вывести уведомление и под ним - приглашение и набранный текст заново
+  winsize window{};
+  const size_t columns = (ioctl(STDOUT_FILENO, TIOCGWINSZ, &window) == 0 && window.ws_col > 0) ?
+                         window.ws_col : 80;
+  const size_t rows = countRows(countSymbols(prompt) + countSymbols(typed), columns);
+  if (rows > 1) {
+    std::cout << "\033[" << rows - 1 << "A";
+  }
+  std::cout << "\r\033[J" << text << "\n" << prompt << typed << std::flush;
+}
+
+
+
+void console::setInput(std::istream* input)
+{
+  script = input;
+}
+
+
+
+void console::setSilent(bool silent)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  if (silent && savedOutput == nullptr) {
+    savedOutput = std::cout.rdbuf(&nothing);
+  }
+  else if (!silent && savedOutput != nullptr) {
+    std::cout.rdbuf(savedOutput);
+    savedOutput = nullptr;
+  }
+}
+
+
+
+static bool isTerminal()
+{
+  static const bool result = isatty(STDIN_FILENO) && isatty(STDOUT_FILENO);
+  return result;
+}
+
+
+
+static void readTerminalLine(std::string& line)
+{
+  tcgetattr(STDIN_FILENO, &savedTerminal);
+  termios raw = savedTerminal;
+  raw.c_lflag &= ~(ICANON | ECHO);
+  raw.c_cc[VMIN] = 1;
+  raw.c_cc[VTIME] = 0;
+  tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+  std::signal(SIGINT, restoreTerminal);
+  std::signal(SIGTERM, restoreTerminal);
+
+  bool isEscape = false;  //Пропускаются байты управляющей последовательности
+  while (true) {
+    char symbol = 0;
+    const ssize_t bytes = read(STDIN_FILENO, &symbol, 1);
+    if (bytes < 0 && errno == EINTR) {
+      continue;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    //Конец ввода - как у std::getline
+    if (bytes <= 0 || (symbol == END_OF_INPUT && typed.empty())) {
+      std::cin.setstate(std::ios::eofbit | std::ios::failbit);
+      break;
+    }
+
+    //ESC [ ... буква - стрелки и прочие клавиши не попадают в строку
+    if (symbol == ESCAPE) {
+      isEscape = true;
+      continue;
+    }
+    if (isEscape) {
+      isEscape = (symbol == '[' || (symbol >= '0' && symbol <= '9') || symbol == ';');
+      continue;
+    }
+
+    if (symbol == '\n' || symbol == '\r') {
+      std::cout << "\n" << std::flush;
+      //Пустая строка пропускается, как и std::ws
+      if (!typed.empty()) {
+        break;
+      }
+      std::cout << prompt << std::flush;
+      continue;
+    }
+    if (symbol == BACKSPACE || symbol == '\b') {
+      if (!typed.empty()) {
+        eraseLastSymbol(typed);
+        std::cout << "\b \b" << std::flush;
+      }
+      continue;
+    }
+    //Прочие управляющие символы и начальные пробелы не вводятся
+    if ((static_cast<unsigned char>(symbol) < ' ' && symbol != '\t') ||
+        (typed.empty() && (symbol == ' ' || symbol == '\t'))) {
+      continue;
+    }
+    typed += symbol;
+    std::cout << symbol << std::flush;
+  }
+
+  line = typed;
+  typed.clear();
+  tcsetattr(STDIN_FILENO, TCSANOW, &savedTerminal);
+}
+
+
+
+static void restoreTerminal(int signal)
+{
+  tcsetattr(STDIN_FILENO, TCSANOW, &savedTerminal);
+  std::signal(signal, SIG_DFL);
+  std::raise(signal);
+}
+
+
+
+static size_t countSymbols(const std::string& text)
+{
+  //Байты продолжения символа UTF-8 - 10xxxxxx
+  size_t result = 0;
+  for (unsigned char byte : text) {
+    result += ((byte & 0xC0) != 0x80);
+  }
+  return result;
+}
+
+
+
+static void eraseLastSymbol(std::string& text)
+{
+  while (!text.empty() && (static_cast<unsigned char>(text.back()) & 0xC0) == 0x80) {
+    text.pop_back();
+  }
+  if (!text.empty()) {
+    text.pop_back();
+  }
+}
+
+
+
+static size_t countRows(size_t symbols, size_t columns)
+{
+  //Курсор после последнего символа: полная строка переносит его на следующую
+  return symbols / columns + 1;
+}
+
+
+
+void console::test()
+{
+  assert(countSymbols("") == 0);
+  assert(countSymbols("abc") == 3);
+  assert(countSymbols("Ник: G") == 6);
+
+  std::string text = "Да";
+  eraseLastSymbol(text);
+  assert(text == "Д");
+  eraseLastSymbol(text);
+  assert(text.empty());
+  eraseLastSymbol(text);
+  assert(text.empty());
+
+  assert(countRows(0, 80) == 1);
+  assert(countRows(79, 80) == 1);
+  assert(countRows(80, 80) == 2);
+  assert(countRows(200, 80) == 3);
+}
\ No newline at end of file
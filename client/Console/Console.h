@@ -0,0 +1,53 @@
+/**
+\file Console.h
+\brief Модуль "Консоль" - ввод строк и вывод уведомлений, не мешающий вводу
+Уведомления из фонового потока выводятся над строкой, которую пользователь
+набирает: приглашение и набранный текст выводятся заново под уведомлением.
+Если строка сейчас не вводится, уведомление выводится перед следующим приглашением.
+Когда ввод - не терминал (файл, канал), строка читается как обычно.
+Поток может читать строки из сценария вместо консоли (безголовый режим клиента).
+*/
+
+#pragma once
+
+#include <string>
+#include <istream>
+
+
+namespace console{
+  /**
+  Вывести приглашение и прочитать строку (начальные пробелы и пустые строки пропускаются)
+  \param[in] prompt Приглашение
+  \param[in] line Результат - введённая строка
+  */
+  void readLine(const std::string& prompt, std::string& line);
+
+  /**
+  \return Признак того, что ввод консоли закончился (конец файла или Ctrl-D)
+  */
+  bool isFinished();
+
+  /**
+  Читать строки вызывающего потока из сценария вместо консоли
+  \param[in] input Поток ввода сценария (nullptr - снова из консоли)
+  */
+  void setInput(std::istream* input);
+
+  /**
+  Отбрасывать весь вывод в std::cout или снова выводить его (безголовый режим,
+  замеры: вывод автомата чата не нужен и не должен влиять на результат)
+  \param[in] silent Признак отключения вывода
+  */
+  void setSilent(bool silent);
+
+  /**
+  Вывести уведомление, не прерывая ввод строки (можно вызывать из любого потока)
+  \param[in] text Текст уведомления
+  */
+  void notify(const std::string& text);
+
+  /**
+  Запустить тестирование функций модуля
+  */
+  void test();
+}
\ No newline at end of file
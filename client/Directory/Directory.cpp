@@ -0,0 +1,281 @@
+#include "Directory.h"
+
+#include <set>
+#include <mutex>
+#include <assert.h>
+
+#include "../Server/Server.h"
+
+
+namespace{
+  std::mutex mutex;
+  std::set<std::string> nicknames; //Локальная копия списка Ников
+  uint64_t version = 0;            //Версия локальной копии
+
+  //Полный список, собираемый по страницам
+  struct Reset {
+    bool isStarted = false;        //Получена первая страница
+    uint64_t version = 0;          //Версия первой страницы
+    std::set<std::string> names;   //Ники полученных страниц
+    std::string after = "";        //Последний Ник полученных страниц
+  };
+}
+
+
+//Применить к локальной копии страницу ответа сервера
+//Возвращает признак того, что нужно запросить следующую страницу
+static bool apply(const std::string& response, Reset& reset);
+
+//Загрузить копию с сервера, если её ещё нет
+static void loadIfMissing();
+
+//Распарсить строку на слова по разделителю и поместить в result
+static void parse (std::shared_ptr<std::vector<std::string> > result,
+                  const std::string& input,
+                  const std::string& delimiter);
+
+
+
+void directory::sync()
+{
+  //Запросы - без блокировки: изменения применяются, только если версия не ушла вперёд.
+  //Ответ сервера ограничен по длине - страницы запрашиваются, пока не получены все
+  Reset reset;
+  bool isMore = true;
+  while (isMore) {
+    const std::string response = server::getNicknamesSince(getVersion(), reset.after);
+    std::lock_guard<std::mutex> lock(mutex);
+    isMore = apply(response, reset);
+  }
+}
+
+
+
+void directory::loadNicknames(std::shared_ptr<std::vector<std::string> > result)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  result->assign(nicknames.begin(), nicknames.end());
+}
+
+
+
+uint64_t directory::getVersion()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  return version;
+}
+
+
+
+bool directory::isRegistered(const std::string& nickname)
+{
+  loadIfMissing();
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (nicknames.count(nickname) != 0) {
+      return true;
+    }
+  }
+  //Копия могла отстать от сервера - отрицательный ответ даёт только сервер
+  return server::isNicknameRegistered(nickname);
+}
+
+
+
+size_t directory::getNumberUsers()
+{
+  //Количество - по серверу: копия отстаёт на время между синхронизациями
+  return server::getNumberUsers();
+}
+
+
+
+void directory::findNicknames(const std::string& prefix,
+                              size_t limit,
+                              std::shared_ptr<std::vector<std::string> > result)
+{
+  loadIfMissing();
+  std::lock_guard<std::mutex> lock(mutex);
+  result->clear();
+  for (auto nickname = nicknames.lower_bound(prefix);
+       nickname != nicknames.end() && result->size() < limit &&
+       nickname->compare(0, prefix.size(), prefix) == 0;
+       ++nickname) {
+    result->push_back(*nickname);
+  }
+}
+
+
+
+static void loadIfMissing()
+{
+  if (directory::getVersion() == 0) {
+    directory::sync();
+  }
+}
+
+
+
+static bool apply(const std::string& response, Reset& reset)
+{
+  //response - D|VERSION|END|ИЗМЕНЕНИЕ|... или R|VERSION|END|NICK|...
+  auto items = std::make_shared<std::vector<std::string> >();
+  parse(items, response, "|");
+  if (items->size() < 3) {
+    return false;
+  }
+
+  uint64_t newVersion = 0;
+  try {
+    newVersion = std::stoull(items->at(1));
+  }
+  catch (const std::exception&) {
+    return false;
+  }
+  const bool isMore = (items->at(2) == "more");
+
+  //Страница полного списка - копия заменяется, только когда получены все страницы
+  if (items->at(0) == "R") {
+    if (!reset.isStarted) {
+      reset.isStarted = true;
+      reset.version = newVersion;
+    }
+    reset.names.insert(items->begin() + 3, items->end());
+    if (isMore) {
+      //Страница без Ников не сдвигает запрос вперёд
+      if (items->size() == 3) {
+        return false;
+      }
+      reset.after = items->back();
+      return true;
+    }
+    //Страницы собраны в разное время: копия получает версию первой страницы,
+    //а изменения после неё запрашиваются следующей страницей
+    nicknames.swap(reset.names);
+    version = reset.version;
+    reset = Reset();
+    return true;
+  }
+  //Изменения от более старой версии - ответ на запрос, обогнанный другим потоком
+  if (items->at(0) != "D" || reset.isStarted || newVersion < version) {
+    return false;
+  }
+
+  //Изменения - применение повторного изменения ничего не меняет
+  for (auto item = items->begin() + 3; item != items->end(); ++item) {
+    if (item->empty()) {
+      continue;
+    }
+    const std::string value = item->substr(1);
+    switch ((*item)[0]) {
+      case '+': {
+        nicknames.insert(value);
+        break;
+      }
+      case '-': {
+        nicknames.erase(value);
+        break;
+      }
+      case '~': {
+        const size_t delimiter = value.find(":");
+        nicknames.erase(value.substr(0, delimiter));
+        nicknames.insert(value.substr(delimiter + 1));
+        break;
+      }
+      default:
+        break;
+    }
+  }
+  //Версия сохраняется только после того, как применены все изменения страницы
+  const bool isAdvanced = (newVersion > version);
+  version = newVersion;
+  return isMore && isAdvanced;
+}
+
+
+
+static void parse (std::shared_ptr<std::vector<std::string> > result,
+                  const std::string& input,
+                  const std::string& delimiter)
+{
+  result->clear();
+  std::string string = input;
+  while (!string.empty()){
+    std::string value = string.substr(0, string.find(delimiter));
+    string = string.substr(string.find(delimiter)+1);
+    result->push_back(value);
+  }
+}
+
+
+
+//========================================================================================================
+void directory::test()
+{
+  auto result = std::make_shared<std::vector<std::string> >();
+
+  Reset reset;
+
+  //Полный список
+  assert(apply("R|10|end|name_1|name_2|", reset) == true);
+  loadNicknames(result);
+  assert(version == 10);
+  assert(result->size() == 2);
+  assert(result->at(0) == "name_1");
+
+  //Изменения
+  assert(apply("D|13|end|+name_3|-name_1|~name_2:new_name|", reset) == false);
+  loadNicknames(result);
+  assert(version == 13);
+  assert(result->size() == 2);
+  assert(result->at(0) == "name_3");
+  assert(result->at(1) == "new_name");
+
+  //Пустые изменения и некорректный ответ
+  assert(apply("D|13|end|", reset) == false);
+  assert(apply("", reset) == false);
+  assert(apply("D|13|", reset) == false);
+  assert(version == 13);
+  assert(nicknames.size() == 2);
+
+  //Изменения от старой версии не откатывают копию
+  assert(apply("D|12|end|+name_1|", reset) == false);
+  assert(version == 13);
+  assert(nicknames.count("name_1") == 0);
+
+  //Изменения не поместились на страницу - версия последнего полученного
+  assert(apply("D|15|more|+page_1|", reset) == true);
+  assert(version == 15);
+  assert(apply("D|16|end|-page_1|", reset) == false);
+  assert(version == 16);
+  assert(nicknames.count("page_1") == 0);
+
+  //Страницы полного списка не меняют копию, пока не получены все
+  assert(apply("R|20|more|a_1|a_2|", reset) == true);
+  assert(reset.after == "a_2");
+  assert(version == 16);
+  assert(nicknames.size() == 2);
+  assert(apply("D|21|end|+a_3|", reset) == false);
+  assert(apply("R|22|more|", reset) == false);
+  assert(apply("R|22|end|a_3|", reset) == true);
+  assert(reset.isStarted == false && reset.after.empty());
+  assert(version == 20);
+  assert(nicknames.size() == 3);
+  nicknames = {"name_3", "new_name"};
+  version = 13;
+
+  //Поиск по началу Ника - по локальной копии
+  apply("D|14|end|+name_4|+other|", reset);
+  findNicknames("name_", 10, result);
+  assert(result->size() == 2);
+  assert(result->at(0) == "name_3");
+  assert(result->at(1) == "name_4");
+  findNicknames("name_", 1, result);
+  assert(result->size() == 1);
+  findNicknames("x", 10, result);
+  assert(result->empty());
+
+  //Вернуть модуль в исходное состояние
+  nicknames.clear();
+  version = 0;
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+/**
+\file Directory.h
+\brief Модуль "Справочник" - локальная копия списка Ников зарегистрированных пользователей
+Копия синхронизируется с сервером по версиям: сервер присылает только изменения
+после известной клиенту версии или полный список, если клиент слишком отстал.
+Пока пользователь в чате, копию в фоне обновляет модуль Notifier, поэтому найденные
+в копии Ники и дополнение Ников при вводе не требуют запросов серверу.
+Функции модуля можно вызывать из разных потоков
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+
+namespace directory{
+  /**
+  Запросить у сервера изменения и применить их к локальной копии
+  */
+  void sync();
+
+  /**
+  Загрузить Ники из локальной копии
+  \param[in] nicknames Указатель на вектор в который поместить Ники
+  */
+  void loadNicknames(std::shared_ptr<std::vector<std::string> > nicknames);
+
+  /**
+  Проверить зарегистрирован ли Ник. Ника нет в копии - копия могла устареть:
+  Ник проверяется запросом серверу
+  \param[in] nickname Ник
+  \return Признак зарегистрирован ли Ник
+  */
+  bool isRegistered(const std::string& nickname);
+
+  /**
+  \return Количество зарегистрированных пользователей (запрос серверу)
+  */
+  size_t getNumberUsers();
+
+  /**
+  Найти Ники с заданным началом (по алфавиту)
+  \param[in] prefix Начало Ника
+  \param[in] limit Максимальное количество Ников
+  \param[in] nicknames Результат - указатель на вектор Ников
+  */
+  void findNicknames(const std::string& prefix,
+                     size_t limit,
+                     std::shared_ptr<std::vector<std::string> > nicknames);
+
+  /**
+  \return Версия локальной копии (0 - копии нет)
+  */
+  uint64_t getVersion();
+
+  /**
+  Запустить тестирование методов модуля
+  */
+  void test();
+}
\ No newline at end of file
@@ -0,0 +1,324 @@
+#include "History.h"
+
+#include <fstream>
+#include <sstream>
+#include <mutex>
+#include <map>
+#include <limits>
+#include <cstdio>
+#include <unistd.h>
+#include <assert.h>
+
+#include "../Server/Server.h"
+#include "../SHA_1/SHA_1_Wrapper.h"
+
+
+namespace{
+  const std::string FILE_PREFIX = "history_";   //Начало имени файла истории
+  const std::string FILE_SUFFIX = ".dat";       //Расширение файла истории
+
+  //История одного пользователя
+  struct Store {
+    std::string path;                 //Файл истории
+    std::list<Message> messages;      //Сохранённые сообщения (от старых к новым)
+    uint64_t lastSequence = 0;        //Номер последнего сохранённого сообщения
+  };
+
+  std::mutex mutex;
+  std::map<std::string, Store> stores;  //Открытые истории по Логинам
+}
+
+
+//Имя файла истории: Логин может содержать любые символы - в имени его хэш
+static std::string makePath(const std::string& login);
+
+//Дописать в файл пакет сообщений - одна запись на каждый ответ сервера:
+//номер последнего сообщения, количество сообщений, затем Ник и текст каждого
+static bool appendBatch(const std::string& filePath,
+                        const std::list<Message>& batch,
+                        uint64_t batchLastSequence);
+
+//Прочитать из файла все целые пакеты сообщений
+//Возвращает длину прочитанной части файла - запись, оборванную при сбое, продолжает
+//следующая синхронизация, поэтому недописанный хвост отбрасывается
+static size_t readBatches(const std::string& filePath,
+                          std::list<Message>& result,
+                          uint64_t& resultLastSequence);
+
+//Записать в поток / прочитать из потока число или строку с длиной
+static void writeNumber(std::ostream& stream, uint64_t value, size_t bytes);
+static bool readNumber(std::istream& stream, uint64_t& value, size_t bytes);
+static void writeString(std::ostream& stream, const std::string& value);
+static bool readString(std::istream& stream, std::string& value);
+
+
+
+void history::open(const std::string& login)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  if (stores.count(login) != 0) {
+    return;
+  }
+  Store& store = stores[login];
+  store.path = makePath(login);
+
+  const size_t length = readBatches(store.path, store.messages, store.lastSequence);
+  std::ifstream stream(store.path, std::ios::binary | std::ios::ate);
+  if (stream && static_cast<size_t>(stream.tellg()) > length) {
+    stream.close();
+    truncate(store.path.c_str(), length);
+  }
+}
+
+
+
+bool history::sync(const std::string& login)
+{
+  uint64_t next = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto store = stores.find(login);
+    if (store == stores.end()) {
+      return false;
+    }
+    next = store->second.lastSequence + 1;
+  }
+
+  //Запрос - без блокировки: вывод истории не ждёт ответа сервера
+  while (true) {
+    std::list<Message> batch;
+    uint64_t batchLastSequence = 0;
+    server::getMessagesRange(login, next, std::numeric_limits<uint64_t>::max(),
+                             batch, batchLastSequence);
+    if (batch.empty()) {
+      return true;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    //Историю закрыли, пока шёл запрос
+    const auto found = stores.find(login);
+    if (found == stores.end()) {
+      return false;
+    }
+    Store& store = found->second;
+    //Другой поток уже дописал историю - продолжить после его сообщений
+    if (store.lastSequence + 1 != next) {
+      next = store.lastSequence + 1;
+      continue;
+    }
+    //Без записи на диск пакет не принимается - его загрузит следующая синхронизация
+    if (!appendBatch(store.path, batch, batchLastSequence)) {
+      return false;
+    }
+    store.messages.splice(store.messages.end(), batch);
+    store.lastSequence = batchLastSequence;
+    next = store.lastSequence + 1;
+  }
+}
+
+
+
+size_t history::loadMessages(const std::string& login, std::list<Message>& result,
+                             size_t limit)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  result.clear();
+  const auto store = stores.find(login);
+  if (store == stores.end()) {
+    return 0;
+  }
+  //Message не присваивается - только копируется; хвост отсчитывается с конца списка
+  const auto& messages = store->second.messages;
+  auto first = messages.end();
+  for (size_t i = 0; i < limit && first != messages.begin(); ++i) {
+    --first;
+  }
+  result.insert(result.end(), first, messages.end());
+  return messages.size();
+}
+
+
+
+uint64_t history::getLastSequence(const std::string& login)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  const auto store = stores.find(login);
+  return (store == stores.end()) ? 0 : store->second.lastSequence;
+}
+
+
+
+void history::remove(const std::string& login)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  const auto store = stores.find(login);
+  if (store == stores.end()) {
+    return;
+  }
+  std::remove(store->second.path.c_str());
+  stores.erase(store);
+}
+
+
+
+static std::string makePath(const std::string& login)
+{
+  return FILE_PREFIX + sha_1::toHex(sha_1::digest(login)) + FILE_SUFFIX;
+}
+
+
+
+static bool appendBatch(const std::string& filePath,
+                        const std::list<Message>& batch,
+                        uint64_t batchLastSequence)
+{
+  //Пакет собирается целиком и дописывается одной записью
+  std::string record;
+  {
+    std::ostringstream stream;
+    writeNumber(stream, batchLastSequence, sizeof(uint64_t));
+    writeNumber(stream, batch.size(), sizeof(uint32_t));
+    for (const auto& message : batch) {
+      writeString(stream, message.getNameFrom());
+      writeString(stream, message.getText());
+    }
+    record = stream.str();
+  }
+
+  std::ofstream stream(filePath, std::ios::binary | std::ios::app);
+  stream.write(record.data(), record.size());
+  stream.flush();
+  return static_cast<bool>(stream);
+}
+
+
+
+static size_t readBatches(const std::string& filePath,
+                          std::list<Message>& result,
+                          uint64_t& resultLastSequence)
+{
+  std::ifstream stream(filePath, std::ios::binary);
+  size_t length = 0;
+  uint64_t batchLastSequence = 0;
+  uint64_t count = 0;
+  while (readNumber(stream, batchLastSequence, sizeof(uint64_t)) &&
+         readNumber(stream, count, sizeof(uint32_t))) {
+    std::list<Message> batch;
+    std::string name;
+    std::string text;
+    for (uint64_t i = 0; i < count; ++i) {
+      if (!readString(stream, name) || !readString(stream, text)) {
+        return length;
+      }
+      batch.push_back(Message(name, text));
+    }
+    result.splice(result.end(), batch);
+    resultLastSequence = batchLastSequence;
+    length = static_cast<size_t>(stream.tellg());
+  }
+  return length;
+}
+
+
+
+static void writeNumber(std::ostream& stream, uint64_t value, size_t bytes)
+{
+  //Порядок байт - от младших к старшим, независимо от процессора
+  for (size_t i = 0; i < bytes; ++i) {
+    stream.put(static_cast<char>(value >> (8 * i)));
+  }
+}
+
+
+
+static bool readNumber(std::istream& stream, uint64_t& value, size_t bytes)
+{
+  value = 0;
+  for (size_t i = 0; i < bytes; ++i) {
+    const int byte = stream.get();
+    if (byte == std::char_traits<char>::eof()) {
+      return false;
+    }
+    value |= static_cast<uint64_t>(byte) << (8 * i);
+  }
+  return true;
+}
+
+
+
+static void writeString(std::ostream& stream, const std::string& value)
+{
+  writeNumber(stream, value.size(), sizeof(uint32_t));
+  stream.write(value.data(), value.size());
+}
+
+
+
+static bool readString(std::istream& stream, std::string& value)
+{
+  uint64_t size = 0;
+  if (!readNumber(stream, size, sizeof(uint32_t))) {
+    return false;
+  }
+  value.resize(size);
+  return static_cast<bool>(stream.read(&value[0], size));
+}
+
+
+
+void history::test()
+{
+  const std::string filePath = FILE_PREFIX + "test" + FILE_SUFFIX;
+  std::remove(filePath.c_str());
+
+  //Файла нет - история пуста
+  std::list<Message> loaded;
+  uint64_t loadedLastSequence = 0;
+  assert(readBatches(filePath, loaded, loadedLastSequence) == 0);
+  assert(loaded.empty() && loadedLastSequence == 0);
+
+  //Пакеты дописываются и читаются в том же порядке
+  std::list<Message> batch;
+  batch.push_back(Message("G", "Привет"));
+  batch.push_back(Message("S", "text: with colon"));
+  assert(appendBatch(filePath, batch, 2) == true);
+  batch.clear();
+  batch.push_back(Message("G", ""));
+  assert(appendBatch(filePath, batch, 7) == true);
+
+  const size_t length = readBatches(filePath, loaded, loadedLastSequence);
+  assert(loaded.size() == 3 && loadedLastSequence == 7);
+  assert(loaded.front().getNameFrom() == "G" && loaded.front().getText() == "Привет");
+  assert((++loaded.begin())->getText() == "text: with colon");
+  assert(loaded.back().getText().empty());
+
+  //Оборванный пакет не читается: длина - только целые пакеты
+  {
+    std::ofstream stream(filePath, std::ios::binary | std::ios::app);
+    writeNumber(stream, 9, sizeof(uint64_t));
+    writeNumber(stream, 2, sizeof(uint32_t));
+    writeString(stream, "S");
+  }
+  loaded.clear();
+  loadedLastSequence = 0;
+  assert(readBatches(filePath, loaded, loadedLastSequence) == length);
+  assert(loaded.size() == 3 && loadedLastSequence == 7);
+
+  std::remove(filePath.c_str());
+
+  //Из открытой истории загружается только хвост
+  const std::string login = "history test";
+  std::remove(makePath(login).c_str());
+  batch.clear();
+  batch.push_back(Message("G", "1"));
+  batch.push_back(Message("G", "2"));
+  batch.push_back(Message("S", "3"));
+  assert(appendBatch(makePath(login), batch, 3) == true);
+  history::open(login);
+  assert(history::loadMessages(login, loaded, 2) == 3);
+  assert(loaded.size() == 2 && loaded.front().getText() == "2" && loaded.back().getText() == "3");
+  assert(history::loadMessages(login, loaded, 10) == 3 && loaded.size() == 3);
+  assert(history::loadMessages(login, loaded, 0) == 3 && loaded.empty());
+  history::remove(login);
+  assert(history::loadMessages(login, loaded, 2) == 0 && loaded.empty());
+}
\ No newline at end of file
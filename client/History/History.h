@@ -0,0 +1,65 @@
+/**
+\file History.h
+\brief Модуль "История" - локальная копия сообщений пользователю на диске
+Копия хранится в файле (отдельном для каждого Логина), в который записи только
+дописываются. При синхронизации сервер присылает лишь сообщения с номерами после
+последнего сохранённого, поэтому после перезапуска клиента история выводится сразу
+из файла, а загружаются только новые сообщения. Если сервер недоступен, история
+выводится из копии. Функции модуля можно вызывать из разных потоков
+*/
+
+#pragma once
+
+#include <string>
+#include <list>
+#include <cstdint>
+#include <cstddef>
+
+#include "../Message/Message.h"
+
+
+namespace history{
+  /**
+  Открыть историю пользователя: прочитать сохранённые сообщения из файла
+  (повторный вызов с тем же Логином ничего не меняет). Открытыми могут быть
+  истории нескольких пользователей
+  \param[in] login Логин пользователя
+  */
+  void open(const std::string& login);
+
+  /**
+  Запросить у сервера сообщения после последнего сохранённого и дописать их в историю
+  (без открытой истории ничего не делает)
+  \param[in] login Логин пользователя
+  \return Признак того, что в историю загружены все сообщения сервера (false - история
+  закрыта или пакет не записан на диск)
+  */
+  bool sync(const std::string& login);
+
+  /**
+  Загрузить последние сообщения из истории: под блокировкой копируется только
+  хвост, а не вся история
+  \param[in] login Логин пользователя
+  \param[in] messages Результат - не больше limit последних сообщений (от старых к новым)
+  \param[in] limit Наибольшее количество сообщений
+  \return Количество сообщений во всей истории
+  */
+  size_t loadMessages(const std::string& login, std::list<Message>& messages, size_t limit);
+
+  /**
+  \param[in] login Логин пользователя
+  \return Номер последнего сохранённого сообщения (0 - история пуста или не открыта)
+  */
+  uint64_t getLastSequence(const std::string& login);
+
+  /**
+  Закрыть историю и удалить её файл (при удалении аккаунта)
+  \param[in] login Логин пользователя
+  */
+  void remove(const std::string& login);
+
+  /**
+  Запустить тестирование функций модуля
+  */
+  void test();
+}
\ No newline at end of file
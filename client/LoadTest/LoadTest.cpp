@@ -0,0 +1,325 @@
+#include "LoadTest.h"
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <map>
+#include <memory>
+#include <algorithm>
+#include <ctime>
+#include <cmath>
+#include <assert.h>
+
+#include "../Chat/Chat.h"
+#include "../Server/Server.h"
+#include "../Console/Console.h"
+#include "../Notifier/Notifier.h"
+#include "../History/History.h"
+
+
+namespace{
+  //Строки регистрации: Регистрация, Логин, Ник, Пароль
+  const std::string REGISTRATION_SCRIPT = "2\n{login}\n{nickname}\n{password}\n";
+  //Сценарий по умолчанию: отправить сообщение соседу, прочитать сообщения
+  const std::string DEFAULT_SCRIPT = "1\n{peer}\nmessage {round} from {nickname}\n2\n";
+  //Строки выхода: выход из чата, выход из программы
+  const std::string EXIT_SCRIPT = "4\n3\n";
+  const std::string PASSWORD = "load";
+  //Потоков этапа не больше: каждый поток по очереди ведёт несколько пользователей
+  const size_t MAX_WORKERS = 64;
+
+  using Clock = std::chrono::steady_clock;
+
+  //Этапы нагрузки
+  enum Stage{
+    REGISTRATION,
+    SCRIPT,
+    STAGES
+  };
+
+  //Замеры одного пользователя на одном этапе
+  struct Samples {
+    std::map<int, std::vector<uint32_t> > latencies;  //Время ответов по коду команды, мкс
+    std::map<int, size_t> failures;                    //Запросов без ответа по коду команды
+  };
+
+  //Имитируемый пользователь
+  struct Session {
+    std::unique_ptr<Chat> chat;
+    std::shared_ptr<bool> isRun;
+    std::map<std::string, std::string> values;  //Значения подстановок сценария
+    Samples samples[STAGES];
+    bool isAborted = false;                     //Сценарий прерван исключением
+  };
+
+  //Куда поток записывает замеры своих запросов
+  thread_local Samples* samples = nullptr;
+}
+
+
+//Записать время ответа на запрос потока (получатель модуля Server)
+static void record(int command, std::chrono::microseconds elapsed, bool isAnswered);
+
+//Подставить значения вместо {ключ} в тексте сценария
+static std::string substitute(const std::string& text,
+                              const std::map<std::string, std::string>& values);
+
+//Выполнить один шаг автомата чата по строкам сценария пользователя
+//Возвращает false, если сценарий пользователя закончен или прерван
+static bool step(Session& session, std::istream& input);
+
+//Выполнить этап: пул из не более MAX_WORKERS потоков по очереди выполняет шаги
+//своих пользователей, у каждого пользователя свои строки сценария
+//Возвращает время этапа, секунд
+static double runStage(std::vector<Session>& sessions, Stage stage,
+                       const std::vector<std::string>& scripts);
+
+//Вывести количество запросов, пропускную способность и процентили по командам этапа
+static void printReport(const std::string& title, const std::vector<Session>& sessions,
+                        Stage stage, double seconds);
+
+//Процентиль отсортированных значений (по ближайшему рангу)
+static uint32_t percentile(const std::vector<uint32_t>& sorted, double fraction);
+
+
+
+bool load_test::run(size_t users, size_t rounds, const std::string& scriptPath)
+{
+  std::string script = DEFAULT_SCRIPT;
+  if (!scriptPath.empty()) {
+    std::ifstream file(scriptPath);
+    if (!file) {
+      std::cerr << "Unable to read script " << scriptPath << std::endl;
+      return false;
+    }
+    std::ostringstream text;
+    text << file.rdbuf();
+    script = text.str();
+    if (!script.empty() && script.back() != '\n') {
+      script += '\n';
+    }
+  }
+  users = std::max<size_t>(users, 1);
+
+  //Логины и Ники разных запусков не совпадают
+  const std::string prefix = "L" + std::to_string(std::time(nullptr) % 1000000) + "u";
+  std::vector<Session> sessions(users);
+  std::vector<std::string> registrationScripts(users);
+  std::vector<std::string> sessionScripts(users);
+  for (size_t i = 0; i < users; ++i) {
+    Session& session = sessions[i];
+    session.chat = Chat::create();
+    session.isRun = std::make_shared<bool>(true);
+    session.chat->attach(session.isRun);
+    session.values["login"] = prefix + std::to_string(i);
+    session.values["nickname"] = prefix + std::to_string(i);
+    session.values["password"] = PASSWORD;
+    session.values["peer"] = prefix + std::to_string((i + 1) % users);
+
+    registrationScripts[i] = substitute(REGISTRATION_SCRIPT, session.values);
+    for (size_t round = 1; round <= rounds; ++round) {
+      session.values["round"] = std::to_string(round);
+      sessionScripts[i] += substitute(script, session.values);
+    }
+    sessionScripts[i] += EXIT_SCRIPT;
+  }
+
+  //Фоновые потоки уведомлений не нужны: у каждого пользователя был бы свой
+  notifier::setEnabled(false);
+  server::setObserver(record);
+  console::setSilent(true);
+
+  //Регистрация - отдельным этапом: к началу сценария все адресаты уже есть
+  const double registrationSeconds = runStage(sessions, REGISTRATION, registrationScripts);
+  const double scriptSeconds = runStage(sessions, SCRIPT, sessionScripts);
+
+  console::setSilent(false);
+  server::setObserver(nullptr);
+  for (const auto& session : sessions) {
+    history::remove(session.values.at("login"));
+  }
+
+  std::cout << "Load: " << users << " users, " << rounds << " rounds\n";
+  printReport("registration", sessions, REGISTRATION, registrationSeconds);
+  printReport("script", sessions, SCRIPT, scriptSeconds);
+  const size_t aborted = std::count_if(sessions.begin(), sessions.end(),
+                                       [](const Session& session) { return session.isAborted; });
+  if (aborted != 0) {
+    std::cout << "  aborted sessions: " << aborted << std::endl;
+  }
+  return true;
+}
+
+
+
+static void record(int command, std::chrono::microseconds elapsed, bool isAnswered)
+{
+  if (samples == nullptr) {
+    return;
+  }
+  if (isAnswered) {
+    samples->latencies[command].push_back(static_cast<uint32_t>(elapsed.count()));
+  } else {
+    ++samples->failures[command];
+  }
+}
+
+
+
+static std::string substitute(const std::string& text,
+                              const std::map<std::string, std::string>& values)
+{
+  std::string result;
+  size_t position = 0;
+  while (position < text.size()) {
+    const size_t open = text.find('{', position);
+    const size_t close = (open == std::string::npos) ? open : text.find('}', open);
+    if (close == std::string::npos) {
+      break;
+    }
+    result.append(text, position, open - position);
+    const auto value = values.find(text.substr(open + 1, close - open - 1));
+    //Неизвестный ключ остаётся как есть
+    if (value == values.end()) {
+      result.append(text, open, close + 1 - open);
+    } else {
+      result += value->second;
+    }
+    position = close + 1;
+  }
+  result.append(text, position, std::string::npos);
+  return result;
+}
+
+
+
+static bool step(Session& session, std::istream& input)
+{
+  if (!*session.isRun || (input >> std::ws).eof()) {
+    return false;
+  }
+  console::setInput(&input);
+  try {
+    session.chat->process();
+  }
+  //Ответ сервера не разобран и т.п. - этот пользователь дальше не участвует
+  catch (const std::exception&) {
+    session.isAborted = true;
+    *session.isRun = false;
+  }
+  console::setInput(nullptr);
+  return *session.isRun;
+}
+
+
+
+static double runStage(std::vector<Session>& sessions, Stage stage,
+                       const std::vector<std::string>& scripts)
+{
+  std::vector<std::istringstream> inputs;
+  inputs.reserve(sessions.size());
+  for (const auto& script : scripts) {
+    inputs.emplace_back(script);
+  }
+
+  const auto begin = Clock::now();
+  const size_t workers = std::min(sessions.size(), MAX_WORKERS);
+  std::vector<std::thread> threads;
+  for (size_t worker = 0; worker < workers; ++worker) {
+    threads.emplace_back([&sessions, &inputs, stage, worker, workers]() {
+      //Пользователи потока: каждый workers-й, начиная с worker
+      std::vector<size_t> active;
+      for (size_t i = worker; i < sessions.size(); i += workers) {
+        active.push_back(i);
+      }
+      //По шагу каждому пользователю по кругу, закончившие выбывают
+      while (!active.empty()) {
+        size_t kept = 0;
+        for (const size_t i : active) {
+          samples = &sessions[i].samples[stage];
+          if (step(sessions[i], inputs[i])) {
+            active[kept++] = i;
+          }
+        }
+        active.resize(kept);
+      }
+      samples = nullptr;
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+
+
+static void printReport(const std::string& title, const std::vector<Session>& sessions,
+                        Stage stage, double seconds)
+{
+  //Замеры всех пользователей по командам
+  std::map<int, std::vector<uint32_t> > latencies;
+  std::map<int, size_t> failures;
+  for (const auto& session : sessions) {
+    for (const auto& command : session.samples[stage].latencies) {
+      auto& merged = latencies[command.first];
+      merged.insert(merged.end(), command.second.begin(), command.second.end());
+    }
+    for (const auto& command : session.samples[stage].failures) {
+      failures[command.first] += command.second;
+      latencies[command.first];
+    }
+  }
+
+  std::cout << "  " << title << ": " << std::fixed << std::setprecision(2) << seconds << " s\n"
+            << "    command                   requests  failed      req/s   p50, us   p90, us"
+            << "   p99, us   max, us\n";
+  for (auto& command : latencies) {
+    auto& values = command.second;
+    std::sort(values.begin(), values.end());
+    std::cout << "    " << std::left << std::setw(24) << server::getCommandName(command.first)
+              << std::right << std::setw(10) << values.size()
+              << std::setw(8) << failures[command.first]
+              << std::setw(11) << std::setprecision(1) << values.size() / seconds
+              << std::setw(10) << percentile(values, 0.50)
+              << std::setw(10) << percentile(values, 0.90)
+              << std::setw(10) << percentile(values, 0.99)
+              << std::setw(10) << (values.empty() ? 0 : values.back()) << "\n";
+  }
+  std::cout << std::flush;
+}
+
+
+
+static uint32_t percentile(const std::vector<uint32_t>& sorted, double fraction)
+{
+  if (sorted.empty()) {
+    return 0;
+  }
+  //Наименьшее значение, не меньше которого fraction всех значений
+  size_t rank = static_cast<size_t>(std::ceil(fraction * sorted.size() - 1e-9));
+  rank = std::min(std::max<size_t>(rank, 1), sorted.size());
+  return sorted[rank - 1];
+}
+
+
+
+void load_test::test()
+{
+  const std::map<std::string, std::string> values = {{"login", "L1u0"}, {"peer", "L1u1"}};
+  assert(substitute("", values) == "");
+  assert(substitute("1\n{peer}\ntext\n", values) == "1\nL1u1\ntext\n");
+  assert(substitute("{login}{peer}", values) == "L1u0L1u1");
+  assert(substitute("{unknown} {", values) == "{unknown} {");
+
+  const std::vector<uint32_t> sorted = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+  assert(percentile(sorted, 0.50) == 5);
+  assert(percentile(sorted, 0.90) == 9);
+  assert(percentile(sorted, 0.99) == 10);
+  assert(percentile({7}, 0.50) == 7);
+  assert(percentile({}, 0.99) == 0);
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+/**
+\file LoadTest.h
+\brief Модуль "Нагрузка" - безголовый режим клиента для нагрузки на сервер
+Запускается вместо интерактивного клиента: ./client load USERS ROUNDS [SCRIPT]
+В одном процессе работают USERS пользователей, у каждого свой объект Chat. Потоков
+не больше 64: каждый поток по очереди выполняет шаги автомата своих пользователей,
+так что одновременно ждут ответа сервера не больше 64 запросов. Автомат чата получает строки не с консоли, а из сценария: сначала все
+пользователи регистрируются, затем каждый ROUNDS раз выполняет сценарий и выходит.
+В конце выводится количество запросов, пропускная способность и процентили
+времени ответа по каждой команде сервера.
+Сценарий - строки ввода чата (по умолчанию: отправить сообщение соседу и прочитать
+сообщения). В строках подставляются {login}, {nickname}, {peer} (Ник соседа) и
+{round} (номер повтора)
+*/
+
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+
+namespace load_test{
+  /**
+  Выполнить сценарий за заданное количество пользователей и вывести результаты в консоль
+  \param[in] users Количество пользователей
+  \param[in] rounds Сколько раз каждый пользователь выполняет сценарий
+  \param[in] scriptPath Файл сценария (пустая строка - сценарий по умолчанию)
+  \return Признак того, что сценарий выполнен (false - не прочитан файл сценария)
+  */
+  bool run(size_t users, size_t rounds, const std::string& scriptPath);
+
+  /**
+  Запустить тестирование функций модуля
+  */
+  void test();
+}
\ No newline at end of file
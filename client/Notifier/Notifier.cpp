@@ -0,0 +1,141 @@
+#include "Notifier.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <list>
+#include <memory>
+#include <algorithm>
+
+#include "../Server/Server.h"
+#include "../Console/Console.h"
+#include "../Directory/Directory.h"
+#include "../History/History.h"
+
+
+namespace{
+  const std::chrono::seconds POLL_INTERVAL(2);  //Период запроса непрочитанных сообщений
+
+  std::mutex mutex;
+  std::condition_variable wakeUp;
+  std::thread worker;
+  bool isRunning = false;
+  std::string watched;    //Логин, за сообщениями которого следит поток
+  bool isEnabled = true;  //Слежение разрешено (в безголовом режиме - нет)
+}
+
+
+//Цикл фонового потока: запрашивать непрочитанные, пока слежение не остановлено
+static void poll(const std::string& login);
+
+//Вывести последние сообщения собеседника
+static void showNew(const std::string& login, const std::string& peer, size_t count);
+
+
+
+void notifier::watch(const std::string& login)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!isEnabled || (isRunning && watched == login)) {
+      return;
+    }
+  }
+  stop();
+
+  std::lock_guard<std::mutex> lock(mutex);
+  watched = login;
+  isRunning = true;
+  worker = std::thread(poll, login);
+}
+
+
+
+void notifier::stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!isRunning) {
+      return;
+    }
+    isRunning = false;
+  }
+  wakeUp.notify_all();
+  worker.join();
+}
+
+
+
+void notifier::setEnabled(bool enabled)
+{
+  if (!enabled) {
+    stop();
+  }
+  std::lock_guard<std::mutex> lock(mutex);
+  isEnabled = enabled;
+}
+
+
+
+static void poll(const std::string& login)
+{
+  //Номер последнего известного сообщения по каждому собеседнику. Первый ответ -
+  //отправная точка: о том, что уже было непрочитанным, сообщает сам чат
+  std::map<std::string, uint64_t> known;
+  bool isFirst = true;
+
+  std::unique_lock<std::mutex> lock(mutex);
+  while (isRunning) {
+    lock.unlock();
+    try {
+      //Один запрос на шаг: непрочитанные, версия списка Ников и номер последнего
+      //сообщения - остальные запросы только при изменениях на сервере
+      server::Updates updates;
+      if (server::getUpdates(login, updates)) {
+        for (const auto& count : updates.counts) {
+          uint64_t& last = known[count.name];
+          if (!isFirst && count.lastSequence > last) {
+            showNew(login, count.name, std::min<uint64_t>(count.count, count.lastSequence - last));
+          }
+          last = std::max(last, count.lastSequence);
+        }
+        isFirst = false;
+
+        //Заодно обновить список Ников - проверки адресатов не ходят на сервер -
+        //и историю сообщений: при просмотре загружать будет почти нечего
+        if (updates.directoryVersion != directory::getVersion()) {
+          directory::sync();
+        }
+        history::open(login);
+        if (updates.lastSequence > history::getLastSequence(login)) {
+          history::sync(login);
+        }
+      }
+    }
+    //Сервер недоступен или не ответил - повторить на следующем шаге
+    catch (const std::exception&) {
+    }
+    lock.lock();
+    wakeUp.wait_for(lock, POLL_INTERVAL, []() { return !isRunning; });
+  }
+}
+
+
+
+static void showNew(const std::string& login, const std::string& peer, size_t count)
+{
+  //Переписка включает и свои сообщения - показать только сообщения собеседника
+  auto messages = std::make_shared<std::list<Message> >();
+  uint64_t firstSequence = 0;
+  if (!server::getConversation(login, peer, 0, count, messages, firstSequence)) {
+    return;
+  }
+  for (const auto& message : *messages) {
+    if (message.getNameFrom() == peer) {
+      console::notify("Новое сообщение от " + peer + ": " + message.getText());
+    }
+  }
+}
\ No newline at end of file
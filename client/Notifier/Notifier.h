@@ -0,0 +1,38 @@
+/**
+\file Notifier.h
+\brief Модуль "Уведомления" - фоновый поток, показывающий новые сообщения
+Сервер отвечает только на запросы и закрывает соединение после ответа - сам
+сообщить о новом сообщении он не может. Поэтому уведомления - это опрос: поток
+раз в несколько секунд одним запросом (server::getUpdates) получает количество
+непрочитанных сообщений, версию списка Ников и номер последнего сообщения.
+По собеседникам, у которых появились новые сообщения, он загружает их текст и
+выводит через console::notify - не прерывая строку, которую пользователь сейчас
+набирает. Локальный список Ников (модуль Directory) и история сообщений (модуль
+History) запрашиваются тем же циклом, только когда на сервере они изменились.
+*/
+
+#pragma once
+
+#include <string>
+
+
+namespace notifier{
+  /**
+  Следить за новыми сообщениями пользователя (повторный вызов с тем же Логином
+  ничего не меняет, с другим - переключает слежение)
+  \param[in] login Логин пользователя
+  */
+  void watch(const std::string& login);
+
+  /**
+  Прекратить слежение и дождаться завершения фонового потока
+  */
+  void stop();
+
+  /**
+  Разрешить или запретить слежение (запрет останавливает фоновый поток, а watch
+  ничего не делает - например, когда в одном процессе работают многие пользователи)
+  \param[in] enabled Признак разрешения
+  */
+  void setEnabled(bool enabled);
+}
\ No newline at end of file
@@ -1,11 +1,759 @@
-#include "SHA_1_Wrapper.h"
-
-#include "sha1.hpp"
-
-
-std::string sha_1::hash(const std::string& value)
-{
-	auto checksum = std::make_unique<SHA1>();
-	checksum->update(value);
-	return checksum->final();
+#include "SHA_1_Wrapper.h"
+
+#include <string.h>
+#include <algorithm>
+#include <utility>
+#include <assert.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <immintrin.h>
+#define SHA_1_X86
+#endif
+
+
+namespace {
+	const size_t BLOCK_BYTES = 64;	//Размер блока
+	const size_t LENGTH_OFFSET = BLOCK_BYTES - 8;	//Место длины данных в последнем блоке
+
+	//Сжатие подряд идущих блоков в промежуточный хэш
+	using CompressBlocks = void (*)(uint32_t state[5], const uint8_t* data, size_t blocks);
+
+	const size_t LANES = 8;	//Хэшей, считаемых одновременно в полосах регистра AVX2
+	const size_t MIN_LANES = 3;	//Меньше строк выгоднее считать по одной переносимым кодом
+}
+
+
+//Циклический сдвиг влево
+static inline uint32_t rotate(uint32_t value, int bits);
+
+//Функции раундов sha-1
+static inline uint32_t choose(uint32_t b, uint32_t c, uint32_t d);
+static inline uint32_t parity(uint32_t b, uint32_t c, uint32_t d);
+static inline uint32_t majority(uint32_t b, uint32_t c, uint32_t d);
+
+//Один раунд: результат в e, b сдвигается (остальные переменные не меняются)
+template <uint32_t (*F)(uint32_t, uint32_t, uint32_t)>
+static inline void round(uint32_t w[16], uint32_t a, uint32_t& b, uint32_t c, uint32_t d,
+	uint32_t& e, size_t i, uint32_t k);
+
+//Сжать один блок в промежуточный хэш
+static void compress(uint32_t state[5], const uint8_t* block);
+
+//Сжать блоки переносимым кодом
+static void compressPortable(uint32_t state[5], const uint8_t* data, size_t blocks);
+
+#ifdef SHA_1_X86
+//Процессор поддерживает инструкции SHA (и нужные им SSSE3, SSE4.1)
+static bool isShaNiSupported();
+
+//Сжать блоки инструкциями SHA
+static void compressShaNi(uint32_t state[5], const uint8_t* data, size_t blocks);
+#endif
+
+//Проверить текущую реализацию сжатия
+static void testBackend();
+
+#ifdef SHA_1_X86
+//Процессор поддерживает инструкции AVX2
+static bool isAvx2Supported();
+
+//Хэши до LANES строк одновременно - по строке в каждой полосе регистров AVX2
+static void digestLanesAvx2(const std::string_view* values, size_t count, sha_1::Digest* digests);
+#endif
+
+//Реализация сжатия для процессора, на котором запущена программа
+static sha_1::Backend detectBackend();
+
+//Функция сжатия реализации
+static CompressBlocks getCompress(sha_1::Backend backend);
+
+namespace {
+	//Реализация выбирается один раз при запуске программы
+	sha_1::Backend backend = detectBackend();
+	CompressBlocks compressBlocks = getCompress(backend);
+#ifdef SHA_1_X86
+	bool isBatchVectorized = isAvx2Supported();
+#endif
+}
+
+
+
+sha_1::Hasher::Hasher()
+{
+	reset();
+}
+
+
+
+void sha_1::Hasher::update(const void* data, size_t size)
+{
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	length_ += size;
+
+	//Дополнить неполный блок
+	if (buffered_ > 0) {
+		const size_t part = std::min(size, BLOCK_BYTES - buffered_);
+		memcpy(buffer_ + buffered_, bytes, part);
+		buffered_ += part;
+		bytes += part;
+		size -= part;
+		if (buffered_ < BLOCK_BYTES) {
+			return;
+		}
+		compressBlocks(state_, buffer_, 1);
+		buffered_ = 0;
+	}
+
+	//Полные блоки сжимаются без копирования
+	const size_t blocks = size / BLOCK_BYTES;
+	compressBlocks(state_, bytes, blocks);
+	bytes += blocks * BLOCK_BYTES;
+	size -= blocks * BLOCK_BYTES;
+	memcpy(buffer_, bytes, size);
+	buffered_ = size;
+}
+
+
+
+sha_1::Digest sha_1::Hasher::finish()
+{
+	const uint64_t bits = length_ * 8;
+
+	//Дополнение: бит 1, нули и длина данных в битах в конце последнего блока
+	buffer_[buffered_++] = 0x80;
+	if (buffered_ > LENGTH_OFFSET) {
+		memset(buffer_ + buffered_, 0, BLOCK_BYTES - buffered_);
+		compressBlocks(state_, buffer_, 1);
+		buffered_ = 0;
+	}
+	memset(buffer_ + buffered_, 0, LENGTH_OFFSET - buffered_);
+	for (size_t i = 0; i < 8; ++i) {
+		buffer_[LENGTH_OFFSET + i] = static_cast<uint8_t>(bits >> (56 - 8 * i));
+	}
+	compressBlocks(state_, buffer_, 1);
+
+	Digest result;
+	for (size_t i = 0; i < result.size(); ++i) {
+		result[i] = static_cast<uint8_t>(state_[i / 4] >> (24 - 8 * (i % 4)));
+	}
+	reset();
+	return result;
+}
+
+
+
+void sha_1::Hasher::reset()
+{
+	state_[0] = 0x67452301;
+	state_[1] = 0xefcdab89;
+	state_[2] = 0x98badcfe;
+	state_[3] = 0x10325476;
+	state_[4] = 0xc3d2e1f0;
+	buffered_ = 0;
+	length_ = 0;
+}
+
+
+
+sha_1::Digest sha_1::digest(const std::string& value)
+{
+	Hasher hasher;
+	hasher.update(value.data(), value.size());
+	return hasher.finish();
+}
+
+
+
+std::string sha_1::toHex(const Digest& digest)
+{
+	const char digits[] = "0123456789abcdef";
+	std::string result(digest.size() * 2, '0');
+	for (size_t i = 0; i < digest.size(); ++i) {
+		result[2 * i] = digits[digest[i] >> 4];
+		result[2 * i + 1] = digits[digest[i] & 0xF];
+	}
+	return result;
+}
+
+
+
+bool sha_1::fromHex(std::string_view hex, Digest& digest)
+{
+	if (hex.size() != digest.size() * 2) {
+		return false;
+	}
+	//Значение шестнадцатеричной цифры, -1 - не цифра
+	const auto value = [](char symbol) {
+		if (symbol >= '0' && symbol <= '9') {
+			return symbol - '0';
+		}
+		symbol |= 0x20;
+		if (symbol >= 'a' && symbol <= 'f') {
+			return symbol - 'a' + 10;
+		}
+		return -1;
+	};
+	for (size_t i = 0; i < digest.size(); ++i) {
+		const int high = value(hex[2 * i]);
+		const int low = value(hex[2 * i + 1]);
+		if (high < 0 || low < 0) {
+			return false;
+		}
+		digest[i] = static_cast<uint8_t>(high << 4 | low);
+	}
+	return true;
+}
+
+
+
+std::string sha_1::hash(const std::string& value)
+{
+	return toHex(digest(value));
+}
+
+
+
+void sha_1::digestBatch(const std::vector<std::string_view>& values, std::vector<Digest>& digests)
+{
+	digests.resize(values.size());
+	size_t done = 0;
+#ifdef SHA_1_X86
+	//Группы по LANES строк - одним проходом векторного кода. Инструкциями SHA
+	//строка считается почти так же быстро, как полная группа в полосах - тогда
+	//векторный код выгоден только для полных групп
+	const size_t minLanes = (backend == Backend::SHA_NI) ? LANES : MIN_LANES;
+	if (isBatchVectorized) {
+		while (values.size() - done >= minLanes) {
+			const size_t count = std::min(LANES, values.size() - done);
+			digestLanesAvx2(values.data() + done, count, digests.data() + done);
+			done += count;
+		}
+	}
+#endif
+	//Остаток - по одной строке
+	for (; done < values.size(); ++done) {
+		Hasher hasher;
+		hasher.update(values[done].data(), values[done].size());
+		digests[done] = hasher.finish();
+	}
+}
+
+
+
+void sha_1::hashBatch(const std::vector<std::string_view>& values, std::vector<std::string>& hashes)
+{
+	std::vector<Digest> digests;
+	digestBatch(values, digests);
+	hashes.resize(digests.size());
+	for (size_t i = 0; i < digests.size(); ++i) {
+		hashes[i] = toHex(digests[i]);
+	}
+}
+
+
+
+sha_1::Backend sha_1::getBackend()
+{
+	return backend;
+}
+
+
+
+bool sha_1::setBackend(Backend value)
+{
+	if (value != Backend::PORTABLE && value != detectBackend()) {
+		return false;
+	}
+	backend = value;
+	compressBlocks = getCompress(value);
+	return true;
+}
+
+
+
+static sha_1::Backend detectBackend()
+{
+#ifdef SHA_1_X86
+	if (isShaNiSupported()) {
+		return sha_1::Backend::SHA_NI;
+	}
+#endif
+	return sha_1::Backend::PORTABLE;
+}
+
+
+
+static CompressBlocks getCompress(sha_1::Backend backend)
+{
+#ifdef SHA_1_X86
+	if (backend == sha_1::Backend::SHA_NI) {
+		return compressShaNi;
+	}
+#endif
+	return compressPortable;
+}
+
+
+
+static inline uint32_t rotate(uint32_t value, int bits)
+{
+	return (value << bits) | (value >> (32 - bits));
+}
+
+
+
+static inline uint32_t choose(uint32_t b, uint32_t c, uint32_t d)
+{
+	return d ^ (b & (c ^ d));
+}
+
+
+
+static inline uint32_t parity(uint32_t b, uint32_t c, uint32_t d)
+{
+	return b ^ c ^ d;
+}
+
+
+
+static inline uint32_t majority(uint32_t b, uint32_t c, uint32_t d)
+{
+	return (b & c) | (d & (b | c));
+}
+
+
+
+template <uint32_t (*F)(uint32_t, uint32_t, uint32_t)>
+static inline void round(uint32_t w[16], uint32_t a, uint32_t& b, uint32_t c, uint32_t d,
+	uint32_t& e, size_t i, uint32_t k)
+{
+	//Расписание: слово раунда i >= 16 заменяет слово раунда i - 16
+	if (i >= 16) {
+		w[i & 15] = rotate(w[(i + 13) & 15] ^ w[(i + 8) & 15] ^ w[(i + 2) & 15] ^ w[i & 15], 1);
+	}
+	e += rotate(a, 5) + F(b, c, d) + k + w[i & 15];
+	b = rotate(b, 30);
+}
+
+
+
+static void compress(uint32_t state[5], const uint8_t* block)
+{
+	//Слова блока (big-endian) - расписание раундов хранит только последние 16
+	uint32_t w[16];
+	for (size_t i = 0; i < 16; ++i) {
+		w[i] = static_cast<uint32_t>(block[4 * i]) << 24 |
+			static_cast<uint32_t>(block[4 * i + 1]) << 16 |
+			static_cast<uint32_t>(block[4 * i + 2]) << 8 |
+			static_cast<uint32_t>(block[4 * i + 3]);
+	}
+
+	uint32_t a = state[0];
+	uint32_t b = state[1];
+	uint32_t c = state[2];
+	uint32_t d = state[3];
+	uint32_t e = state[4];
+
+	//Четыре группы по 20 раундов - у каждой своя функция и константа.
+	//Пять раундов подряд меняют ролями переменные вместо их перекладывания
+	for (size_t i = 0; i < 20; i += 5) {
+		round<choose>(w, a, b, c, d, e, i, 0x5a827999);
+		round<choose>(w, e, a, b, c, d, i + 1, 0x5a827999);
+		round<choose>(w, d, e, a, b, c, i + 2, 0x5a827999);
+		round<choose>(w, c, d, e, a, b, i + 3, 0x5a827999);
+		round<choose>(w, b, c, d, e, a, i + 4, 0x5a827999);
+	}
+	for (size_t i = 20; i < 40; i += 5) {
+		round<parity>(w, a, b, c, d, e, i, 0x6ed9eba1);
+		round<parity>(w, e, a, b, c, d, i + 1, 0x6ed9eba1);
+		round<parity>(w, d, e, a, b, c, i + 2, 0x6ed9eba1);
+		round<parity>(w, c, d, e, a, b, i + 3, 0x6ed9eba1);
+		round<parity>(w, b, c, d, e, a, i + 4, 0x6ed9eba1);
+	}
+	for (size_t i = 40; i < 60; i += 5) {
+		round<majority>(w, a, b, c, d, e, i, 0x8f1bbcdc);
+		round<majority>(w, e, a, b, c, d, i + 1, 0x8f1bbcdc);
+		round<majority>(w, d, e, a, b, c, i + 2, 0x8f1bbcdc);
+		round<majority>(w, c, d, e, a, b, i + 3, 0x8f1bbcdc);
+		round<majority>(w, b, c, d, e, a, i + 4, 0x8f1bbcdc);
+	}
+	for (size_t i = 60; i < 80; i += 5) {
+		round<parity>(w, a, b, c, d, e, i, 0xca62c1d6);
+		round<parity>(w, e, a, b, c, d, i + 1, 0xca62c1d6);
+		round<parity>(w, d, e, a, b, c, i + 2, 0xca62c1d6);
+		round<parity>(w, c, d, e, a, b, i + 3, 0xca62c1d6);
+		round<parity>(w, b, c, d, e, a, i + 4, 0xca62c1d6);
+	}
+	state[0] += a;
+	state[1] += b;
+	state[2] += c;
+	state[3] += d;
+	state[4] += e;
+}
+
+
+
+static void compressPortable(uint32_t state[5], const uint8_t* data, size_t blocks)
+{
+	for (; blocks > 0; --blocks, data += BLOCK_BYTES) {
+		compress(state, data);
+	}
+}
+
+
+
+#ifdef SHA_1_X86
+static bool isShaNiSupported()
+{
+	unsigned int eax = 0;
+	unsigned int ebx = 0;
+	unsigned int ecx = 0;
+	unsigned int edx = 0;
+	//Лист 1: ECX бит 9 - SSSE3, бит 19 - SSE4.1
+	if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(ecx & (1u << 9)) || !(ecx & (1u << 19))) {
+		return false;
+	}
+	//Лист 7: EBX бит 29 - SHA
+	if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+		return false;
+	}
+	return (ebx & (1u << 29)) != 0;
+}
+
+
+
+/*
+Четыре раунда (группа K из 20) инструкциями SHA.
+Слова расписания группы K лежат в message[K % 4]; в той же группе
+заканчивается расчёт слов группы K + 1 и продолжается - групп K + 2, K + 3
+*/
+template <int K>
+__attribute__((target("sha,ssse3,sse4.1")))
+static inline void shaNiRounds(__m128i& abcd, __m128i& e0, __m128i& e1, __m128i message[4],
+	const uint8_t* block, __m128i byteOrder)
+{
+	__m128i& current = message[K % 4];
+	if (K < 4) {
+		current = _mm_shuffle_epi8(
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * K)), byteOrder);
+	}
+	__m128i& e = (K % 2 == 0) ? e0 : e1;
+	__m128i& next = (K % 2 == 0) ? e1 : e0;
+	e = (K == 0) ? _mm_add_epi32(e, current) : _mm_sha1nexte_epu32(e, current);
+	next = abcd;
+	if (K >= 3 && K <= 18) {
+		message[(K + 1) % 4] = _mm_sha1msg2_epu32(message[(K + 1) % 4], current);
+	}
+	abcd = _mm_sha1rnds4_epu32(abcd, e, K / 5);
+	if (K >= 1 && K <= 16) {
+		message[(K + 3) % 4] = _mm_sha1msg1_epu32(message[(K + 3) % 4], current);
+	}
+	if (K >= 2 && K <= 17) {
+		message[(K + 2) % 4] = _mm_xor_si128(message[(K + 2) % 4], current);
+	}
+}
+
+
+
+//Все 80 раундов блока
+template <int... K>
+__attribute__((target("sha,ssse3,sse4.1")))
+static inline void shaNiBlock(__m128i& abcd, __m128i& e0, const uint8_t* block,
+	__m128i byteOrder, std::integer_sequence<int, K...>)
+{
+	__m128i e1;
+	__m128i message[4];
+	(shaNiRounds<K>(abcd, e0, e1, message, block, byteOrder), ...);
+}
+
+
+
+__attribute__((target("sha,ssse3,sse4.1")))
+static void compressShaNi(uint32_t state[5], const uint8_t* data, size_t blocks)
+{
+	//Слова блока big-endian, а A в старшей части регистра
+	const __m128i byteOrder = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+	__m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0x1B);
+	__m128i e0 = _mm_set_epi32(static_cast<int>(state[4]), 0, 0, 0);
+
+	for (; blocks > 0; --blocks, data += BLOCK_BYTES) {
+		const __m128i abcdSaved = abcd;
+		const __m128i eSaved = e0;
+		shaNiBlock(abcd, e0, data, byteOrder, std::make_integer_sequence<int, 20>());
+		e0 = _mm_sha1nexte_epu32(e0, eSaved);
+		abcd = _mm_add_epi32(abcd, abcdSaved);
+	}
+
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_shuffle_epi32(abcd, 0x1B));
+	state[4] = static_cast<uint32_t>(_mm_extract_epi32(e0, 3));
+}
+
+
+
+static bool isAvx2Supported()
+{
+	return __builtin_cpu_supports("avx2");
+}
+
+
+
+//Циклический сдвиг влево всех полос
+template <int BITS>
+__attribute__((target("avx2")))
+static inline __m256i rotateLanes(__m256i value)
+{
+	return _mm256_or_si256(_mm256_slli_epi32(value, BITS), _mm256_srli_epi32(value, 32 - BITS));
+}
+
+
+
+//Один раунд во всех полосах: GROUP - номер группы из 20 раундов (функция раунда)
+template <int GROUP>
+__attribute__((target("avx2")))
+static inline void roundLanes(__m256i w[16], __m256i a, __m256i& b, __m256i c, __m256i d,
+	__m256i& e, size_t i, __m256i k)
+{
+	if (i >= 16) {
+		w[i & 15] = rotateLanes<1>(_mm256_xor_si256(
+			_mm256_xor_si256(w[(i + 13) & 15], w[(i + 8) & 15]),
+			_mm256_xor_si256(w[(i + 2) & 15], w[i & 15])));
+	}
+	__m256i f;
+	if (GROUP == 0) {
+		f = _mm256_xor_si256(d, _mm256_and_si256(b, _mm256_xor_si256(c, d)));
+	} else if (GROUP == 2) {
+		f = _mm256_or_si256(_mm256_and_si256(b, c), _mm256_and_si256(d, _mm256_or_si256(b, c)));
+	} else {
+		f = _mm256_xor_si256(_mm256_xor_si256(b, c), d);
+	}
+	e = _mm256_add_epi32(_mm256_add_epi32(e, rotateLanes<5>(a)),
+		_mm256_add_epi32(_mm256_add_epi32(f, k), w[i & 15]));
+	b = rotateLanes<30>(b);
+}
+
+
+
+//20 раундов группы GROUP во всех полосах
+template <int GROUP>
+__attribute__((target("avx2")))
+static inline void roundGroupLanes(__m256i w[16], __m256i& a, __m256i& b, __m256i& c,
+	__m256i& d, __m256i& e, uint32_t constant)
+{
+	const __m256i k = _mm256_set1_epi32(static_cast<int>(constant));
+	for (size_t i = GROUP * 20; i < GROUP * 20 + 20; i += 5) {
+		roundLanes<GROUP>(w, a, b, c, d, e, i, k);
+		roundLanes<GROUP>(w, e, a, b, c, d, i + 1, k);
+		roundLanes<GROUP>(w, d, e, a, b, c, i + 2, k);
+		roundLanes<GROUP>(w, c, d, e, a, b, i + 3, k);
+		roundLanes<GROUP>(w, b, c, d, e, a, i + 4, k);
+	}
+}
+
+
+
+//Транспонировать матрицу 8x8 слов: строка i результата - столбец i исходной
+__attribute__((target("avx2")))
+static inline void transposeLanes(const __m256i rows[8], __m256i columns[8])
+{
+	//Пары строк - чередование слов, четвёрки строк - чередование пар слов
+	__m256i pairs[8];
+	for (size_t i = 0; i < 8; i += 2) {
+		pairs[i] = _mm256_unpacklo_epi32(rows[i], rows[i + 1]);
+		pairs[i + 1] = _mm256_unpackhi_epi32(rows[i], rows[i + 1]);
+	}
+	__m256i quads[8];
+	for (size_t i = 0; i < 8; i += 4) {
+		quads[i] = _mm256_unpacklo_epi64(pairs[i], pairs[i + 2]);
+		quads[i + 1] = _mm256_unpackhi_epi64(pairs[i], pairs[i + 2]);
+		quads[i + 2] = _mm256_unpacklo_epi64(pairs[i + 1], pairs[i + 3]);
+		quads[i + 3] = _mm256_unpackhi_epi64(pairs[i + 1], pairs[i + 3]);
+	}
+	//Младшие половины - слова 0..3, старшие - слова 4..7
+	for (size_t i = 0; i < 4; ++i) {
+		columns[i] = _mm256_permute2x128_si256(quads[i], quads[i + 4], 0x20);
+		columns[i + 4] = _mm256_permute2x128_si256(quads[i], quads[i + 4], 0x31);
+	}
+}
+
+
+
+__attribute__((target("avx2")))
+static void digestLanesAvx2(const std::string_view* values, size_t count, sha_1::Digest* digests)
+{
+	//Последние (один или два) блока каждой строки - с дополнением и длиной
+	uint8_t tails[LANES][2 * BLOCK_BYTES];
+	size_t fullBlocks[LANES] = {};
+	size_t blocks[LANES] = {};
+	size_t maxBlocks = 0;
+	for (size_t lane = 0; lane < count; ++lane) {
+		const size_t size = values[lane].size();
+		fullBlocks[lane] = size / BLOCK_BYTES;
+		blocks[lane] = (size + 8) / BLOCK_BYTES + 1;
+		maxBlocks = std::max(maxBlocks, blocks[lane]);
+
+		const size_t rest = size - fullBlocks[lane] * BLOCK_BYTES;
+		const size_t tailBytes = (blocks[lane] - fullBlocks[lane]) * BLOCK_BYTES;
+		memcpy(tails[lane], values[lane].data() + fullBlocks[lane] * BLOCK_BYTES, rest);
+		tails[lane][rest] = 0x80;
+		memset(tails[lane] + rest + 1, 0, tailBytes - rest - 1);
+		const uint64_t bits = static_cast<uint64_t>(size) * 8;
+		for (size_t i = 0; i < 8; ++i) {
+			tails[lane][tailBytes - 8 + i] = static_cast<uint8_t>(bits >> (56 - 8 * i));
+		}
+	}
+
+	const __m256i byteOrder = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+		3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+	const uint32_t initial[5] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+	__m256i state[5];
+	for (size_t i = 0; i < 5; ++i) {
+		state[i] = _mm256_set1_epi32(static_cast<int>(initial[i]));
+	}
+
+	for (size_t j = 0; j < maxBlocks; ++j) {
+		//Блок каждой полосы; у закончившихся полос блок любой, их хэш не меняется
+		const uint8_t* block[LANES];
+		alignas(32) int32_t active[LANES];
+		for (size_t lane = 0; lane < LANES; ++lane) {
+			const bool isActive = lane < count && j < blocks[lane];
+			active[lane] = isActive ? -1 : 0;
+			if (!isActive) {
+				block[lane] = tails[0];
+			} else if (j < fullBlocks[lane]) {
+				block[lane] = reinterpret_cast<const uint8_t*>(values[lane].data()) + j * BLOCK_BYTES;
+			} else {
+				block[lane] = tails[lane] + (j - fullBlocks[lane]) * BLOCK_BYTES;
+			}
+		}
+
+		//Слово t расписания всех полос - слова t блоков полос (big-endian):
+		//блоки полос - строки матриц 8x8 слов, расписание - их столбцы
+		__m256i w[16];
+		for (size_t half = 0; half < 2; ++half) {
+			__m256i rows[LANES];
+			for (size_t lane = 0; lane < LANES; ++lane) {
+				rows[lane] = _mm256_shuffle_epi8(_mm256_loadu_si256(
+					reinterpret_cast<const __m256i*>(block[lane] + 32 * half)), byteOrder);
+			}
+			transposeLanes(rows, w + 8 * half);
+		}
+
+		__m256i a = state[0];
+		__m256i b = state[1];
+		__m256i c = state[2];
+		__m256i d = state[3];
+		__m256i e = state[4];
+		roundGroupLanes<0>(w, a, b, c, d, e, 0x5a827999);
+		roundGroupLanes<1>(w, a, b, c, d, e, 0x6ed9eba1);
+		roundGroupLanes<2>(w, a, b, c, d, e, 0x8f1bbcdc);
+		roundGroupLanes<3>(w, a, b, c, d, e, 0xca62c1d6);
+
+		const __m256i mask = _mm256_load_si256(reinterpret_cast<const __m256i*>(active));
+		const __m256i result[5] = {a, b, c, d, e};
+		for (size_t i = 0; i < 5; ++i) {
+			state[i] = _mm256_blendv_epi8(state[i], _mm256_add_epi32(state[i], result[i]), mask);
+		}
+	}
+
+	//Хэш полосы - её слова состояния
+	alignas(32) uint32_t words[5][LANES];
+	for (size_t i = 0; i < 5; ++i) {
+		_mm256_store_si256(reinterpret_cast<__m256i*>(words[i]), state[i]);
+	}
+	for (size_t lane = 0; lane < count; ++lane) {
+		for (size_t i = 0; i < digests[lane].size(); ++i) {
+			digests[lane][i] = static_cast<uint8_t>(words[i / 4][lane] >> (24 - 8 * (i % 4)));
+		}
+	}
+}
+#endif
+
+
+
+void sha_1::test()
+{
+	//Все реализации, которые есть на этом процессоре, дают одинаковый результат
+	const Backend detected = getBackend();
+	for (Backend each : {Backend::PORTABLE, Backend::SHA_NI}) {
+		if (setBackend(each)) {
+			testBackend();
+		}
+	}
+
+	//Данные всех длин до нескольких блоков - побайтно одинаковые хэши
+	std::string value;
+	for (size_t length = 0; length < 300; ++length) {
+		setBackend(Backend::PORTABLE);
+		const Digest portable = digest(value);
+		if (setBackend(Backend::SHA_NI)) {
+			assert(digest(value) == portable);
+		}
+		value += static_cast<char>(length * 7 + 1);
+	}
+	assert(setBackend(detected) == true);
+
+	//Пакеты разного размера из строк разной длины - те же хэши, что и по одной
+	std::vector<std::string> values;
+	for (size_t length = 0; length < 150; length += 7) {
+		values.push_back(value.substr(0, length));
+	}
+	for (Backend each : {Backend::PORTABLE, Backend::SHA_NI}) {
+		if (!setBackend(each)) {
+			continue;
+		}
+		for (size_t count = 0; count <= values.size(); ++count) {
+			const std::vector<std::string_view> batch(values.begin(), values.begin() + count);
+			std::vector<Digest> digests;
+			digestBatch(batch, digests);
+			assert(digests.size() == count);
+			for (size_t i = 0; i < count; ++i) {
+				assert(digests[i] == digest(values[i]));
+			}
+		}
+	}
+	assert(setBackend(detected) == true);
+	std::vector<std::string> hashes;
+	hashBatch({"abc", "", "abc"}, hashes);
+	assert(hashes.size() == 3);
+	assert(hashes[0] == "a9993e364706816aba3e25717850c26c9cd0d89d");
+	assert(hashes[1] == "da39a3ee5e6b4b0d3255bfef95601890afd80709");
+	assert(hashes[2] == hashes[0]);
+
+	//Разбор шестнадцатеричной строки обратен toHex
+	Digest parsed;
+	assert(fromHex(hashes[0], parsed) == true);
+	assert(parsed == digest("abc"));
+	assert(fromHex("A9993E364706816ABA3E25717850C26C9CD0D89D", parsed) == true);
+	assert(parsed == digest("abc"));
+	assert(fromHex("a9993e", parsed) == false);
+	assert(fromHex("g9993e364706816aba3e25717850c26c9cd0d89d", parsed) == false);
+}
+
+
+
+static void testBackend()
+{
+	using namespace sha_1;
+
+	//Эталонные значения FIPS 180-2
+	assert(hash("") == "da39a3ee5e6b4b0d3255bfef95601890afd80709");
+	assert(hash("abc") == "a9993e364706816aba3e25717850c26c9cd0d89d");
+	//56 байт - длина данных не помещается в блок с дополнением
+	assert(hash("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq") ==
+		"84983e441c3bd26ebaae4aa1f95129e5e54670f1");
+	assert(hash(std::string(1000000, 'a')) == "34aa973cd4c4daa4f61eeb2bdbad27316534016f");
+
+	//Данные частями - тот же хэш, что и целиком
+	const std::string value(200, 'x');
+	Hasher hasher;
+	hasher.update(value.data(), 1);
+	hasher.update(value.data() + 1, 70);
+	hasher.update(value.data() + 71, value.size() - 71);
+	const Digest parts = hasher.finish();
+	assert(parts == digest(value));
+
+	//После finish расчёт начинается заново
+	hasher.update("abc", 3);
+	assert(toHex(hasher.finish()) == "a9993e364706816aba3e25717850c26c9cd0d89d");
 }
\ No newline at end of file
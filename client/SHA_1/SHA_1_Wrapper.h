@@ -1,12 +1,117 @@
-/**
-\file SHA_1_Wrapper.h
-\brief Обёртка над модулем расчёта хэша (sha-1) строки 
-*/
-
-#pragma once
-
-#include <string>
-
-namespace sha_1 {
-	std::string hash(const std::string& value);
+/**
+\file SHA_1_Wrapper.h
+\brief Расчёт хэша (sha-1) строки
+Хэш считается без выделения памяти: блоки по 64 байта сжимаются прямо из
+входных данных, результат - 20 байт. Шестнадцатеричная строка формируется
+только там, где хэш передаётся или показывается.
+*/
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace sha_1 {
+	//Хэш - 20 байт
+	using Digest = std::array<uint8_t, 20>;
+
+	/**
+	Расчёт хэша по частям: сколько угодно вызовов update, затем finish
+	*/
+	class Hasher {
+		public:
+			Hasher();
+
+			/**
+			Добавить данные
+			\param[in] data Данные
+			\param[in] size Размер данных в байтах
+			*/
+			void update(const void* data, size_t size);
+
+			/**
+			Завершить расчёт (после него расчёт начинается заново)
+			\return Хэш всех добавленных данных
+			*/
+			Digest finish();
+
+		private:
+			//Вернуть начальное состояние
+			void reset();
+
+			uint32_t state_[5];		///<Промежуточный хэш
+			uint8_t buffer_[64];	///<Неполный блок
+			size_t buffered_;		///<Байт в неполном блоке
+			uint64_t length_;		///<Всего добавлено байт
+	};
+
+	/**
+	\param[in] value Строка
+	\return Хэш строки
+	*/
+	Digest digest(const std::string& value);
+
+	/**
+	\param[in] digest Хэш
+	\return Хэш - 40 шестнадцатеричных цифр в нижнем регистре
+	*/
+	std::string toHex(const Digest& digest);
+
+	/**
+	Разобрать хэш из шестнадцатеричной строки прямо в массив
+	\param[in] hex 40 шестнадцатеричных цифр (любой регистр)
+	\param[out] digest Хэш
+	\return false - строка не является хэшем в шестнадцатеричном виде
+	*/
+	bool fromHex(std::string_view hex, Digest& digest);
+
+	/**
+	\param[in] value Строка
+	\return Хэш строки - 40 шестнадцатеричных цифр в нижнем регистре
+	*/
+	std::string hash(const std::string& value);
+
+	/**
+	Хэши многих строк: строки считаются группами по 8 одновременно, по строке
+	в каждой полосе векторных регистров (если процессор поддерживает AVX2)
+	\param[in] values Строки
+	\param[in] digests Результат - хэши строк в том же порядке
+	*/
+	void digestBatch(const std::vector<std::string_view>& values, std::vector<Digest>& digests);
+
+	/**
+	Хэши многих строк (см. digestBatch)
+	\param[in] values Строки
+	\param[in] hashes Результат - хэши строк (40 шестнадцатеричных цифр) в том же порядке
+	*/
+	void hashBatch(const std::vector<std::string_view>& values, std::vector<std::string>& hashes);
+
+	/**
+	Реализации сжатия блока
+	*/
+	enum class Backend {
+		PORTABLE,	///<Переносимый код
+		SHA_NI		///<Инструкции SHA процессоров x86
+	};
+
+	/**
+	\return Реализация, выбранная при запуске по возможностям процессора
+	*/
+	Backend getBackend();
+
+	/**
+	Выбрать реализацию (для тестов и замеров)
+	\param[in] backend Реализация
+	\return false - процессор не поддерживает реализацию
+	*/
+	bool setBackend(Backend backend);
+
+	/**
+	Запустить тестирование функций модуля
+	*/
+	void test();
 }
\ No newline at end of file
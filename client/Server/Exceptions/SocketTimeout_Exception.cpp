@@ -0,0 +1,14 @@
+#include "SocketTimeout_Exception.h"
+
+
+
+SocketTimeout_Exception::SocketTimeout_Exception() : std::exception()
+{
+}
+
+
+
+const char* SocketTimeout_Exception::what() const noexcept
+{
+	return "Error: Server response timeout";
+}
\ No newline at end of file
@@ -0,0 +1,16 @@
+/**
+\file SocketTimeout_Exception.h
+\brief Класс SocketTimeout_Exception - класс-обработчик исключения "Сервер не ответил вовремя"
+*/
+
+#pragma once
+
+#include <string>
+#include <exception>
+
+class SocketTimeout_Exception : public std::exception {
+  public:
+    SocketTimeout_Exception();
+
+    virtual const char* what() const noexcept override;
+};
\ No newline at end of file
@@ -1,12 +1,20 @@
 #include "Server.h"
 
 #include <iostream>
+#include <random>
+#include <thread>
+#include <chrono>
 #include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <algorithm>
+#include <atomic>
 #include <sys/socket.h>
 #include <arpa/inet.h>
 
 #include "Exceptions/SocketCreation_Exception.h"
 #include "Exceptions/SocketConnection_Exception.h"
+#include "Exceptions/SocketTimeout_Exception.h"
 
 
 
@@ -15,9 +23,7 @@ namespace{
   const int PORT = 7777;
 
   const int MAX_LENGTH_MESSAGE = 1024;  //MAX размер пересылаемых сообщений
-  int socketDescriptor;
-  struct sockaddr_in serverAddress;
-  char inputBuffer[MAX_LENGTH_MESSAGE];
+  const int REQUEST_TIMEOUT = 5;        //Время ожидания ответа сервера, секунд
 
   //Коды запросов серверу
   enum Command{
@@ -31,44 +37,77 @@ namespace{
     REQUEST_MESSAGES,
     ADD_USER,
     ADD_MESSAGE,
-    REMOVE_USER
+    REMOVE_USER,
+    REQUEST_MESSAGES_RANGE,
+    REQUEST_NICKNAMES_SINCE,
+    REQUEST_NICKNAMES_PREFIX,
+    CREATE_ROOM,
+    JOIN_ROOM,
+    LEAVE_ROOM,
+    POST_TO_ROOM,
+    REQUEST_ROOM_MESSAGES,
+    REQUEST_ROOMS,
+    ADD_MESSAGE_MULTI,
+    REQUEST_CONVERSATION,
+    REQUEST_MESSAGES_TIME,
+    ACK_READ,
+    REQUEST_UNREAD_SUMMARY,
+    REQUEST_UPDATES
   };
-}
-
 
+  //Названия команд для отчётов - в порядке кодов
+  const char* const COMMAND_NAMES[] = {
+    "NOTHING", "IS_LOGIN_REGISTERED", "IS_PASSWORD_RIGHT", "IS_NICKNAME_REGISTERED",
+    "REQUEST_NICKNAME", "REQUEST_ALL_NICKNAMES", "REQUEST_NUMBER_USERS", "REQUEST_MESSAGES",
+    "ADD_USER", "ADD_MESSAGE", "REMOVE_USER", "REQUEST_MESSAGES_RANGE",
+    "REQUEST_NICKNAMES_SINCE", "REQUEST_NICKNAMES_PREFIX", "CREATE_ROOM", "JOIN_ROOM",
+    "LEAVE_ROOM", "POST_TO_ROOM", "REQUEST_ROOM_MESSAGES", "REQUEST_ROOMS",
+    "ADD_MESSAGE_MULTI", "REQUEST_CONVERSATION", "REQUEST_MESSAGES_TIME", "ACK_READ",
+    "REQUEST_UNREAD_SUMMARY", "REQUEST_UPDATES"
+  };
+  static_assert(sizeof(COMMAND_NAMES) / sizeof(COMMAND_NAMES[0]) == REQUEST_UPDATES + 1,
+                "Название нужно каждой команде");
 
-void server::connect()
-{
-  //Создать сокет
-  socketDescriptor = socket(AF_INET, SOCK_STREAM, 0);
-  if(socketDescriptor == -1){
-    throw SocketCreation_Exception();
-  }
+  std::atomic<server::Observer> observer(nullptr);  //Получатель времени ответа на запросы
 
-  //Задать параметры сервера
-  serverAddress.sin_addr.s_addr = inet_addr(ADDRESS.c_str());
-  serverAddress.sin_port = htons(PORT);
-  serverAddress.sin_family = AF_INET;
-
-  //Установить соединение с сервером
-  int connection = connect(socketDescriptor, (struct sockaddr*)&serverAddress, sizeof(serverAddress));
-  if(connection == -1){
-    throw SocketConnection_Exception();
-  }
+  const int MAX_SEND_ATTEMPTS = 3;  //MAX количество попыток отправить сообщение
+  const std::chrono::milliseconds RETRY_DELAY(200); //Пауза перед повтором (растёт с попыткой)
 }
 
 
+
 /**
-Отправить серверу сообщение
-\param[in] message Сообщение
+Отправить серверу запрос и получить ответ.
+У каждого запроса своё соединение и свой буфер - запросы можно делать из
+разных потоков. Соединение закрывается всегда, ожидание ответа ограничено
+\param[in] message Запрос
+\return Ответ сервера
 */
-static void send(const std::string& message);
+static std::string exchange(const std::string& message);
+
+//Обмен с сервером без замера времени (см. exchange)
+static std::string transfer(const std::string& message);
+
+//Новый идентификатор сообщения - случайный, чтобы не совпасть с идентификаторами
+//того же отправителя из других запусков клиента
+static std::string makeMessageId();
+
+//Отправить запрос проверки учётных данных и вернуть результат. Пока у сервера
+//заполнена очередь проверки паролей (ответ "busy"), запрос повторяется
+static server::AuthResult requestCredentials(const std::string& message);
 
 //Распарсить строку на слова по разделителю и поместить в result
 static void parse (std::shared_ptr<std::vector<std::string> > result,
                   const std::string& input,
                   const std::string& delimiter);
 
+//Распарсить запись ПОЛЕ:...:ПОЛЕ:MESSAGE: - по ':' делятся только leading первых полей,
+//текст - всё между ними и завершающим ':' (в тексте может быть ':').
+//Результат - поля и последним текст. Возвращает false, если запись неполная
+static bool parseEntry(std::shared_ptr<std::vector<std::string> > result,
+                       const std::string& entry,
+                       size_t leading);
+
 
 
 bool server::isLoginRegistered(const std::string& login)
@@ -77,12 +116,9 @@ bool server::isLoginRegistered(const std::string& login)
   //Сформировать и отправить запрос
   Command command = IS_LOGIN_REGISTERED;
   std::string message = std::to_string(command) + "|" + login + "|";
-  connect();
-  send(message);
 
   //Ждать ответ от сервера
-  read(socketDescriptor, inputBuffer, MAX_LENGTH_MESSAGE);
-  message = inputBuffer;
+  message = exchange(message);
   if (message == "true"){
     return true;
   }
@@ -97,12 +133,9 @@ bool server::isNicknameRegistered(const std::string& nickname)
   //Сформировать и отправить запрос
   Command command = IS_NICKNAME_REGISTERED;
   std::string message = std::to_string(command) + "|" + nickname + "|";
-  connect();
-  send(message);
 
   //Ждать ответ от сервера
-  read(socketDescriptor, inputBuffer, MAX_LENGTH_MESSAGE);
-  message = inputBuffer;
+  message = exchange(message);
   if (message == "true"){
     return true;
   }
@@ -111,24 +144,14 @@ bool server::isNicknameRegistered(const std::string& nickname)
 
 
 
-bool server::isPasswordRight(const std::string& login,
-                            const std::string& passwordHash)
+server::AuthResult server::isPasswordRight(const std::string& login,
+                                          const std::string& passwordHash)
 {
   //request - Код_Команды|LOGIN|HASHPASSWORD|
   //Сформировать и отправить запрос
   Command command = IS_PASSWORD_RIGHT;
   std::string message = std::to_string(command) + "|" + login + "|" + passwordHash + "|";
-  connect();
-  send(message);
-
-  //Ждать ответ от сервера
-  read(socketDescriptor, inputBuffer, MAX_LENGTH_MESSAGE);
-  message = inputBuffer;
-  if (message == "true"){
-    return true;
-  }
-
-  return false;
+  return requestCredentials(message);
 }
 
 
@@ -139,12 +162,9 @@ std::string server::getNickname(const std::string& login)
   //Сформировать и отправить запрос
   Command command = REQUEST_NICKNAME;
   std::string message = std::to_string(command) + "|" + login + "|";
-  connect();
-  send(message);
 
   //Ждать ответ от сервера
-  read(socketDescriptor, inputBuffer, MAX_LENGTH_MESSAGE);
-  message = inputBuffer;
+  message = exchange(message);
   if (message == "false"){
     return "";
   }
@@ -156,17 +176,67 @@ std::string server::getNickname(const std::string& login)
 
 void server::getAllNicknames(std::shared_ptr<std::vector<std::string> > nicknames)
 {
-  //request - Код_Команды
+  //request - Код_Команды|[AFTER_NICK|]
+  //Список приходит страницами: END|NICK|NICK|..., END - "more", если за последним
+  //Ником страницы есть ещё Ники, иначе "end"
+  nicknames->clear();
+  std::string after = "";
+  while (true) {
+    Command command = REQUEST_ALL_NICKNAMES;
+    std::string message = std::to_string(command) + "|";
+    if (!after.empty()) {
+      message += after + "|";
+    }
+
+    //Ждать ответ от сервера
+    message = exchange(message);
+
+    //Распарсить входную строку и поместить ники в вектор
+    auto page = std::make_shared<std::vector<std::string> >();
+    parse(page, message, "|");
+    if (page->empty()) {
+      return;
+    }
+    nicknames->insert(nicknames->end(), page->begin() + 1, page->end());
+    if (page->front() != "more" || page->size() == 1) {
+      return;
+    }
+    after = page->back();
+  }
+}
+
+
+
+std::string server::getNicknamesSince(uint64_t version, const std::string& after)
+{
+  //request - Код_Команды|VERSION|[AFTER_NICK|]
   //Сформировать и отправить запрос
-  Command command = REQUEST_ALL_NICKNAMES;
-  std::string message = std::to_string(command);
-  connect();
-  send(message);
+  Command command = REQUEST_NICKNAMES_SINCE;
+  std::string message = std::to_string(command) + "|" + std::to_string(version) + "|";
+  if (!after.empty()) {
+    message += after + "|";
+  }
 
   //Ждать ответ от сервера
-  read(socketDescriptor, inputBuffer, MAX_LENGTH_MESSAGE);
-  message = inputBuffer;
-  nicknames->clear();
+  message = exchange(message);
+  return message;
+}
+
+
+
+void server::findNicknames(const std::string& prefix,
+                           const std::string& after,
+                           size_t limit,
+                           std::shared_ptr<std::vector<std::string> > nicknames)
+{
+  //request - Код_Команды|PREFIX|AFTER_NICK|LIMIT|
+  //Сформировать и отправить запрос
+  Command command = REQUEST_NICKNAMES_PREFIX;
+  std::string message = std::to_string(command) + "|" + prefix + "|" +
+                        after + "|" + std::to_string(limit) + "|";
+
+  //Ждать ответ от сервера
+  message = exchange(message);
 
   //Распарсить входную строку и поместить ники в вектор
   parse(nicknames, message, "|");
@@ -180,12 +250,9 @@ int server::getNumberUsers()
   //Сформировать и отправить запрос
   Command command = REQUEST_NUMBER_USERS;
   std::string message = std::to_string(command);
-  connect();
-  send(message);
 
   //Ждать ответ от сервера
-  read(socketDescriptor, inputBuffer, MAX_LENGTH_MESSAGE);
-  message = inputBuffer;
+  message = exchange(message);
   int result = std::stoi(message);
 
   return result;
@@ -200,11 +267,9 @@ void server::getMessages(const std::string& login,
   //Сформировать и отправить запрос
   Command command = REQUEST_MESSAGES;
   std::string message = std::to_string(command) + "|" + login + "|";
-  connect();
-  send(message);
+
   //Ждать ответ от сервера
-  read(socketDescriptor, inputBuffer, MAX_LENGTH_MESSAGE);
-  const std::string answer = inputBuffer;
+  const std::string answer = exchange(message);
 
   auto _messages = std::make_shared<std::vector<std::string> >();
   parse(_messages, answer, "|");
@@ -222,18 +287,205 @@ void server::getMessages(const std::string& login,
 
 
 
-void server::addUser(const std::string& name,
-                    const std::string& login,
-                    const std::string& passwordHash)
+void server::getMessagesRange(const std::string& login,
+                              uint64_t first,
+                              uint64_t last,
+                              std::list<Message>& messages,
+                              uint64_t& lastSequence)
+{
+  //request - Код_Команды|LOGIN|FIRST_SEQUENCE|LAST_SEQUENCE|
+  //Сформировать и отправить запрос
+  Command command = REQUEST_MESSAGES_RANGE;
+  std::string message = std::to_string(command) + "|" + login + "|" +
+                        std::to_string(first) + "|" + std::to_string(last) + "|";
+
+  //Ждать ответ от сервера
+  const std::string answer = exchange(message);
+
+  //Ответ - SEQUENCE:NICK_FROM:MESSAGE:|... от старых к новым.
+  //Текст - всё между Ником и завершающим ':' (в тексте может быть ':')
+  auto _messages = std::make_shared<std::vector<std::string> >();
+  parse(_messages, answer, "|");
+  messages.clear();
+  lastSequence = 0;
+  for (const auto& rangeMessage : *_messages) {
+    const size_t nameBegin = rangeMessage.find(':') + 1;
+    const size_t textBegin = rangeMessage.find(':', nameBegin) + 1;
+    if (nameBegin == 0 || textBegin == 0 || rangeMessage.back() != ':') {
+      continue;
+    }
+    lastSequence = std::stoull(rangeMessage.substr(0, nameBegin - 1));
+    messages.push_back(Message(rangeMessage.substr(nameBegin, textBegin - 1 - nameBegin),
+                               rangeMessage.substr(textBegin, rangeMessage.size() - 1 - textBegin)));
+  }
+}
+
+
+
+bool server::getConversation(const std::string& login,
+                             const std::string& peer,
+                             uint64_t before,
+                             size_t limit,
+                             std::shared_ptr<std::list<Message> >& messages,
+                             uint64_t& firstSequence)
+{
+  //request - Код_Команды|LOGIN|PEER_NICKNAME|BEFORE_SEQUENCE|LIMIT|
+  //Сформировать и отправить запрос
+  Command command = REQUEST_CONVERSATION;
+  std::string message = std::to_string(command) + "|" + login + "|" + peer + "|" +
+                        std::to_string(before) + "|" + std::to_string(limit) + "|";
+
+  //Ждать ответ от сервера
+  const std::string answer = exchange(message);
+  if (answer == "false"){
+    return false;
+  }
+
+  //Ответ - SEQUENCE:NICK_FROM:MESSAGE:|... от новых к старым. Длина ответа
+  //ограничена - сообщений может быть меньше limit
+  auto _messages = std::make_shared<std::vector<std::string> >();
+  parse(_messages, answer, "|");
+  auto fields = std::make_shared<std::vector<std::string> >();
+  firstSequence = 0;
+  for (const auto& conversationMessage : *_messages) {
+    if (!parseEntry(fields, conversationMessage, 2)) {
+      continue;
+    }
+    firstSequence = std::stoull(fields->at(0));
+    messages->push_front(Message(fields->at(1), fields->at(2)));
+  }
+  return true;
+}
+
+
+
+size_t server::getUnreadSummary(const std::string& login, std::vector<UnreadCount>& counts)
+{
+  //request - Код_Команды|LOGIN|
+  //Сформировать и отправить запрос
+  Command command = REQUEST_UNREAD_SUMMARY;
+  std::string message = std::to_string(command) + "|" + login + "|";
+
+  //Ждать ответ от сервера
+  const std::string answer = exchange(message);
+
+  //Ответ - TOTAL|NICK_PEER:COUNT:LAST_SEQUENCE:|...
+  auto _counts = std::make_shared<std::vector<std::string> >();
+  parse(_counts, answer, "|");
+  counts.clear();
+  if (_counts->empty()) {
+    return 0;
+  }
+  auto fields = std::make_shared<std::vector<std::string> >();
+  for (size_t i = 1; i < _counts->size(); ++i) {
+    parse(fields, _counts->at(i), ":");
+    counts.push_back(UnreadCount{fields->at(0), std::stoull(fields->at(1)),
+                                 std::stoull(fields->at(2))});
+  }
+  return std::stoull(_counts->front());
+}
+
+
+
+bool server::getUpdates(const std::string& login, Updates& updates)
+{
+  //request - Код_Команды|LOGIN|
+  //Сформировать и отправить запрос
+  Command command = REQUEST_UPDATES;
+  std::string message = std::to_string(command) + "|" + login + "|";
+
+  //Ждать ответ от сервера
+  const std::string answer = exchange(message);
+
+  //Ответ - DIRECTORY_VERSION|LAST_SEQUENCE|TOTAL|NICK_PEER:COUNT:LAST_SEQUENCE:|...
+  auto fields = std::make_shared<std::vector<std::string> >();
+  parse(fields, answer, "|");
+  updates = Updates();
+  if (fields->size() < 3) {
+    return false;
+  }
+  updates.directoryVersion = std::stoull(fields->at(0));
+  updates.lastSequence = std::stoull(fields->at(1));
+  updates.total = std::stoull(fields->at(2));
+  auto count = std::make_shared<std::vector<std::string> >();
+  for (size_t i = 3; i < fields->size(); ++i) {
+    parse(count, fields->at(i), ":");
+    updates.counts.push_back(UnreadCount{count->at(0), std::stoull(count->at(1)),
+                                         std::stoull(count->at(2))});
+  }
+  return true;
+}
+
+
+
+void server::acknowledgeRead(const std::string& login,
+                             const std::vector<std::pair<std::string, uint64_t> >& acknowledgements)
+{
+  if (acknowledgements.empty()) {
+    return;
+  }
+  //request - Код_Команды|LOGIN|NICK_PEER:SEQUENCE,NICK_PEER:SEQUENCE,...|
+  //Сформировать и отправить запрос - все собеседники одним запросом
+  Command command = ACK_READ;
+  std::string message = std::to_string(command) + "|" + login + "|";
+  for (size_t i = 0; i < acknowledgements.size(); ++i) {
+    message += (i == 0 ? "" : ",") + acknowledgements[i].first + ":" +
+               std::to_string(acknowledgements[i].second);
+  }
+  message += "|";
+
+  //Ждать ответ от сервера
+  exchange(message);
+}
+
+
+
+void server::getMessagesByTime(const std::string& login,
+                               std::time_t from,
+                               std::time_t to,
+                               std::shared_ptr<std::list<Message> >& messages)
+{
+  //request - Код_Команды|LOGIN|FROM_TIME|TO_TIME|BEFORE_SEQUENCE|
+  Command command = REQUEST_MESSAGES_TIME;
+  const std::string request = std::to_string(command) + "|" + login + "|" +
+                              std::to_string(from) + "|" + std::to_string(to) + "|";
+
+  //Ответ - SEQUENCE:TIME:NICK_FROM:MESSAGE:|... от новых к старым. В ответ помещаются
+  //только целые сообщения - более ранние запрашиваются до номера последнего полученного
+  auto _messages = std::make_shared<std::vector<std::string> >();
+  auto fields = std::make_shared<std::vector<std::string> >();
+  uint64_t before = 0;
+  while (true) {
+    //Ждать ответ от сервера
+    const std::string answer = exchange(request + std::to_string(before) + "|");
+    parse(_messages, answer, "|");
+    uint64_t oldest = before;
+    for (const auto& timeMessage : *_messages) {
+      if (!parseEntry(fields, timeMessage, 3)) {
+        continue;
+      }
+      oldest = std::stoull(fields->at(0));
+      messages->push_front(Message(fields->at(2), fields->at(3)));
+    }
+    //Страница пуста или не сдвинула запрос к более ранним сообщениям
+    if (oldest == before || (before != 0 && oldest > before)) {
+      return;
+    }
+    before = oldest;
+  }
+}
+
+
+
+server::AuthResult server::addUser(const std::string& name,
+                                  const std::string& login,
+                                  const std::string& passwordHash)
 {
   //request - Код_Команды|NICKNAME|LOGIN|HASHPASSWORD|
   Command command = ADD_USER;
   std::string message = std::to_string(command) + "|" +
                         name + "|" + login + "|" + passwordHash + "|";
-  connect();
-  send(message);
-  //Ждать ответ от сервера
-  read(socketDescriptor, inputBuffer, MAX_LENGTH_MESSAGE);
+  return requestCredentials(message);
 }
 
 
@@ -242,14 +494,51 @@ void server::addMessage(const std::string& nameTo,
                         const std::string& nameFrom,
                         const std::string& message)
 {
-  //request - Код_Команды|NICKNAME_TO|NICKNAME_FROM|MESSAGE|
+  //request - Код_Команды|NICKNAME_TO|NICKNAME_FROM|MESSAGE|MESSAGE_ID|
+  //Идентификатор один на все попытки - сервер не добавит сообщение дважды
   Command command = ADD_MESSAGE;
   std::string messageToServer = std::to_string(command) + "|" +
-                                nameTo + "|" + nameFrom + "|" + message + "|";
-  connect();
-  send(messageToServer);
-  //Ждать ответ от сервера
-  read(socketDescriptor, inputBuffer, MAX_LENGTH_MESSAGE);
+                                nameTo + "|" + nameFrom + "|" + message + "|" +
+                                makeMessageId() + "|";
+  for (int attempt = 1; attempt <= MAX_SEND_ATTEMPTS; ++attempt) {
+    //Ждать ответ от сервера - если соединение оборвалось, ответа нет
+    try {
+      exchange(messageToServer);
+      return;
+    }
+    catch (const SocketConnection_Exception&) {
+    }
+    catch (const SocketTimeout_Exception&) {
+    }
+    std::this_thread::sleep_for(RETRY_DELAY * attempt);
+  }
+  throw SocketConnection_Exception();
+}
+
+
+
+void server::addMessage(const std::vector<std::string>& namesTo,
+                        const std::string& nameFrom,
+                        const std::string& message,
+                        std::vector<bool>& delivered)
+{
+  //request - Код_Команды|NICKNAME_TO,NICKNAME_TO,...|NICKNAME_FROM|MESSAGE|
+  Command command = ADD_MESSAGE_MULTI;
+  std::string names = "";
+  for (const auto& name : namesTo) {
+    names += (names.empty() ? "" : ",") + name;
+  }
+  std::string messageToServer = std::to_string(command) + "|" +
+                                names + "|" + nameFrom + "|" + message + "|";
+
+  //Ждать ответ от сервера - true|false|... по каждому адресату
+  const std::string answer = exchange(messageToServer);
+  auto statuses = std::make_shared<std::vector<std::string> >();
+  parse(statuses, answer, "|");
+  delivered.clear();
+  for (const auto& status : *statuses) {
+    delivered.push_back(status == "true");
+  }
 }
 
 
@@ -260,11 +549,155 @@ void server::removeUser(const std::string& login)
   //Сформировать и отправить запрос
   Command command = REMOVE_USER;
   std::string message = std::to_string(command) + "|" + login + "|";
-  connect();
-  send(message);
 
   //Ждать ответ от сервера
-  read(socketDescriptor, inputBuffer, MAX_LENGTH_MESSAGE);
+  exchange(message);
+}
+
+
+
+//Отправить запрос об участии в комнате и получить признак успеха
+static bool changeRoom(Command command,
+                       const std::string& login,
+                       const std::string& room);
+
+
+bool server::createRoom(const std::string& login, const std::string& room)
+{
+  return changeRoom(CREATE_ROOM, login, room);
+}
+
+
+
+bool server::joinRoom(const std::string& login, const std::string& room)
+{
+  return changeRoom(JOIN_ROOM, login, room);
+}
+
+
+
+bool server::leaveRoom(const std::string& login, const std::string& room)
+{
+  return changeRoom(LEAVE_ROOM, login, room);
+}
+
+
+
+bool server::postToRoom(const std::string& login,
+                        const std::string& room,
+                        const std::string& message)
+{
+  //request - Код_Команды|LOGIN|ROOM|MESSAGE|
+  Command command = POST_TO_ROOM;
+  std::string messageToServer = std::to_string(command) + "|" +
+                                login + "|" + room + "|" + message + "|";
+
+  //Ждать ответ от сервера
+  messageToServer = exchange(messageToServer);
+  return messageToServer == "true";
+}
+
+
+
+bool server::getRoomMessages(const std::string& login,
+                             const std::string& room,
+                             std::shared_ptr<std::list<Message> >& messages)
+{
+  //request - Код_Команды|LOGIN|ROOM|
+  //Сформировать и отправить запрос
+  Command command = REQUEST_ROOM_MESSAGES;
+  std::string message = std::to_string(command) + "|" + login + "|" + room + "|";
+
+  //Ответ - SEQUENCE:NICK_FROM:MESSAGE:|... от старых к новым. В ответ помещаются
+  //только целые сообщения - остальные сервер пришлёт на следующий запрос
+  auto _messages = std::make_shared<std::vector<std::string> >();
+  auto fields = std::make_shared<std::vector<std::string> >();
+  while (true) {
+    //Ждать ответ от сервера
+    const std::string answer = exchange(message);
+    if (answer == "false"){
+      return false;
+    }
+    parse(_messages, answer, "|");
+    if (_messages->empty()) {
+      return true;
+    }
+    for (const auto& roomMessage : *_messages) {
+      if (parseEntry(fields, roomMessage, 2)) {
+        messages->push_back(Message(fields->at(1), fields->at(2)));
+      }
+    }
+  }
+}
+
+
+
+void server::getRooms(const std::string& login,
+                      std::shared_ptr<std::vector<std::string> > rooms)
+{
+  //request - Код_Команды|LOGIN|
+  //Сформировать и отправить запрос
+  Command command = REQUEST_ROOMS;
+  std::string message = std::to_string(command) + "|" + login + "|";
+
+  //Ждать ответ от сервера
+  message = exchange(message);
+
+  //Распарсить входную строку и поместить названия в вектор
+  parse(rooms, message, "|");
+}
+
+
+
+static bool changeRoom(Command command,
+                       const std::string& login,
+                       const std::string& room)
+{
+  //request - Код_Команды|LOGIN|ROOM|
+  //Сформировать и отправить запрос
+  std::string message = std::to_string(command) + "|" + login + "|" + room + "|";
+
+  //Ждать ответ от сервера
+  message = exchange(message);
+  return message == "true";
+}
+
+
+
+static server::AuthResult requestCredentials(const std::string& message)
+{
+  for (int attempt = 1; attempt <= MAX_SEND_ATTEMPTS; ++attempt) {
+    //Ждать ответ от сервера
+    const std::string answer = exchange(message);
+    if (answer != "busy") {
+      return (answer == "true") ? server::ACCEPTED : server::REJECTED;
+    }
+    std::this_thread::sleep_for(RETRY_DELAY * attempt);
+  }
+  return server::BUSY;
+}
+
+
+
+static bool parseEntry(std::shared_ptr<std::vector<std::string> > result,
+                       const std::string& entry,
+                       size_t leading)
+{
+  result->clear();
+  size_t begin = 0;
+  for (size_t i = 0; i < leading; ++i) {
+    const size_t end = entry.find(':', begin);
+    if (end == std::string::npos) {
+      return false;
+    }
+    result->push_back(entry.substr(begin, end - begin));
+    begin = end + 1;
+  }
+  if (begin > entry.size() - 1 || entry.back() != ':') {
+    return false;
+  }
+  result->push_back(entry.substr(begin, entry.size() - 1 - begin));
+  return true;
 }
 
 
@@ -284,11 +717,116 @@ static void parse (std::shared_ptr<std::vector<std::string> > result,
 
 
 
-static void send(const std::string& message)
+void server::setObserver(Observer newObserver)
 {
-  ssize_t bytes = write(socketDescriptor, message.c_str(), MAX_LENGTH_MESSAGE);
-  //Если передали >= 0 байт, значит пересылка прошла успешно
-  if(bytes >= 0){
-    // std::cout << "Data send to the server successfully!\n";
+  observer = newObserver;
+}
+
+
+
+std::string server::getCommandName(int command)
+{
+  if (command < 0 || command > REQUEST_UNREAD_SUMMARY) {
+    return std::to_string(command);
+  }
+  return COMMAND_NAMES[command];
+}
+
+
+
+static std::string exchange(const std::string& message)
+{
+  const server::Observer current = observer;
+  if (current == nullptr) {
+    return transfer(message);
+  }
+
+  //Запрос начинается с кода команды
+  const int command = std::atoi(message.c_str());
+  const auto start = std::chrono::steady_clock::now();
+  const auto elapsed = [&start]() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+           std::chrono::steady_clock::now() - start);
+  };
+  try {
+    std::string answer = transfer(message);
+    current(command, elapsed(), true);
+    return answer;
+  }
+  catch (...) {
+    current(command, elapsed(), false);
+    throw;
   }
+}
+
+
+
+static std::string transfer(const std::string& message)
+{
+  //Создать сокет
+  const int socketDescriptor = socket(AF_INET, SOCK_STREAM, 0);
+  if (socketDescriptor == -1) {
+    throw SocketCreation_Exception();
+  }
+  //Медленный сервер не должен останавливать клиент навсегда
+  const timeval timeout{REQUEST_TIMEOUT, 0};
+  setsockopt(socketDescriptor, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  setsockopt(socketDescriptor, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+  //Задать параметры сервера и установить соединение
+  sockaddr_in serverAddress{};
+  serverAddress.sin_addr.s_addr = inet_addr(ADDRESS.c_str());
+  serverAddress.sin_port = htons(PORT);
+  serverAddress.sin_family = AF_INET;
+  if (connect(socketDescriptor, (struct sockaddr*)&serverAddress, sizeof(serverAddress)) == -1) {
+    close(socketDescriptor);
+    throw SocketConnection_Exception();
+  }
+
+  //Запрос - всегда MAX_LENGTH_MESSAGE байт, дополненные нулями
+  char buffer[MAX_LENGTH_MESSAGE] = {};
+  message.copy(buffer, MAX_LENGTH_MESSAGE - 1);
+  ssize_t bytes = send(socketDescriptor, buffer, MAX_LENGTH_MESSAGE, MSG_NOSIGNAL);
+  if (bytes != MAX_LENGTH_MESSAGE) {
+    close(socketDescriptor);
+    throw SocketConnection_Exception();
+  }
+
+  //Ответ - тоже MAX_LENGTH_MESSAGE байт, может прийти частями
+  std::fill(buffer, buffer + MAX_LENGTH_MESSAGE, 0);
+  size_t received = 0;
+  while (received < MAX_LENGTH_MESSAGE) {
+    bytes = recv(socketDescriptor, buffer + received, MAX_LENGTH_MESSAGE - received, 0);
+    if (bytes <= 0) {
+      break;
+    }
+    received += bytes;
+  }
+  const bool isTimeout = (bytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK));
+  close(socketDescriptor);
+  if (isTimeout) {
+    throw SocketTimeout_Exception();
+  }
+  if (received == 0) {
+    throw SocketConnection_Exception();
+  }
+  return std::string(buffer, strnlen(buffer, received));
+}
+
+
+
+static std::string makeMessageId()
+{
+  //У каждого потока свой генератор - идентификаторы создаются без блокировки
+  thread_local std::mt19937_64 generator(std::random_device{}());
+  thread_local uint64_t counter = 0;
+  const uint64_t id = generator() ^ ++counter;
+
+  //16 шестнадцатеричных цифр
+  const char digits[] = "0123456789abcdef";
+  std::string result(16, '0');
+  for (size_t i = 0; i < result.size(); ++i) {
+    result[i] = digits[(id >> (60 - 4 * i)) & 0xF];
+  }
+  return result;
 }
\ No newline at end of file
@@ -4,15 +4,22 @@
 #include <vector>
 #include <list>
 #include <memory>
+#include <cstdint>
+#include <ctime>
+#include <chrono>
 
 #include "../Message/Message.h"
 
 
 namespace server{
   /**
-  Подключиться к серверу
+  Результат запроса, который сервер выполняет в пуле проверки паролей
   */
-  void connect();
+  enum AuthResult {
+    ACCEPTED,   ///<Пароль правильный / пользователь добавлен
+    REJECTED,   ///<Пароль неверный / Логин или Ник уже заняты
+    BUSY        ///<Очередь проверки паролей заполнена и после повторов - запрос не выполнен
+  };
 
   /**
   Запросить у сервера зарегистрирован ли Логин
@@ -32,10 +39,10 @@ namespace server{
   Запросить у сервера правильный ли пароль
   \param[in] login Логин
   \param[in] passwordHash Хэш Пароля
-  \return Признак правильный ли пароль
+  \return ACCEPTED - пароль правильный, REJECTED - неверный, BUSY - сервер занят
   */  
-  bool isPasswordRight(const std::string& login,
-                      const std::string& passwordHash);
+  AuthResult isPasswordRight(const std::string& login,
+                             const std::string& passwordHash);
   
   /**
   Запросить у сервера Ник по Логину
@@ -45,11 +52,34 @@ namespace server{
   std::string getNickname(const std::string& login);
 
   /**
-  Запросить у сервера Ники всех пользователей
+  Запросить у сервера Ники всех пользователей (по алфавиту, страницами)
   \param[in] nicknames Результат - указатель на вектор Ников
   */
   void getAllNicknames(std::shared_ptr<std::vector<std::string> > nicknames);
 
+  /**
+  Запросить у сервера страницу изменений списка Ников после заданной версии
+  \param[in] version Версия списка, известная клиенту (0 - нет списка)
+  \param[in] after Последний Ник полученной страницы полного списка (пустая строка -
+  запрос изменений)
+  \return Ответ сервера: изменения "D|VERSION|END|+NICK|-NICK|~OLD:NEW|..."
+  или страница полного списка "R|VERSION|END|NICK|NICK|...", END - "more", если
+  нужно запросить следующую страницу, иначе "end"
+  */
+  std::string getNicknamesSince(uint64_t version, const std::string& after);
+
+  /**
+  Запросить у сервера страницу Ников с заданным началом (по алфавиту)
+  \param[in] prefix Начало Ника
+  \param[in] after Ник, после которого начать страницу (пустая строка - с начала)
+  \param[in] limit Максимальное количество Ников на странице
+  \param[in] nicknames Результат - указатель на вектор Ников
+  */
+  void findNicknames(const std::string& prefix,
+                     const std::string& after,
+                     size_t limit,
+                     std::shared_ptr<std::vector<std::string> > nicknames);
+
   /**
   Запросить у сервера количество зарегистрированных пользователей
   \return Количество зарегистрированных пользователей
@@ -63,18 +93,112 @@ namespace server{
   void getMessages(const std::string& login,
                   std::shared_ptr<std::list<Message> >& messages);
 
+  /**
+  Запросить у сервера сообщения пользователю с номерами из диапазона [first, last].
+  Ответ ограничен размером: сервер присылает самые старые сообщения диапазона,
+  которые поместились, - остальные запрашиваются с номера после lastSequence
+  \param[in] login Логин пользователя
+  \param[in] first Номер первого сообщения диапазона
+  \param[in] last Номер последнего сообщения диапазона
+  \param[in] messages Результат - список сообщений (от старых к новым)
+  \param[in] lastSequence Результат - номер самого нового полученного сообщения (0 - пусто)
+  */
+  void getMessagesRange(const std::string& login,
+                        uint64_t first,
+                        uint64_t last,
+                        std::list<Message>& messages,
+                        uint64_t& lastSequence);
+
+  /**
+  Запросить у сервера сообщения пользователю, полученные в интервале времени
+  \param[in] login Логин пользователя
+  \param[in] from Начало интервала времени
+  \param[in] to Конец интервала времени
+  \param[in] messages Результат - список сообщений (от старых к новым)
+  */
+  void getMessagesByTime(const std::string& login,
+                         std::time_t from,
+                         std::time_t to,
+                         std::shared_ptr<std::list<Message> >& messages);
+
+  /**
+  Непрочитанные сообщения от одного собеседника
+  */
+  struct UnreadCount {
+    std::string name;       ///<Ник собеседника
+    size_t count;           ///<Количество непрочитанных сообщений
+    uint64_t lastSequence;  ///<Номер последнего из них в переписке
+  };
+
+  /**
+  Запросить у сервера количество непрочитанных сообщений по собеседникам
+  \param[in] login Логин пользователя
+  \param[in] counts Результат - собеседники с непрочитанными сообщениями
+  \return Всего непрочитанных сообщений
+  */
+  size_t getUnreadSummary(const std::string& login, std::vector<UnreadCount>& counts);
+
+  /**
+  Состояние пользователя на сервере для фонового опроса
+  */
+  struct Updates {
+    uint64_t directoryVersion = 0;  ///<Версия списка пользователей
+    uint64_t lastSequence = 0;      ///<Номер последнего сообщения пользователю
+    size_t total = 0;               ///<Всего непрочитанных сообщений
+    std::vector<UnreadCount> counts;  ///<Собеседники с непрочитанными сообщениями
+  };
+
+  /**
+  Запросить у сервера одним запросом версию списка пользователей, номер последнего
+  сообщения пользователю и количество непрочитанных сообщений по собеседникам
+  \param[in] login Логин пользователя
+  \param[in] updates Результат
+  \return Признак того, что ответ получен
+  */
+  bool getUpdates(const std::string& login, Updates& updates);
+
+  /**
+  Отметить на сервере прочитанными сообщения переписок (одним запросом)
+  \param[in] login Логин пользователя
+  \param[in] acknowledgements Пары Ник собеседника - номер последнего прочитанного
+  сообщения переписки с ним
+  */
+  void acknowledgeRead(const std::string& login,
+                       const std::vector<std::pair<std::string, uint64_t> >& acknowledgements);
+
+  /**
+  Запросить у сервера страницу переписки с собеседником (сообщения в обе стороны)
+  \param[in] login Логин пользователя
+  \param[in] peer Ник собеседника
+  \param[in] before Сообщения с номерами меньше заданного (0 - с последнего)
+  \param[in] limit Максимальное количество сообщений (длина ответа ограничена - их может быть меньше)
+  \param[in] messages Результат - список сообщений (от старых к новым)
+  \param[in] firstSequence Результат - номер самого старого сообщения страницы (0 - пусто)
+  \return Признак того, что собеседник зарегистрирован
+  */
+  bool getConversation(const std::string& login,
+                       const std::string& peer,
+                       uint64_t before,
+                       size_t limit,
+                       std::shared_ptr<std::list<Message> >& messages,
+                       uint64_t& firstSequence);
+
   /**
 	Запросить сервер добавить нового пользователя в Базу
 	\param[in] name Ник пользователя
 	\param[in] login Логин пользователя
 	\param[in] passwordHash Хэш пароля
+	\return ACCEPTED - пользователь добавлен, REJECTED - Логин или Ник уже заняты,
+	BUSY - сервер занят
 	*/
-	void addUser(const std::string& name,
-              const std::string& login,
-              const std::string& passwordHash);
+	AuthResult addUser(const std::string& name,
+                     const std::string& login,
+                     const std::string& passwordHash);
 
   /**
-	Запросить сервер добавить сообщение пользователю в Базу
+	Запросить сервер добавить сообщение пользователю в Базу.
+	Если ответ не получен, запрос повторяется с тем же идентификатором сообщения -
+	сервер подтверждает повтор, не добавляя сообщение второй раз
 	\param[in] nameTo Ник пользователя которому сообщение
 	\param[in] nameFrom Ник пользователя от которого сообщение
 	\param[in] message Сообщение
@@ -83,10 +207,95 @@ namespace server{
                   const std::string& nameFrom,
                   const std::string& message);
 
+  /**
+	Запросить сервер добавить одно сообщение нескольким пользователям (за один запрос)
+	\param[in] namesTo Ники пользователей которым сообщение
+	\param[in] nameFrom Ник пользователя от которого сообщение
+	\param[in] message Сообщение
+	\param[in] delivered Результат - признаки доставки каждому адресату
+	*/
+	void addMessage(const std::vector<std::string>& namesTo,
+                  const std::string& nameFrom,
+                  const std::string& message,
+                  std::vector<bool>& delivered);
+
   /**
   Запросить у сервера удалить аккаунт пользователя по Логину
   \param[in] login Логин
   */  
   void removeUser(const std::string& login);
 
+  /**
+  Запросить у сервера создать комнату (создатель становится её участником)
+  \param[in] login Логин создателя
+  \param[in] room Название комнаты
+  \return Признак успешного создания
+  */
+  bool createRoom(const std::string& login, const std::string& room);
+
+  /**
+  Запросить у сервера вступить в комнату
+  \param[in] login Логин пользователя
+  \param[in] room Название комнаты
+  \return Признак того, что комната существует
+  */
+  bool joinRoom(const std::string& login, const std::string& room);
+
+  /**
+  Запросить у сервера выйти из комнаты
+  \param[in] login Логин участника
+  \param[in] room Название комнаты
+  \return Признак того, что пользователь был участником комнаты
+  */
+  bool leaveRoom(const std::string& login, const std::string& room);
+
+  /**
+  Запросить сервер отправить сообщение в комнату
+  \param[in] login Логин участника
+  \param[in] room Название комнаты
+  \param[in] message Сообщение
+  \return Признак того, что пользователь - участник комнаты
+  */
+  bool postToRoom(const std::string& login,
+                  const std::string& room,
+                  const std::string& message);
+
+  /**
+  Запросить у сервера непрочитанные сообщения комнаты
+  \param[in] login Логин участника
+  \param[in] room Название комнаты
+  \param[in] messages Результат - список сообщений (от старых к новым)
+  \return Признак того, что пользователь - участник комнаты
+  */
+  bool getRoomMessages(const std::string& login,
+                       const std::string& room,
+                       std::shared_ptr<std::list<Message> >& messages);
+
+  /**
+  Запросить у сервера названия комнат пользователя
+  \param[in] login Логин пользователя
+  \param[in] rooms Результат - указатель на вектор названий
+  */
+  void getRooms(const std::string& login,
+                std::shared_ptr<std::vector<std::string> > rooms);
+
+  /**
+  Получатель времени ответа на запросы: код команды запроса, время от отправки
+  запроса до ответа, признак получения ответа (false - нет связи или ответа нет)
+  */
+  using Observer = void (*)(int command, std::chrono::microseconds elapsed, bool isAnswered);
+
+  /**
+  Сообщать время ответа на каждый запрос (для замеров нагрузки). Получатель
+  вызывается в потоке, сделавшем запрос
+  \param[in] observer Получатель (nullptr - не сообщать)
+  */
+  void setObserver(Observer observer);
+
+  /**
+  \param[in] command Код команды запроса
+  \return Название команды (для отчётов)
+  */
+  std::string getCommandName(int command);
+
 }
\ No newline at end of file
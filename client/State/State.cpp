@@ -1,18 +1,28 @@
-﻿#include "State.h"
-
-State::State(const std::string& name) : name_(name)
-{
-}
-
-
-
-State::~State()
-{
-}
-
-
-
-const std::string& State::getName() const
-{
-	return name_;
+﻿#include "State.h"
+
+State::State(const std::string& name) : name_(name)
+{
+}
+
+
+
+State::~State()
+{
+}
+
+
+
+const std::string& State::getName() const
+{
+	return name_;
+}
+
+
+
+int State::parseChoice(const std::string& input)
+{
+	if (input.length() != 1 || input[0] < '0' || input[0] > '9') {
+		return -1;
+	}
+	return input[0] - '0';
 }
\ No newline at end of file
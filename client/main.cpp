@@ -7,6 +7,13 @@
 #include "Server/Server.h"
 #include "User/User.h"
 #include "Chat/Chat.h"
+#include "Directory/Directory.h"
+#include "SHA_1/SHA_1_Wrapper.h"
+#include "Console/Console.h"
+#include "Notifier/Notifier.h"
+#include "History/History.h"
+#include "LoadTest/LoadTest.h"
+#include "Benchmark/Benchmark.h"
 
 
 namespace{
@@ -20,14 +27,32 @@ namespace{
 static void test();
 
 
-int main()
+int main(int argc, char* argv[])
 {
   try{
     test();
+    //Режим замеров производительности
+    if (argc > 1 && std::string(argv[1]) == "benchmark"){
+      benchmark::run();
+      return EXIT_SUCCESS;
+    }
+
+    //Безголовый режим нагрузки: ./client load USERS ROUNDS [SCRIPT]
+    if (argc > 1 && std::string(argv[1]) == "load"){
+      if (argc < 4) {
+        std::cerr << "Usage: " << argv[0] << " load USERS ROUNDS [SCRIPT]" << std::endl;
+        return EXIT_FAILURE;
+      }
+      const bool isDone = load_test::run(std::stoul(argv[2]), std::stoul(argv[3]),
+                                         argc > 4 ? argv[4] : "");
+      return isDone ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
     std::shared_ptr<bool> isRun = std::make_shared<bool>(true);
 		Chat::getInstance()->attach(isRun);
 
-		while (*isRun) {
+		//Ввод может быть и не консолью (файл, канал) - работа заканчивается с его концом
+		while (*isRun && !console::isFinished()) {
 			Chat::getInstance()->process();
 		}
   }
@@ -37,6 +62,7 @@ int main()
 	catch (...) {
 		std::cerr << "Undefined exception" << std::endl;
 	}
+  notifier::stop();
   return EXIT_SUCCESS;
 }
 
@@ -46,4 +72,9 @@ static void test()
 {
 	user::test();
 	message::test();
+	directory::test();
+	sha_1::test();
+	console::test();
+	history::test();
+	load_test::test();
 }
\ No newline at end of file
@@ -0,0 +1,167 @@
+#include "AuthPool.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <assert.h>
+
+
+namespace{
+  using Clock = std::chrono::steady_clock;
+
+  //Задача в очереди
+  struct Task {
+    std::function<void()> work;
+    Clock::time_point queuedAt;   //Время постановки в очередь
+  };
+
+  std::vector<std::thread> workers;
+  std::mutex mutex;
+  std::condition_variable wakeUp;
+  std::deque<Task> queue;
+  size_t capacity = 0;
+  bool isRunning = false;
+
+  auth_pool::Metrics metrics;
+}
+
+
+//Цикл потока пула: брать задачи из очереди, пока пул не остановлен
+static void work();
+
+//Прошедшее время в микросекундах
+static uint64_t elapsedMicroseconds(Clock::time_point start, Clock::time_point end);
+
+
+
+void auth_pool::start(size_t threads, size_t queueCapacity)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  //Уже запущен
+  if (isRunning){
+    return;
+  }
+  isRunning = true;
+  capacity = queueCapacity;
+  metrics = Metrics();
+  for (size_t i = 0; i < (threads == 0 ? 1 : threads); ++i){
+    workers.emplace_back(work);
+  }
+}
+
+
+
+void auth_pool::stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    isRunning = false;
+  }
+  wakeUp.notify_all();
+  for (auto& worker : workers){
+    worker.join();
+  }
+  workers.clear();
+}
+
+
+
+bool auth_pool::submit(std::function<void()> task)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!isRunning || queue.size() >= capacity){
+      ++metrics.rejected;
+      return false;
+    }
+    queue.push_back(Task{std::move(task), Clock::now()});
+    ++metrics.submitted;
+    metrics.maxQueued = std::max(metrics.maxQueued, queue.size());
+  }
+  wakeUp.notify_one();
+  return true;
+}
+
+
+
+auth_pool::Metrics auth_pool::getMetrics()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  Metrics result = metrics;
+  result.queued = queue.size();
+  return result;
+}
+
+
+
+static void work()
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true){
+    //Остановленный пул сначала выполняет оставшиеся задачи
+    wakeUp.wait(lock, []() { return !queue.empty() || !isRunning; });
+    if (queue.empty()){
+      return;
+    }
+    Task task = std::move(queue.front());
+    queue.pop_front();
+    lock.unlock();
+
+    const Clock::time_point started = Clock::now();
+    task.work();
+    const Clock::time_point finished = Clock::now();
+
+    lock.lock();
+    ++metrics.completed;
+    metrics.waitMicroseconds += elapsedMicroseconds(task.queuedAt, started);
+    metrics.workMicroseconds += elapsedMicroseconds(started, finished);
+  }
+}
+
+
+
+static uint64_t elapsedMicroseconds(Clock::time_point start, Clock::time_point end)
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+}
+
+
+
+void auth_pool::test()
+{
+  //Не запущенный пул задач не принимает
+  assert(submit([]() {}) == false);
+
+  //Задачи сверх длины очереди отклоняются, принятые - выполняются
+  std::mutex gateMutex;
+  std::unique_lock<std::mutex> gate(gateMutex);
+  std::atomic<int> done(0);
+  start(1, 2);
+  assert(submit([&gateMutex, &done]() {
+    std::lock_guard<std::mutex> lock(gateMutex);
+    ++done;
+  }) == true);
+  //Дождаться, пока поток возьмёт первую задачу и остановится на ней
+  while (getMetrics().queued != 0){
+    std::this_thread::yield();
+  }
+  assert(submit([&done]() { ++done; }) == true);
+  assert(submit([&done]() { ++done; }) == true);
+  assert(submit([&done]() { ++done; }) == false);
+  gate.unlock();
+
+  //Остановка выполняет всю очередь
+  stop();
+  assert(done == 3);
+  const Metrics result = getMetrics();
+  assert(result.submitted == 3);
+  assert(result.rejected == 1);
+  assert(result.completed == 3);
+  assert(result.maxQueued == 2);
+  assert(result.queued == 0);
+  assert(submit([]() {}) == false);
+}
\ No newline at end of file
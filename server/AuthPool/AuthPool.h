@@ -0,0 +1,58 @@
+/**
+\file AuthPool.h
+\brief Модуль "Пул проверки паролей" - потоки для дорогих расчётов учётных данных
+Проверка пароля и создание учётной записи выполняются в отдельных потоках с
+ограниченной очередью, чтобы поток приёма запросов тем временем обслуживал
+остальные команды. При заполненной очереди задача не принимается.
+*/
+
+#pragma once
+
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace auth_pool{
+  /**
+  Метрики пула
+  */
+  struct Metrics {
+    uint64_t submitted = 0;         ///<Принято задач
+    uint64_t rejected = 0;          ///<Отклонено задач (очередь заполнена)
+    uint64_t completed = 0;         ///<Выполнено задач
+    size_t queued = 0;              ///<Задач в очереди сейчас
+    size_t maxQueued = 0;           ///<Наибольшая длина очереди
+    uint64_t waitMicroseconds = 0;  ///<Суммарное время задач в очереди
+    uint64_t workMicroseconds = 0;  ///<Суммарное время выполнения задач
+  };
+
+  /**
+  Запустить потоки пула
+  \param[in] threads Количество потоков
+  \param[in] capacity Наибольшая длина очереди
+  */
+  void start(size_t threads, size_t capacity);
+
+  /**
+  Остановить пул: выполнить задачи из очереди и дождаться завершения потоков
+  */
+  void stop();
+
+  /**
+  Поставить задачу в очередь
+  \param[in] task Задача
+  \return false - очередь заполнена или пул не запущен
+  */
+  bool submit(std::function<void()> task);
+
+  /**
+  \return Метрики с момента запуска
+  */
+  Metrics getMetrics();
+
+  /**
+  Запустить тестирование функций модуля
+  */
+  void test();
+}
\ No newline at end of file
@@ -0,0 +1,537 @@
+#include "Benchmark.h"
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <vector>
+#include <string_view>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <random>
+
+#include "../DataBase/DataBase.h"
+#include "../UserTable/UserTable.h"
+#include "../SHA_1/SHA_1_Wrapper.h"
+#include "../SHA_1/sha1.hpp"
+#include "../Credential/Credential.h"
+#include "../AuthPool/AuthPool.h"
+
+
+namespace{
+  using Clock = std::chrono::steady_clock;
+
+  //Параметры замера загрузки снимка
+  const size_t LOAD_USERS = 200000;
+  const size_t LOAD_MESSAGES_PER_USER = 4;
+  const size_t LOAD_SEGMENTS = 16;
+  const size_t LOAD_MAX_THREADS = 16;
+  const std::string LOAD_DIRECTORY = "/tmp/chat_snapshot_benchmark";
+
+  //Параметры замера регистрации
+  const size_t REGISTER_USERS = 200000;   //Зарегистрированных пользователей
+  const size_t REGISTER_PROBES = 200000;  //Проверок новых Логинов и Ников
+  const unsigned REGISTER_SEED = 2024;    //Зерно перемешивания проверок
+
+  //Параметры замера перебора пользователей
+  const size_t SCAN_USERS = 1000000;
+  const size_t SCAN_REPEATS = 5;
+
+  //Параметры замера выборки по времени
+  const size_t TIME_MESSAGES = 1000000;   //Сообщений пользователю, по одному в секунду
+  const std::time_t TIME_WINDOW = 3600;   //Интервал выборки - последний час
+
+  //Параметры замера расчёта хэша
+  const size_t HASH_PASSWORDS = 1000000;  //Хэшей коротких строк (паролей)
+  const size_t HASH_BULK_BYTES = 64 << 20; //Объём длинной строки
+  const size_t HASH_BATCH_SIZES[] = {1, 2, 4, 8, 16, 64, 1024}; //Строк в одном пакете
+
+  //Параметры замера проверки паролей
+  const uint32_t AUTH_COSTS[] = {1000, 10000, 100000};  //Итераций PBKDF2
+  const double AUTH_MEASURE_MS = 500;   //Время замера одной стоимости
+  const uint32_t STORM_COST = 10000;    //Стоимость при наплыве входов
+  const size_t STORM_REQUESTS = 400;    //Входов и сообщений в потоке запросов
+}
+
+
+//Время загрузки снимка в зависимости от количества потоков
+static void benchmarkLoad();
+
+//Время проверки свободных Логинов и Ников: с фильтрами против поиска только в дереве,
+//и доля ложных ответов фильтров
+static void benchmarkRegister();
+
+//Время перебора всех пользователей: таблица в узлах дерева против таблицы по столбцам
+static void benchmarkScan();
+
+//Время выборки сообщений за интервал времени: индекс времени против просмотра списка
+static void benchmarkTimeRange();
+
+//Скорость расчёта хэша: прежний расчёт через строки и потоки против расчёта на стеке
+//каждой реализацией, которую поддерживает процессор
+static void benchmarkHash();
+
+//Время расчёта хэша пакетами разного размера
+static void benchmarkHashBatch();
+
+//Количество проверок пароля в секунду на одном ядре и на всех ядрах
+static void benchmarkCredential();
+
+//Время доставки сообщений при наплыве входов: проверка пароля в потоке запросов
+//против проверки в пуле
+static void benchmarkLoginStorm();
+
+//Прошедшее время в миллисекундах
+static double elapsedMs(Clock::time_point start);
+
+
+
+void benchmark::run()
+{
+  benchmarkLoad();
+  benchmarkRegister();
+  benchmarkScan();
+  benchmarkTimeRange();
+  benchmarkHash();
+  benchmarkHashBatch();
+  benchmarkCredential();
+  benchmarkLoginStorm();
+}
+
+
+
+static void benchmarkLoad()
+{
+  std::cout << "Snapshot load: " << LOAD_USERS << " users, "
+            << LOAD_MESSAGES_PER_USER << " messages per user, "
+            << LOAD_SEGMENTS << " segments\n";
+
+  //Заполнить базу и сохранить снимок
+  database::clear();
+  for (size_t i = 0; i < LOAD_USERS; ++i) {
+    const std::string index = std::to_string(i);
+    database::addUser("name_" + index, "login_" + index, credential::Record());
+    for (size_t j = 0; j < LOAD_MESSAGES_PER_USER; ++j) {
+      database::pushMessage("name_" + index,
+                            Message("name_0", "benchmark message " + std::to_string(j)));
+    }
+  }
+  if (!database::save(LOAD_DIRECTORY, LOAD_SEGMENTS)) {
+    std::cout << "  unable to save snapshot to " << LOAD_DIRECTORY << std::endl;
+    return;
+  }
+  database::clear();
+
+  std::cout << "  threads   load, ms\n";
+  for (size_t threads = 1; threads <= LOAD_MAX_THREADS; threads *= 2) {
+    const auto start = Clock::now();
+    const bool isLoaded = database::load(LOAD_DIRECTORY, threads);
+    const double time = elapsedMs(start);
+    std::cout << "  " << std::setw(7) << threads << "   "
+              << std::fixed << std::setprecision(1) << time
+              << (isLoaded ? "" : " (failed)") << std::endl;
+    database::clear();
+  }
+}
+
+
+
+static void benchmarkRegister()
+{
+  std::cout << "Registration checks: " << REGISTER_USERS << " users, "
+            << REGISTER_PROBES << " new logins and nicknames\n";
+
+  database::clear();
+  //Те же пользователи в деревьях, как в базе, - для проверки без фильтров
+  std::map<std::string, User> users;
+  std::map<std::string, std::string> nameIndex;
+  for (size_t i = 0; i < REGISTER_USERS; ++i) {
+    const std::string index = std::to_string(i);
+    database::addUser("name_" + index, "login_" + index, credential::Record());
+    users.emplace("login_" + index, User("name_" + index, "login_" + index, credential::Record()));
+    nameIndex.emplace("name_" + index, "login_" + index);
+  }
+
+  //Новые Логины и Ники - заранее и вперемешку: строки не собираются в замере,
+  //а соседние проверки не идут по одному пути в дереве
+  std::vector<std::string> logins;
+  std::vector<std::string> names;
+  std::vector<size_t> order(REGISTER_PROBES);
+  for (size_t i = 0; i < REGISTER_PROBES; ++i) {
+    order[i] = REGISTER_USERS + i;
+  }
+  std::shuffle(order.begin(), order.end(), std::mt19937(REGISTER_SEED));
+  for (size_t i : order) {
+    logins.push_back("login_" + std::to_string(i));
+    names.push_back("name_" + std::to_string(i));
+  }
+
+  BloomFilter::Statistics loginsBefore;
+  BloomFilter::Statistics nicknamesBefore;
+  database::loadFilterStatistics(loginsBefore, nicknamesBefore);
+
+  //Проверки, которые клиент делает перед регистрацией
+  size_t registered = 0;
+  const auto start = Clock::now();
+  for (size_t i = 0; i < REGISTER_PROBES; ++i) {
+    registered += database::isLoginRegistered(logins[i]);
+    registered += database::isNicknameRegistered(names[i]);
+  }
+  const double time = elapsedMs(start);
+
+  //Прежние проверки: поиск в дереве под такой же блокировкой, как в базе, без фильтра
+  std::recursive_mutex mutex;
+  size_t found = 0;
+  const auto mapStart = Clock::now();
+  for (size_t i = 0; i < REGISTER_PROBES; ++i) {
+    {
+      std::lock_guard<std::recursive_mutex> lock(mutex);
+      found += users.find(logins[i]) != users.end();
+    }
+    {
+      std::lock_guard<std::recursive_mutex> lock(mutex);
+      found += nameIndex.find(names[i]) != nameIndex.end();
+    }
+  }
+  const double mapTime = elapsedMs(mapStart);
+
+  BloomFilter::Statistics loginsAfter;
+  BloomFilter::Statistics nicknamesAfter;
+  database::loadFilterStatistics(loginsAfter, nicknamesAfter);
+  const uint64_t queries = (loginsAfter.queries - loginsBefore.queries) +
+                           (nicknamesAfter.queries - nicknamesBefore.queries);
+  const uint64_t falsePositives =
+    (loginsAfter.falsePositives - loginsBefore.falsePositives) +
+    (nicknamesAfter.falsePositives - nicknamesBefore.falsePositives);
+
+  std::cout << "  " << std::fixed << std::setprecision(1)
+            << "filters " << time * 1000000.0 / (2 * REGISTER_PROBES) << " ns per check, "
+            << "map only " << mapTime * 1000000.0 / (2 * REGISTER_PROBES) << " ns per check, "
+            << std::setprecision(2)
+            << 100.0 * falsePositives / std::max<uint64_t>(queries, 1)
+            << "% false positives" << (registered || found ? " (unexpected match)" : "")
+            << std::endl;
+  database::clear();
+}
+
+
+
+static void benchmarkScan()
+{
+  std::cout << "User scan: " << SCAN_USERS << " users, best of "
+            << SCAN_REPEATS << " runs\n";
+
+  //Пользователи в узлах дерева, как в базе, и их таблица по столбцам
+  std::map<std::string, User> users;
+  UserTable table;
+  for (size_t i = 0; i < SCAN_USERS; ++i) {
+    const std::string index = std::to_string(i);
+    auto user = users.emplace("login_" + index,
+                              User("name_" + index, "login_" + index,
+                                   credential::Record())).first;
+    table.insert(user->second.getName(), &user->second);
+  }
+
+  double mapNames = 1e9, tableNames = 1e9, mapWalk = 1e9, tableWalk = 1e9;
+  size_t checksum = 0;
+  std::vector<std::string> names;
+  for (size_t repeat = 0; repeat < SCAN_REPEATS; ++repeat) {
+    //Список Ников
+    auto start = Clock::now();
+    names.clear();
+    for (const auto& dataPair : users) {
+      names.push_back(dataPair.second.getName());
+    }
+    mapNames = std::min(mapNames, elapsedMs(start));
+    checksum += names.size();
+
+    start = Clock::now();
+    table.loadNames(names);
+    tableNames = std::min(tableNames, elapsedMs(start));
+    checksum += names.size();
+
+    //Обход данных всех пользователей (как при рассылке "всем")
+    start = Clock::now();
+    for (const auto& dataPair : users) {
+      checksum += dataPair.second.getLastSequence();
+    }
+    mapWalk = std::min(mapWalk, elapsedMs(start));
+
+    start = Clock::now();
+    table.forEachUser([&checksum](User& user) {
+      checksum += user.getLastSequence();
+    });
+    tableWalk = std::min(tableWalk, elapsedMs(start));
+  }
+
+  std::cout << "  scan          map, ms   columns, ms\n" << std::fixed << std::setprecision(1)
+            << "  nicknames  " << std::setw(10) << mapNames
+            << std::setw(14) << tableNames << "\n"
+            << "  users      " << std::setw(10) << mapWalk
+            << std::setw(14) << tableWalk << std::endl;
+  if (checksum != 2 * SCAN_REPEATS * SCAN_USERS) {
+    std::cout << "  unexpected checksum " << checksum << std::endl;
+  }
+}
+
+
+
+static void benchmarkTimeRange()
+{
+  std::cout << "Time range: " << TIME_MESSAGES << " messages, last "
+            << TIME_WINDOW << " s\n";
+
+  database::clear();
+  database::addUser("name_0", "login_0", credential::Record());
+  const std::time_t start = 1000000000;
+  for (size_t i = 0; i < TIME_MESSAGES; ++i) {
+    database::pushMessage("name_0", Message("name_0", "benchmark", start + i));
+  }
+  const std::time_t end = start + TIME_MESSAGES - 1;
+
+  //По индексу времени
+  auto begin = Clock::now();
+  std::list<Message> messages;
+  database::loadMessagesByTime("login_0", end - TIME_WINDOW + 1, end, 0, messages);
+  const double indexTime = elapsedMs(begin);
+  const size_t indexCount = messages.size();
+
+  //Просмотром всего списка
+  begin = Clock::now();
+  auto all = std::make_shared<std::list<Message> >();
+  database::loadMessages("login_0", all);
+  size_t scanCount = 0;
+  for (const auto& message : *all) {
+    scanCount += (message.getTime() > end - TIME_WINDOW);
+  }
+  const double scanTime = elapsedMs(begin);
+
+  std::cout << "  " << std::fixed << std::setprecision(2)
+            << "index " << indexTime << " ms, full scan " << scanTime << " ms"
+            << (indexCount == scanCount ? "" : " (results differ)") << std::endl;
+  database::clear();
+}
+
+
+
+static void benchmarkHash()
+{
+  std::cout << "SHA-1: " << HASH_PASSWORDS << " passwords, "
+            << (HASH_BULK_BYTES >> 20) << " MB string\n";
+
+  std::vector<std::string> passwords;
+  passwords.reserve(HASH_PASSWORDS);
+  for (size_t i = 0; i < HASH_PASSWORDS; ++i) {
+    passwords.push_back("password_" + std::to_string(i));
+  }
+  const std::string bulk(HASH_BULK_BYTES, 'a');
+
+  //Прежний расчёт: объект в куче, входные данные через поток, результат через поток
+  //Контрольная сумма - первые цифры всех хэшей
+  const char digits[] = "0123456789abcdef";
+  size_t oldChecksum = 0;
+
+  auto begin = Clock::now();
+  for (const auto& password : passwords) {
+    auto hasher = std::make_unique<SHA1>();
+    hasher->update(password);
+    oldChecksum += hasher->final()[0];
+  }
+  const double oldPasswords = elapsedMs(begin);
+  begin = Clock::now();
+  auto hasher = std::make_unique<SHA1>();
+  hasher->update(bulk);
+  const std::string oldBulk = hasher->final();
+  const double oldBulkTime = elapsedMs(begin);
+
+  const double megabytes = static_cast<double>(HASH_BULK_BYTES) / (1 << 20);
+  std::cout << "  " << std::fixed << std::setprecision(1)
+            << "stream: passwords " << oldPasswords << " ms, bulk "
+            << megabytes / oldBulkTime * 1000 << " MB/s\n";
+
+  //Расчёт на стеке каждой реализацией процессора: хэш строкой и хэш 20 байтами
+  const sha_1::Backend detected = sha_1::getBackend();
+  const std::pair<sha_1::Backend, const char*> backends[] = {
+    {sha_1::Backend::PORTABLE, "portable"}, {sha_1::Backend::SHA_NI, "sha-ni"}};
+  for (const auto& backend : backends) {
+    if (!sha_1::setBackend(backend.first)) {
+      continue;
+    }
+    size_t hexChecksum = 0;
+    size_t rawChecksum = 0;
+    begin = Clock::now();
+    for (const auto& password : passwords) {
+      hexChecksum += sha_1::hash(password)[0];
+    }
+    const double hexPasswords = elapsedMs(begin);
+    begin = Clock::now();
+    for (const auto& password : passwords) {
+      rawChecksum += digits[sha_1::digest(password)[0] >> 4];
+    }
+    const double rawPasswords = elapsedMs(begin);
+    begin = Clock::now();
+    const std::string newBulk = sha_1::hash(bulk);
+    const double newBulkTime = elapsedMs(begin);
+
+    std::cout << "  " << backend.second << ": passwords hex " << hexPasswords
+              << " ms, raw " << rawPasswords << " ms, bulk "
+              << megabytes / newBulkTime * 1000 << " MB/s"
+              << (oldBulk == newBulk ? "" : " (results differ)") << std::endl;
+    if (oldChecksum != hexChecksum || oldChecksum != rawChecksum) {
+      std::cout << "  unexpected checksum" << std::endl;
+    }
+  }
+  sha_1::setBackend(detected);
+}
+
+
+
+static void benchmarkHashBatch()
+{
+  std::cout << "SHA-1 batches: " << HASH_PASSWORDS << " passwords\n";
+
+  std::vector<std::string> passwords;
+  passwords.reserve(HASH_PASSWORDS);
+  for (size_t i = 0; i < HASH_PASSWORDS; ++i) {
+    passwords.push_back("password_" + std::to_string(i));
+  }
+  const std::vector<std::string_view> values(passwords.begin(), passwords.end());
+
+  //По одной строке каждой реализацией сжатия блока
+  const sha_1::Backend detected = sha_1::getBackend();
+  const std::pair<sha_1::Backend, const char*> backends[] = {
+    {sha_1::Backend::PORTABLE, "portable"}, {sha_1::Backend::SHA_NI, "sha-ni"}};
+  size_t singleChecksum = 0;
+  for (const auto& backend : backends) {
+    if (!sha_1::setBackend(backend.first)) {
+      continue;
+    }
+    const auto begin = Clock::now();
+    singleChecksum = 0;
+    for (const auto& value : passwords) {
+      singleChecksum += sha_1::digest(value)[0];
+    }
+    std::cout << "  " << std::fixed << std::setprecision(1) << "single " << backend.second
+              << ": " << elapsedMs(begin) * 1e6 / HASH_PASSWORDS << " ns per hash\n";
+  }
+  sha_1::setBackend(detected);
+
+  //Пакетами
+  for (size_t batchSize : HASH_BATCH_SIZES) {
+    std::vector<std::string_view> batch;
+    std::vector<sha_1::Digest> digests;
+    size_t checksum = 0;
+    const auto begin = Clock::now();
+    for (size_t first = 0; first < values.size(); first += batchSize) {
+      batch.assign(values.begin() + first,
+                   values.begin() + std::min(first + batchSize, values.size()));
+      sha_1::digestBatch(batch, digests);
+      for (const auto& digest : digests) {
+        checksum += digest[0];
+      }
+    }
+    std::cout << "  batch " << std::setw(4) << batchSize << ": "
+              << elapsedMs(begin) * 1e6 / HASH_PASSWORDS << " ns per hash"
+              << (checksum == singleChecksum ? "" : " (results differ)") << std::endl;
+  }
+}
+
+
+
+static void benchmarkCredential()
+{
+  const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+  std::cout << "Credential: PBKDF2-HMAC-SHA1, " << cores << " cores\n";
+
+  const sha_1::Digest passwordHash = sha_1::digest("password");
+  const uint32_t detected = credential::getCost();
+  for (uint32_t cost : AUTH_COSTS) {
+    credential::setCost(cost);
+    const credential::Record stored = credential::make(passwordHash);
+
+    //Один поток
+    size_t verifies = 0;
+    auto begin = Clock::now();
+    while (elapsedMs(begin) < AUTH_MEASURE_MS) {
+      verifies += credential::verify(stored, passwordHash);
+    }
+    const double single = verifies / elapsedMs(begin) * 1000;
+
+    //Все ядра
+    std::atomic<size_t> total(0);
+    std::vector<std::thread> threads;
+    begin = Clock::now();
+    for (size_t i = 0; i < cores; ++i) {
+      threads.emplace_back([&]() {
+        size_t count = 0;
+        while (elapsedMs(begin) < AUTH_MEASURE_MS) {
+          count += credential::verify(stored, passwordHash);
+        }
+        total += count;
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    const double all = total / elapsedMs(begin) * 1000;
+
+    std::cout << "  cost " << std::setw(6) << cost << ": " << std::fixed << std::setprecision(0)
+              << single << " verifies/s per core, " << all << " verifies/s all cores, "
+              << std::setprecision(2) << 1000 / single << " ms per verify" << std::endl;
+  }
+  credential::setCost(detected);
+}
+
+
+
+static void benchmarkLoginStorm()
+{
+  std::cout << "Login storm: " << STORM_REQUESTS << " logins and "
+            << STORM_REQUESTS << " messages, cost " << STORM_COST << "\n";
+
+  database::clear();
+  database::addUser("name_0", "login_0", credential::Record());
+  credential::setCost(STORM_COST);
+  const sha_1::Digest passwordHash = sha_1::digest("password");
+  const credential::Record stored = credential::make(passwordHash);
+
+  //Поток запросов: вход, сообщение, вход, сообщение...
+  //В потоке запросов - каждое сообщение ждёт проверки пароля перед ним
+  auto begin = Clock::now();
+  size_t accepted = 0;
+  for (size_t i = 0; i < STORM_REQUESTS; ++i) {
+    accepted += credential::verify(stored, passwordHash);
+    database::pushMessage("name_0", Message("name_0", "storm"));
+  }
+  const double inlineDelivery = elapsedMs(begin);
+
+  //В пуле - поток запросов только ставит проверку в очередь
+  const unsigned cores = std::thread::hardware_concurrency();
+  auth_pool::start(cores > 1 ? cores - 1 : 1, STORM_REQUESTS);
+  std::atomic<size_t> pooled(0);
+  begin = Clock::now();
+  for (size_t i = 0; i < STORM_REQUESTS; ++i) {
+    auth_pool::submit([&]() { pooled += credential::verify(stored, passwordHash); });
+    database::pushMessage("name_0", Message("name_0", "storm"));
+  }
+  const double poolDelivery = elapsedMs(begin);
+  auth_pool::stop();
+  const double poolLogins = elapsedMs(begin);
+
+  std::cout << "  " << std::fixed << std::setprecision(1)
+            << "inline: messages delivered in " << inlineDelivery << " ms\n"
+            << "  pool: messages delivered in " << poolDelivery << " ms, logins done in "
+            << poolLogins << " ms" << (accepted == pooled ? "" : " (results differ)") << std::endl;
+  database::clear();
+}
+
+
+
+static double elapsedMs(Clock::time_point start)
+{
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
\ No newline at end of file
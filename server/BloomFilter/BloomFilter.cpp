@@ -0,0 +1,168 @@
+#include "BloomFilter.h"
+
+#include <functional>
+#include <assert.h>
+
+
+namespace{
+  const uint8_t MAX_COUNTER = 255;  //Насыщенный счётчик больше не меняется
+}
+
+
+//Наименьшая степень двойки, не меньше заданного числа
+static size_t roundUpPower(size_t value);
+
+
+
+BloomFilter::BloomFilter(size_t counters, size_t hashes) :
+  counters_(roundUpPower(counters), 0),
+  mask_(counters_.size() - 1),
+  hashes_(hashes == 0 ? 1 : hashes)
+{
+}
+
+
+
+void BloomFilter::add(const std::string& value)
+{
+  uint64_t h1 = 0;
+  uint64_t h2 = 0;
+  hash(value, h1, h2);
+  for (size_t i = 0; i < hashes_; ++i, h1 += h2) {
+    uint8_t& counter = counters_[h1 & mask_];
+    if (counter != MAX_COUNTER) {
+      ++counter;
+    }
+  }
+}
+
+
+
+void BloomFilter::remove(const std::string& value)
+{
+  uint64_t h1 = 0;
+  uint64_t h2 = 0;
+  hash(value, h1, h2);
+  for (size_t i = 0; i < hashes_; ++i, h1 += h2) {
+    uint8_t& counter = counters_[h1 & mask_];
+    if (counter != 0 && counter != MAX_COUNTER) {
+      --counter;
+    }
+  }
+}
+
+
+
+bool BloomFilter::mayContain(const std::string& value)
+{
+  ++statistics_.queries;
+  uint64_t h1 = 0;
+  uint64_t h2 = 0;
+  hash(value, h1, h2);
+  for (size_t i = 0; i < hashes_; ++i, h1 += h2) {
+    if (counters_[h1 & mask_] == 0) {
+      ++statistics_.negatives;
+      return false;
+    }
+  }
+  return true;
+}
+
+
+
+void BloomFilter::reportFalsePositive()
+{
+  ++statistics_.falsePositives;
+}
+
+
+
+void BloomFilter::reset(size_t counters)
+{
+  counters_.assign(roundUpPower(counters), 0);
+  mask_ = counters_.size() - 1;
+}
+
+
+
+size_t BloomFilter::getCounters() const
+{
+  return counters_.size();
+}
+
+
+
+const BloomFilter::Statistics& BloomFilter::getStatistics() const
+{
+  return statistics_;
+}
+
+
+
+double BloomFilter::getFalsePositiveRate() const
+{
+  const uint64_t absent = statistics_.negatives + statistics_.falsePositives;
+  if (absent == 0) {
+    return 0.0;
+  }
+  return static_cast<double>(statistics_.falsePositives) / absent;
+}
+
+
+
+void BloomFilter::hash(const std::string& value, uint64_t& h1, uint64_t& h2)
+{
+  //Один проход по строке; шаг - перемешанный хэш (финализатор splitmix64)
+  h1 = std::hash<std::string>()(value);
+  uint64_t mixed = h1 + 0x9E3779B97F4A7C15ull;
+  mixed = (mixed ^ (mixed >> 30)) * 0xBF58476D1CE4E5B9ull;
+  mixed = (mixed ^ (mixed >> 27)) * 0x94D049BB133111EBull;
+  h2 = (mixed ^ (mixed >> 31)) | 1;
+}
+
+
+
+static size_t roundUpPower(size_t value)
+{
+  size_t power = 1;
+  while (power < value) {
+    power <<= 1;
+  }
+  return power;
+}
+
+
+
+//========================================================================================================
+void bloom_filter::test()
+{
+  BloomFilter filter(1024, 4);
+  assert(filter.mayContain("login") == false);
+
+  filter.add("login");
+  filter.add("other");
+  assert(filter.mayContain("login") == true);
+  assert(filter.mayContain("other") == true);
+
+  //Удаление одной строки не затрагивает другую
+  filter.remove("login");
+  assert(filter.mayContain("login") == false);
+  assert(filter.mayContain("other") == true);
+
+  //Статистика
+  filter.reportFalsePositive();
+  assert(filter.getStatistics().queries == 5);
+  assert(filter.getStatistics().negatives == 2);
+  assert(filter.getStatistics().falsePositives == 1);
+  assert(filter.getFalsePositiveRate() > 0.33 && filter.getFalsePositiveRate() < 0.34);
+
+  //Сброс с новым размером
+  filter.reset(2048);
+  assert(filter.getCounters() == 2048);
+  assert(filter.mayContain("other") == false);
+
+  //Размер - степень двойки
+  filter.reset(1000);
+  assert(filter.getCounters() == 1024);
+  assert(BloomFilter(0).getCounters() == 1);
+}
\ No newline at end of file
@@ -0,0 +1,104 @@
+/**
+\file BloomFilter.h
+\brief Класс - считающий фильтр Блума над множеством строк
+Отвечает на вопрос "есть ли строка в множестве" без обращения к самому множеству:
+ответ "нет" точный, ответ "возможно" требует проверки по множеству.
+Вместо битов хранит счётчики - поэтому поддерживает удаление строк.
+Строка хэшируется один раз за операцию, номера счётчиков - двойным хэшированием
+h1 + i * h2 по маске (количество счётчиков - степень двойки).
+Ведёт статистику запросов для оценки доли ложноположительных ответов.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+
+class BloomFilter {
+  public:
+    /**
+    Статистика запросов к фильтру
+    */
+    struct Statistics {
+      uint64_t queries = 0;         ///<Всего запросов
+      uint64_t negatives = 0;       ///<Ответов "точно нет"
+      uint64_t falsePositives = 0;  ///<Ответов "возможно", не подтверждённых множеством
+    };
+
+    /**
+    Параметризованный конструктор
+    \param[in] counters Количество счётчиков (округляется вверх до степени двойки)
+    \param[in] hashes Количество хэш-функций
+    */
+    BloomFilter(size_t counters = 1024, size_t hashes = 4);
+
+    /**
+    Добавить строку
+    \param[in] value Строка
+    */
+    void add(const std::string& value);
+
+    /**
+    Удалить строку (строка должна быть ранее добавлена)
+    \param[in] value Строка
+    */
+    void remove(const std::string& value);
+
+    /**
+    Проверить, может ли строка быть в множестве
+    \param[in] value Строка
+    \return false - строки точно нет, true - строка возможно есть
+    */
+    bool mayContain(const std::string& value);
+
+    /**
+    Учесть в статистике, что ответ "возможно" не подтвердился
+    */
+    void reportFalsePositive();
+
+    /**
+    Удалить все строки и задать новое количество счётчиков (статистика сохраняется)
+    \param[in] counters Количество счётчиков (округляется вверх до степени двойки)
+    */
+    void reset(size_t counters);
+
+    /**
+    \return Количество счётчиков
+    */
+    size_t getCounters() const;
+
+    /**
+    \return Статистика запросов
+    */
+    const Statistics& getStatistics() const;
+
+    /**
+    \return Доля ложноположительных ответов среди запросов строк, которых нет в множестве
+    */
+    double getFalsePositiveRate() const;
+
+  private:
+    /**
+    Посчитать пару хэшей строки для двойного хэширования
+    \param[in] value Строка
+    \param[out] h1 Первый хэш
+    \param[out] h2 Шаг (нечётный - чтобы последовательность не вырождалась)
+    */
+    static void hash(const std::string& value, uint64_t& h1, uint64_t& h2);
+
+    std::vector<uint8_t> counters_; ///<Счётчики (насыщаются на 255 и больше не меняются)
+    size_t mask_;                   ///<Количество счётчиков - 1
+    size_t hashes_;                 ///<Количество хэш-функций
+    Statistics statistics_;         ///<Статистика запросов
+};
+
+
+
+namespace bloom_filter {
+  /**
+  Запустить тестирование методов класса
+  */
+  void test();
+}
\ No newline at end of file
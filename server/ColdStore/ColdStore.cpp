@@ -0,0 +1,609 @@
+#include "ColdStore.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <assert.h>
+#include <stdlib.h>
+
+
+//Записать в поток целое число
+template <typename T>
+static void writeValue(std::ostream& stream, T value);
+
+//Прочитать из потока целое число
+template <typename T>
+static bool readValue(std::istream& stream, T& value);
+
+//Записать в поток строку в формате ДЛИНА|БАЙТЫ
+static void writeString(std::ostream& stream, const std::string& value);
+
+//Прочитать из потока строку в формате ДЛИНА|БАЙТЫ
+static bool readString(std::istream& stream, std::string& value);
+
+//Длина записи сообщения в файле, байт
+static uint32_t getRecordLength(const Message& message);
+
+
+
+bool ColdStore::open(const std::string& path)
+{
+  if (file_.is_open()) {
+    file_.close();
+  }
+  if (writer_.is_open()) {
+    writer_.close();
+  }
+  path_ = path;
+  end_ = 0;
+  writeEnd_ = 0;
+  //Создать файл, если его нет - содержимое существующего не отбрасывается
+  writer_.open(path, std::ios::binary | std::ios::app);
+  file_.open(path, std::ios::binary);
+  std::error_code error;
+  const uint64_t size = std::filesystem::file_size(path, error);
+  if (!file_.is_open() || !writer_.is_open() || error) {
+    file_.close();
+    writer_.close();
+    return false;
+  }
+  end_ = size;
+  writeEnd_ = size;
+
+  //Записи за концом файла недоступны (файл усечён или это файл другого снимка)
+  liveBytes_ = 0;
+  for (auto entries = index_.begin(); entries != index_.end(); ) {
+    auto& list = entries->second;
+    list.erase(std::remove_if(list.begin(), list.end(),
+                              [this](const Entry& entry) {
+                                return entry.offset + entry.length > end_;
+                              }),
+               list.end());
+    for (const auto& entry : list) {
+      liveBytes_ += entry.length;
+    }
+    entries = list.empty() ? index_.erase(entries) : std::next(entries);
+  }
+  return true;
+}
+
+
+
+bool ColdStore::isOpen() const
+{
+  return file_.is_open();
+}
+
+
+
+const std::string& ColdStore::getPath() const
+{
+  return path_;
+}
+
+
+
+bool ColdStore::append(const std::string& login, const Message& message)
+{
+  std::vector<Batch> batches(1);
+  batches.front().login = login;
+  batches.front().messages.push_back(message);
+  if (!write(batches)) {
+    return false;
+  }
+  commit(login, batches.front().entries);
+  return true;
+}
+
+
+
+bool ColdStore::write(std::vector<Batch>& batches)
+{
+  if (!writer_.is_open()) {
+    return false;
+  }
+
+  for (auto& batch : batches) {
+    batch.entries.clear();
+    for (const auto& message : batch.messages) {
+      writeValue<uint64_t>(writer_, message.getSequence());
+      writeValue<int64_t>(writer_, message.getTime());
+      writeValue<uint64_t>(writer_, message.getSenderId());
+      writeString(writer_, message.getNameFrom());
+      writeString(writer_, message.getText());
+
+      Entry entry;
+      entry.sequence = message.getSequence();
+      entry.time = message.getTime();
+      entry.sender = message.getSenderId();
+      entry.offset = writeEnd_;
+      entry.size = sizeof(Message) + message.getNameFrom().size() + message.getText().size();
+      entry.length = getRecordLength(message);
+      writeEnd_ += entry.length;
+      batch.entries.push_back(entry);
+    }
+  }
+
+  //Записи должны быть в файле до того, как индекс сошлётся на них
+  writer_.flush();
+  if (!writer_) {
+    //Часть записей могла попасть в файл - продолжить с его фактического конца
+    writer_.clear();
+    std::error_code error;
+    writeEnd_ = std::filesystem::file_size(path_, error);
+    for (auto& batch : batches) {
+      batch.entries.clear();
+    }
+    return false;
+  }
+  return true;
+}
+
+
+
+void ColdStore::commit(const std::string& login, const std::deque<Entry>& entries)
+{
+  if (entries.empty()) {
+    return;
+  }
+  auto& list = index_[login];
+  for (const auto& entry : entries) {
+    list.push_back(entry);
+    liveBytes_ += entry.length;
+    end_ = std::max(end_, entry.offset + entry.length);
+  }
+}
+
+
+
+bool ColdStore::rewrite(const std::string& path)
+{
+  Rewrite rewrite;
+  return beginRewrite(path, rewrite) && writeRewrite(rewrite) && finishRewrite(rewrite);
+}
+
+
+
+bool ColdStore::beginRewrite(const std::string& path, Rewrite& rewrite) const
+{
+  if (!file_.is_open()) {
+    return false;
+  }
+  rewrite.source = path_;
+  rewrite.path = path;
+  rewrite.index = index_;
+  rewrite.end = 0;
+  return true;
+}
+
+
+
+bool ColdStore::writeRewrite(Rewrite& rewrite)
+{
+  std::ifstream source(rewrite.source, std::ios::binary);
+  std::ofstream target(rewrite.path, std::ios::binary | std::ios::trunc);
+  if (!source.is_open() || !target.is_open()) {
+    return false;
+  }
+
+  //Записи копируются без разбора, индекс получает новые смещения
+  uint64_t end = 0;
+  std::string record;
+  for (auto& entries : rewrite.index) {
+    for (auto& entry : entries.second) {
+      record.resize(entry.length);
+      source.seekg(entry.offset);
+      source.read(&record[0], entry.length);
+      target.write(record.data(), entry.length);
+      if (!source || !target) {
+        return false;
+      }
+      entry.offset = end;
+      end += entry.length;
+    }
+  }
+  target.close();
+  if (!target) {
+    return false;
+  }
+  rewrite.end = end;
+  return true;
+}
+
+
+
+bool ColdStore::finishRewrite(Rewrite& rewrite)
+{
+  std::ifstream file(rewrite.path, std::ios::binary);
+  std::ofstream writer(rewrite.path, std::ios::binary | std::ios::app);
+  if (!file.is_open() || !writer.is_open()) {
+    return false;
+  }
+
+  //Пока файл переписывался, у пользователя могли быть забыты самые старые
+  //сообщения (trim), сообщения удалённых отправителей (purge) или все сообщения
+  //(erase) - оставить в новом индексе только записи, которые есть в текущем.
+  //Оба списка упорядочены по номерам - сравниваются одним проходом
+  uint64_t liveBytes = 0;
+  for (auto entries = rewrite.index.begin(); entries != rewrite.index.end(); ) {
+    auto current = index_.find(entries->first);
+    auto& list = entries->second;
+    if (current == index_.end()) {
+      list.clear();
+    }
+    else {
+      auto kept = current->second.begin();
+      auto out = list.begin();
+      for (auto entry = list.begin(); entry != list.end(); ++entry) {
+        while (kept != current->second.end() && kept->sequence < entry->sequence) {
+          ++kept;
+        }
+        if (kept != current->second.end() && kept->sequence == entry->sequence) {
+          *out++ = *entry;
+        }
+      }
+      list.erase(out, list.end());
+    }
+    for (const auto& entry : list) {
+      liveBytes += entry.length;
+    }
+    entries = list.empty() ? rewrite.index.erase(entries) : std::next(entries);
+  }
+
+  file_ = std::move(file);
+  writer_ = std::move(writer);
+  path_ = rewrite.path;
+  index_ = std::move(rewrite.index);
+  liveBytes_ = liveBytes;
+  end_ = rewrite.end;
+  writeEnd_ = rewrite.end;
+  return true;
+}
+
+
+
+uint64_t ColdStore::getFileBytes() const
+{
+  return end_;
+}
+
+
+
+uint64_t ColdStore::getLiveBytes() const
+{
+  return liveBytes_;
+}
+
+
+
+void ColdStore::getEntries(const std::string& login, std::deque<Entry>& entries) const
+{
+  auto found = index_.find(login);
+  if (found == index_.end()) {
+    entries.clear();
+    return;
+  }
+  entries = found->second;
+}
+
+
+
+void ColdStore::restore(const std::string& login, std::deque<Entry> entries)
+{
+  erase(login);
+  if (entries.empty()) {
+    return;
+  }
+  for (const auto& entry : entries) {
+    liveBytes_ += entry.length;
+  }
+  index_[login] = std::move(entries);
+}
+
+
+
+void ColdStore::load(const std::string& login, uint64_t first, uint64_t last,
+                     std::list<Message>& messages)
+{
+  auto entries = index_.find(login);
+  if (entries == index_.end() || !file_.is_open()) {
+    return;
+  }
+
+  //Двоичный поиск границ диапазона - номера в индексе возрастают
+  const auto& list = entries->second;
+  auto begin = std::lower_bound(list.begin(), list.end(), first,
+    [](const Entry& entry, uint64_t sequence) { return entry.sequence < sequence; });
+  auto end = std::upper_bound(begin, list.end(), last,
+    [](uint64_t sequence, const Entry& entry) { return sequence < entry.sequence; });
+
+  //От новых к старым - в том же порядке, что и список сообщений пользователя
+  for (auto entry = std::make_reverse_iterator(end);
+       entry != std::make_reverse_iterator(begin); ++entry) {
+    file_.clear();
+    file_.seekg(entry->offset);
+    uint64_t sequence = 0;
+    int64_t time = 0;
+    uint64_t sender = 0;
+    std::string nameFrom;
+    std::string text;
+    if (!readValue(file_, sequence) || !readValue(file_, time) || !readValue(file_, sender) ||
+        !readString(file_, nameFrom) || !readString(file_, text)) {
+      return;
+    }
+    messages.emplace_back(nameFrom, text, time, sequence, sender);
+  }
+}
+
+
+
+size_t ColdStore::getCount(const std::string& login) const
+{
+  auto entries = index_.find(login);
+  if (entries == index_.end()) {
+    return 0;
+  }
+  return entries->second.size();
+}
+
+
+
+uint64_t ColdStore::getFirstSequence(const std::string& login) const
+{
+  auto entries = index_.find(login);
+  if (entries == index_.end() || entries->second.empty()) {
+    return 0;
+  }
+  return entries->second.front().sequence;
+}
+
+
+
+void ColdStore::trim(const std::string& login, size_t maxCount, size_t maxBytes,
+                     std::time_t minTime)
+{
+  auto entries = index_.find(login);
+  if (entries == index_.end()) {
+    return;
+  }
+
+  //Найти самое старое сообщение, которое нужно оставить - идти от новых к старым
+  auto& list = entries->second;
+  size_t count = 0;
+  size_t bytes = 0;
+  size_t keep = 0;
+  for (auto entry = list.rbegin(); entry != list.rend(); ++entry) {
+    ++count;
+    bytes += entry->size;
+    if ((maxCount != 0 && count > maxCount) ||
+        (maxBytes != 0 && bytes > maxBytes) ||
+        entry->time < minTime) {
+      break;
+    }
+    ++keep;
+  }
+
+  for (auto entry = list.begin(); entry != list.end() - keep; ++entry) {
+    liveBytes_ -= entry->length;
+  }
+  list.erase(list.begin(), list.end() - keep);
+  if (list.empty()) {
+    index_.erase(entries);
+  }
+}
+
+
+
+void ColdStore::erase(const std::string& login)
+{
+  auto entries = index_.find(login);
+  if (entries == index_.end()) {
+    return;
+  }
+  for (const auto& entry : entries->second) {
+    liveBytes_ -= entry.length;
+  }
+  index_.erase(entries);
+}
+
+
+
+size_t ColdStore::purge(const std::string& login, const std::unordered_set<uint64_t>& senders)
+{
+  auto entries = index_.find(login);
+  if (entries == index_.end()) {
+    return 0;
+  }
+
+  //Записи остаются в файле до перезаписи - забываются только в индексе
+  auto& list = entries->second;
+  auto out = list.begin();
+  for (auto entry = list.begin(); entry != list.end(); ++entry) {
+    if (senders.count(entry->sender) != 0) {
+      liveBytes_ -= entry->length;
+    }
+    else {
+      *out++ = *entry;
+    }
+  }
+  const size_t count = list.end() - out;
+  list.erase(out, list.end());
+  if (list.empty()) {
+    index_.erase(entries);
+  }
+  return count;
+}
+
+
+
+void ColdStore::clear()
+{
+  index_.clear();
+  liveBytes_ = 0;
+}
+
+
+
+template <typename T>
+static void writeValue(std::ostream& stream, T value)
+{
+  stream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+
+
+template <typename T>
+static bool readValue(std::istream& stream, T& value)
+{
+  stream.read(reinterpret_cast<char*>(&value), sizeof(value));
+  return static_cast<bool>(stream);
+}
+
+
+
+static void writeString(std::ostream& stream, const std::string& value)
+{
+  writeValue<uint32_t>(stream, value.size());
+  stream.write(value.data(), value.size());
+}
+
+
+
+static uint32_t getRecordLength(const Message& message)
+{
+  //Номер, время, отправитель и две строки с длиной
+  return 2 * sizeof(uint64_t) + sizeof(int64_t) + 2 * sizeof(uint32_t) +
+         message.getNameFrom().size() + message.getText().size();
+}
+
+
+
+static bool readString(std::istream& stream, std::string& value)
+{
+  uint32_t length = 0;
+  if (!readValue(stream, length)) {
+    return false;
+  }
+  value.resize(length);
+  stream.read(&value[0], length);
+  return static_cast<bool>(stream);
+}
+
+
+
+//========================================================================================================
+void cold_store::test()
+{
+  //Файлы теста - в каталоге с уникальным именем
+  std::string directory =
+    (std::filesystem::temp_directory_path() / "chat_cold_store_XXXXXX").string();
+  assert(mkdtemp(&directory[0]) != nullptr);
+  const std::string path = directory + "/cold_store";
+  const std::string rewritePath = directory + "/cold_store_rewrite";
+  ColdStore store;
+  assert(store.isOpen() == false);
+  assert(store.append("login", Message("name", "text", 0, 1)) == false);
+  assert(store.open(path) == true);
+
+  //Сообщения двух пользователей вперемешку
+  for (uint64_t sequence = 1; sequence <= 10; ++sequence) {
+    const std::time_t time = 100 + sequence;
+    assert(store.append("login_1", Message("name", std::to_string(sequence), time, sequence)));
+    assert(store.append("login_2", Message("name", "other", time, sequence)));
+  }
+  assert(store.getCount("login_1") == 10);
+  assert(store.getCount("not_exist") == 0);
+  assert(store.getFirstSequence("login_1") == 1);
+  assert(store.getFirstSequence("not_exist") == 0);
+
+  //Диапазон - от новых к старым
+  std::list<Message> messages;
+  store.load("login_1", 3, 5, messages);
+  assert(messages.size() == 3);
+  assert(messages.front().getText() == "5");
+  assert(messages.front().getSequence() == 5);
+  assert(messages.front().getTime() == 105);
+  assert(messages.back().getText() == "3");
+
+  //Оставить 4 новых сообщения, затем - не старше 108
+  store.trim("login_1", 4, 0, 0);
+  assert(store.getCount("login_1") == 4);
+  store.trim("login_1", 0, 0, 108);
+  assert(store.getCount("login_1") == 3);
+  messages.clear();
+  store.load("login_1", 0, UINT64_MAX, messages);
+  assert(messages.size() == 3);
+  assert(messages.back().getText() == "8");
+
+  //Сообщения другого пользователя не затронуты
+  std::deque<ColdStore::Entry> entries;
+  store.getEntries("login_1", entries);
+  assert(entries.size() == 3);
+  store.erase("login_1");
+  assert(store.getCount("login_1") == 0);
+  assert(store.getCount("login_2") == 10);
+
+  //Забытые записи остаются в файле до перезаписи
+  const uint64_t fileBytes = store.getFileBytes();
+  assert(store.getLiveBytes() < fileBytes);
+  assert(store.rewrite(rewritePath) == true);
+  assert(store.getPath() == rewritePath);
+  assert(store.getFileBytes() == store.getLiveBytes());
+  messages.clear();
+  store.load("login_2", 10, 10, messages);
+  assert(messages.size() == 1);
+  assert(messages.front().getSequence() == 10);
+
+  //Записанный пакет не виден, пока записи не внесены в индекс
+  std::vector<ColdStore::Batch> batches(1);
+  batches.front().login = "login_2";
+  batches.front().messages.emplace_back("name", "removed", 200, 11, 5);
+  batches.front().messages.emplace_back("name", "batch", 200, 12);
+  assert(store.write(batches) == true);
+  assert(batches.front().entries.size() == 2);
+  assert(store.getCount("login_2") == 10);
+  store.commit("login_2", batches.front().entries);
+  messages.clear();
+  store.load("login_2", 11, 12, messages);
+  assert(messages.size() == 2);
+  assert(messages.front().getText() == "batch");
+  assert(messages.back().getSenderId() == 5);
+
+  //Сообщения, забытые во время перезаписи (в том числе из середины списка
+  //при удалении отправителя), не возвращаются в новый индекс
+  ColdStore::Rewrite rewrite;
+  assert(store.beginRewrite(rewritePath + "_2", rewrite) == true);
+  assert(ColdStore::writeRewrite(rewrite) == true);
+  assert(store.purge("login_2", {5}) == 1);
+  assert(store.purge("login_2", {5}) == 0);
+  store.trim("login_2", 2, 0, 0);
+  assert(store.finishRewrite(rewrite) == true);
+  assert(store.getCount("login_2") == 2);
+  assert(store.getFirstSequence("login_2") == 10);
+  assert(store.getLiveBytes() < store.getFileBytes());
+  messages.clear();
+  store.load("login_2", 0, UINT64_MAX, messages);
+  assert(messages.size() == 2);
+  assert(messages.front().getText() == "batch");
+
+  //Индекс из снимка верен для прежнего файла и после повторного открытия
+  assert(store.open(path) == true);
+  assert(store.getFileBytes() == fileBytes);
+  store.clear();
+  store.restore("login_1", entries);
+  messages.clear();
+  store.load("login_1", 0, UINT64_MAX, messages);
+  assert(messages.size() == 3);
+  assert(messages.front().getText() == "10");
+
+  //Записи за концом файла отбрасываются
+  std::ofstream(rewritePath, std::ios::binary | std::ios::trunc).close();
+  assert(store.open(rewritePath) == true);
+  assert(store.getCount("login_1") == 0);
+  assert(store.getLiveBytes() == 0);
+  store.restore("login_2", entries);
+  store.clear();
+  assert(store.getCount("login_2") == 0);
+  assert(store.getLiveBytes() == 0);
+  std::filesystem::remove_all(directory);
+}
\ No newline at end of file
@@ -0,0 +1,228 @@
+/**
+\file ColdStore.h
+\brief Класс - хранилище старых ("холодных") сообщений на диске
+Сообщения дописываются в конец одного файла, в памяти остаётся только
+индекс: для каждого пользователя - номера, время и смещения его сообщений.
+Сообщения считываются обратно по диапазону порядковых номеров.
+Записи в файле не изменяются: забытые сообщения остаются в файле, пока он не
+переписан заново (rewrite), поэтому индекс, сохранённый в снимке базы, остаётся
+верным для того же файла и после перезапуска сервера.
+
+Запись на диск отделена от изменения индекса: write и writeRewrite работают
+без блокировки Базы (из одного потока записи) и не трогают индекс, а commit
+и finishRewrite вносят результат в индекс под блокировкой. Остальные методы
+вызываются под блокировкой Базы.
+*/
+
+#pragma once
+
+#include <string>
+#include <list>
+#include <map>
+#include <deque>
+#include <vector>
+#include <unordered_set>
+#include <fstream>
+#include <ctime>
+#include <cstdint>
+
+#include "../Message/Message.h"
+
+
+class ColdStore {
+  public:
+    //Запись индекса о сообщении в файле
+    struct Entry {
+      uint64_t sequence;  ///<Порядковый номер сообщения
+      std::time_t time;   ///<Время получения сообщения
+      uint64_t sender;    ///<Номер отправителя (0 - не задан)
+      uint64_t offset;    ///<Смещение записи в файле
+      uint32_t size;      ///<Объём сообщения в памяти, байт
+      uint32_t length;    ///<Длина записи в файле, байт
+    };
+
+    //Сообщения пользователя для записи на диск вне блокировки Базы
+    struct Batch {
+      std::string login;              ///<Логин пользователя
+      std::vector<Message> messages;  ///<Сообщения от старых к новым
+      std::deque<Entry> entries;      ///<Записи индекса о них - заполняет write
+    };
+
+    //Перезапись файла вне блокировки Базы
+    struct Rewrite {
+      std::string source; ///<Путь к прежнему файлу
+      std::string path;   ///<Путь к новому файлу
+      std::map<std::string, std::deque<Entry> > index; ///<Индекс, после записи - с новыми смещениями
+      uint64_t end = 0;   ///<Длина нового файла
+    };
+
+    /**
+    Открыть хранилище. Содержимое файла сохраняется, новые записи дописываются
+    в конец. Индекс не изменяется - кроме записей за концом файла
+    \param[in] path Путь к файлу хранилища (файла нет - создаётся)
+    \return Признак успешного открытия
+    */
+    bool open(const std::string& path);
+
+    /**
+    \return Признак открытого хранилища
+    */
+    bool isOpen() const;
+
+    /**
+    \return Путь к файлу хранилища
+    */
+    const std::string& getPath() const;
+
+    /**
+    Переписать в новый файл только сообщения из индекса и продолжить работу с ним
+    Прежний файл не изменяется. При ошибке хранилище остаётся прежним
+    \param[in] path Путь к новому файлу
+    \return Признак успешной записи
+    */
+    bool rewrite(const std::string& path);
+
+    /**
+    Начать перезапись: запомнить индекс, который нужно переписать
+    \param[in] path Путь к новому файлу
+    \param[in] rewrite Результат - перезапись для writeRewrite
+    \return Признак открытого хранилища
+    */
+    bool beginRewrite(const std::string& path, Rewrite& rewrite) const;
+
+    /**
+    Скопировать записи индекса перезаписи в новый файл (без блокировки Базы)
+    Между beginRewrite и finishRewrite нельзя вызывать write
+    \param[in] rewrite Перезапись - получает новые смещения
+    \return Признак успешной записи
+    */
+    static bool writeRewrite(Rewrite& rewrite);
+
+    /**
+    Переключиться на новый файл. Сообщения, забытые после beginRewrite
+    (trim, erase, purge), остаются забытыми и в новом индексе
+    \param[in] rewrite Записанная перезапись
+    \return Признак успешного открытия нового файла
+    */
+    bool finishRewrite(Rewrite& rewrite);
+
+    /**
+    \return Длина файла хранилища до конца записей, известных индексу, байт
+    */
+    uint64_t getFileBytes() const;
+
+    /**
+    \return Длина записей файла, на которые ссылается индекс, байт
+    */
+    uint64_t getLiveBytes() const;
+
+    /**
+    Загрузить записи индекса пользователя (для сохранения в снимок)
+    \param[in] login Логин пользователя
+    \param[in] entries Результат - записи от старых к новым
+    */
+    void getEntries(const std::string& login, std::deque<Entry>& entries) const;
+
+    /**
+    Восстановить записи индекса пользователя (из снимка)
+    \param[in] login Логин пользователя
+    \param[in] entries Записи от старых к новым
+    */
+    void restore(const std::string& login, std::deque<Entry> entries);
+
+    /**
+    Дописать сообщение пользователю в хранилище (write и commit одного сообщения)
+    Сообщения пользователя должны поступать в порядке возрастания номеров
+    \param[in] login Логин пользователя
+    \param[in] message Сообщение
+    \return Признак успешной записи
+    */
+    bool append(const std::string& login, const Message& message);
+
+    /**
+    Дописать сообщения в конец файла, не изменяя индекс (без блокировки Базы,
+    только из одного потока записи). Записи сбрасываются на диск до возврата
+    \param[in] batches Пакеты сообщений - получают записи индекса
+    \return Признак успешной записи всех пакетов
+    */
+    bool write(std::vector<Batch>& batches);
+
+    /**
+    Внести в индекс записи, сделанные write
+    Номера должны быть больше номеров сообщений пользователя в хранилище
+    \param[in] login Логин пользователя
+    \param[in] entries Записи индекса от старых к новым
+    */
+    void commit(const std::string& login, const std::deque<Entry>& entries);
+
+    /**
+    Загрузить сообщения пользователя с номерами из диапазона [first, last]
+    Сообщения добавляются в конец списка от новых к старым
+    \param[in] login Логин пользователя
+    \param[in] first Номер первого сообщения диапазона
+    \param[in] last Номер последнего сообщения диапазона
+    \param[in] messages Список в который поместить сообщения
+    */
+    void load(const std::string& login, uint64_t first, uint64_t last,
+              std::list<Message>& messages);
+
+    /**
+    \param[in] login Логин пользователя
+    \return Количество сообщений пользователя в хранилище
+    */
+    size_t getCount(const std::string& login) const;
+
+    /**
+    \param[in] login Логин пользователя
+    \return Номер самого старого сообщения пользователя в хранилище (0 - сообщений нет)
+    */
+    uint64_t getFirstSequence(const std::string& login) const;
+
+    /**
+    Оставить в хранилище только новые сообщения пользователя
+    Значение ограничения 0 - ограничение не действует
+    \param[in] login Логин пользователя
+    \param[in] maxCount Максимальное количество сообщений
+    \param[in] maxBytes Максимальный объём сообщений, байт
+    \param[in] minTime Время самого старого сообщения, которое нужно оставить
+    */
+    void trim(const std::string& login, size_t maxCount, size_t maxBytes,
+              std::time_t minTime);
+
+    /**
+    Забыть все сообщения пользователя
+    \param[in] login Логин пользователя
+    */
+    void erase(const std::string& login);
+
+    /**
+    Забыть сообщения пользователю от заданных отправителей (удалённых пользователей)
+    \param[in] login Логин пользователя
+    \param[in] senders Номера отправителей
+    \return Количество забытых сообщений
+    */
+    size_t purge(const std::string& login, const std::unordered_set<uint64_t>& senders);
+
+    /**
+    Забыть сообщения всех пользователей
+    */
+    void clear();
+
+  private:
+    std::ifstream file_;  ///<Файл хранилища для чтения
+    std::ofstream writer_;  ///<Файл хранилища для записи (только поток записи)
+    std::string path_;    ///<Путь к файлу хранилища
+    uint64_t end_ = 0;    ///<Смещение конца записей, известных индексу
+    uint64_t writeEnd_ = 0; ///<Смещение конца файла (только поток записи)
+    uint64_t liveBytes_ = 0;  ///<Длина записей, на которые ссылается индекс
+    std::map<std::string, std::deque<Entry> > index_; ///<Индекс по Логину, от старых к новым
+};
+
+
+
+namespace cold_store {
+  /**
+  Запустить тестирование методов класса
+  */
+  void test();
+}
\ No newline at end of file
@@ -0,0 +1,123 @@
+#include "Compactor.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#include "../DataBase/DataBase.h"
+
+
+namespace{
+  //Количество пользователей, обрабатываемых за одну блокировку Базы
+  const size_t BATCH_USERS = 256;
+
+  std::thread worker;
+  std::mutex mutex;
+  std::condition_variable wakeUp;
+  bool isRunning = false;
+
+  std::atomic<uint64_t> reclaimedBytes(0);  //Метрика - освобождено байт
+
+  //Снимок Базы
+  std::string snapshotDirectory;  //Каталог снимка (пустой - не сохранять)
+  size_t snapshotSegments = 1;    //Количество сегментов снимка
+  std::chrono::seconds snapshotInterval(0); //Наименьший период между снимками
+}
+
+
+
+void compactor::start(std::chrono::milliseconds interval)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  //Уже запущен
+  if (isRunning){
+    return;
+  }
+  isRunning = true;
+
+  worker = std::thread([interval]() {
+    auto lastSnapshot = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(mutex);
+    while (isRunning){
+      //Ждать окончания периода или команды остановки
+      if (wakeUp.wait_for(lock, interval, []() { return !isRunning; })){
+        break;
+      }
+      const std::string directory = snapshotDirectory;
+      const size_t segments = snapshotSegments;
+      const auto period = snapshotInterval;
+      lock.unlock();
+      const uint64_t bytes = runOnce();
+      if (bytes != 0){
+        std::cout << "Compactor: reclaimed " << bytes << " bytes (total "
+                  << getReclaimedBytes() << ")" << std::endl;
+      }
+      //Снимок пишется в этом потоке - поток запросов ждёт только копию данных
+      const auto now = std::chrono::steady_clock::now();
+      if (!directory.empty() && now - lastSnapshot >= period){
+        lastSnapshot = now;
+        if (!database::save(directory, segments)){
+          std::cerr << "Compactor: unable to save snapshot " << directory << std::endl;
+        }
+      }
+      lock.lock();
+    }
+  });
+}
+
+
+
+void compactor::setSnapshot(const std::string& directory, size_t segments,
+                            std::chrono::seconds interval)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  snapshotDirectory = directory;
+  snapshotSegments = segments;
+  snapshotInterval = interval;
+}
+
+
+
+void compactor::stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    isRunning = false;
+  }
+  wakeUp.notify_all();
+  if (worker.joinable()){
+    worker.join();
+  }
+}
+
+
+
+uint64_t compactor::runOnce()
+{
+  uint64_t bytes = 0;
+  do {
+    //Отделить сообщения под блокировкой Базы, освободить - без неё
+    database::Garbage garbage;
+    bytes += database::compact(garbage, BATCH_USERS);
+    garbage.lists.clear();
+  } while (!database::isCompactionFinished());
+
+  //Память удалённых пользователей
+  while (!database::isReclaimFinished()){
+    database::Garbage garbage;
+    bytes += database::reclaim(garbage, BATCH_USERS);
+    garbage.lists.clear();
+  }
+
+  reclaimedBytes += bytes;
+  return bytes;
+}
+
+
+
+uint64_t compactor::getReclaimedBytes()
+{
+  return reclaimedBytes;
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+/**
+\file Compactor.h
+\brief Модуль "Уплотнитель" - фоновая задача освобождения памяти Базы данных
+Периодически проходит по Базе, отделяет сообщения сверх политики хранения
+и сообщения удалённых пользователей и освобождает их память вне блокировки Базы.
+Между проходами сохраняет снимок Базы - не чаще заданного периода
+*/
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+
+namespace compactor{
+  /**
+  Запустить фоновую задачу
+  \param[in] interval Период между проходами по Базе
+  */
+  void start(std::chrono::milliseconds interval);
+
+  /**
+  Сохранять снимок Базы в фоновой задаче
+  Время проверяется после каждого прохода, поэтому период снимков кратен периоду проходов
+  \param[in] directory Каталог снимка (пустой - не сохранять)
+  \param[in] segments Количество сегментов снимка
+  \param[in] interval Наименьший период между снимками
+  */
+  void setSnapshot(const std::string& directory, size_t segments,
+                   std::chrono::seconds interval);
+
+  /**
+  Остановить фоновую задачу и дождаться её завершения
+  */
+  void stop();
+
+  /**
+  Выполнить один полный проход по Базе в текущем потоке
+  \return Объём освобождённых сообщений, байт
+  */
+  uint64_t runOnce();
+
+  /**
+  \return Суммарный объём освобождённых сообщений с момента запуска, байт
+  */
+  uint64_t getReclaimedBytes();
+}
\ No newline at end of file
@@ -0,0 +1,187 @@
+#include "Credential.h"
+
+#include <atomic>
+#include <random>
+#include <mutex>
+#include <assert.h>
+
+
+namespace{
+  const size_t HMAC_BLOCK_BYTES = 64;       //Размер блока sha-1 для HMAC
+  const uint32_t DEFAULT_COST = 10000;      //Итераций по умолчанию
+
+  std::atomic<uint32_t> cost(DEFAULT_COST);
+
+  //Источник соли - общий для потоков пула проверки паролей
+  std::mutex generatorMutex;
+  std::mt19937_64 generator{std::random_device{}()};
+}
+
+
+//Заполнить соль случайными байтами
+static void makeSalt(std::array<uint8_t, credential::SALT_SIZE>& salt);
+
+//Байты массива как строка без копирования
+template <size_t SIZE>
+static std::string_view asString(const std::array<uint8_t, SIZE>& bytes);
+
+
+
+void credential::setCost(uint32_t iterations)
+{
+  cost = (iterations == 0) ? 1 : iterations;
+}
+
+
+
+uint32_t credential::getCost()
+{
+  return cost;
+}
+
+
+
+credential::Record credential::make(const sha_1::Digest& passwordHash)
+{
+  Record record;
+  record.iterations = cost;
+  makeSalt(record.salt);
+  record.key = derive(asString(passwordHash), asString(record.salt), record.iterations);
+  return record;
+}
+
+
+
+bool credential::verify(const Record& stored, const sha_1::Digest& passwordHash)
+{
+  //Учётные данные не заданы
+  if (stored.iterations == 0) {
+    return false;
+  }
+  return isEqual(derive(asString(passwordHash), asString(stored.salt), stored.iterations),
+                 stored.key);
+}
+
+
+
+bool credential::isEqual(const sha_1::Digest& first, const sha_1::Digest& second)
+{
+  //Без раннего выхода: различия всех байт накапливаются, сравнивается итог
+  uint8_t difference = 0;
+  for (size_t i = 0; i < first.size(); ++i) {
+    difference |= first[i] ^ second[i];
+  }
+  return difference == 0;
+}
+
+
+
+sha_1::Digest credential::derive(std::string_view password, std::string_view salt,
+                                 uint32_t iterations)
+{
+  //Ключ HMAC - пароль, дополненный нулями до блока (длинный пароль - его хэш)
+  uint8_t key[HMAC_BLOCK_BYTES] = {};
+  if (password.size() > HMAC_BLOCK_BYTES) {
+    sha_1::Hasher hasher;
+    hasher.update(password.data(), password.size());
+    const sha_1::Digest digest = hasher.finish();
+    std::copy(digest.begin(), digest.end(), key);
+  } else {
+    std::copy(password.begin(), password.end(), key);
+  }
+
+  //Первый блок внутреннего и внешнего хэша HMAC не зависит от данных -
+  //состояние после него считается один раз и копируется на каждой итерации
+  uint8_t pad[HMAC_BLOCK_BYTES];
+  sha_1::Hasher inner;
+  sha_1::Hasher outer;
+  for (size_t i = 0; i < HMAC_BLOCK_BYTES; ++i) {
+    pad[i] = key[i] ^ 0x36;
+  }
+  inner.update(pad, HMAC_BLOCK_BYTES);
+  for (size_t i = 0; i < HMAC_BLOCK_BYTES; ++i) {
+    pad[i] = key[i] ^ 0x5c;
+  }
+  outer.update(pad, HMAC_BLOCK_BYTES);
+
+  const auto finish = [&outer](sha_1::Hasher& hasher) {
+    const sha_1::Digest innerDigest = hasher.finish();
+    hasher = outer;
+    hasher.update(innerDigest.data(), innerDigest.size());
+    return hasher.finish();
+  };
+
+  //U1 = HMAC(соль || номер блока 1), Ui = HMAC(Ui-1), ключ = U1 ^ U2 ^ ...
+  const uint8_t blockIndex[] = {0, 0, 0, 1};
+  sha_1::Hasher hasher = inner;
+  hasher.update(salt.data(), salt.size());
+  hasher.update(blockIndex, sizeof(blockIndex));
+  sha_1::Digest u = finish(hasher);
+  sha_1::Digest result = u;
+  for (uint32_t i = 1; i < iterations; ++i) {
+    hasher = inner;
+    hasher.update(u.data(), u.size());
+    u = finish(hasher);
+    for (size_t j = 0; j < result.size(); ++j) {
+      result[j] ^= u[j];
+    }
+  }
+  return result;
+}
+
+
+
+static void makeSalt(std::array<uint8_t, credential::SALT_SIZE>& salt)
+{
+  std::lock_guard<std::mutex> lock(generatorMutex);
+  for (size_t i = 0; i < salt.size(); i += sizeof(uint64_t)) {
+    const uint64_t value = generator();
+    for (size_t j = 0; j < sizeof(uint64_t) && i + j < salt.size(); ++j) {
+      salt[i + j] = static_cast<uint8_t>(value >> (8 * j));
+    }
+  }
+}
+
+
+
+template <size_t SIZE>
+static std::string_view asString(const std::array<uint8_t, SIZE>& bytes)
+{
+  return std::string_view(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+}
+
+
+
+void credential::test()
+{
+  //Эталонные значения RFC 6070
+  assert(sha_1::toHex(derive("password", "salt", 1)) == "0c60c80f961f0e71f3a9b524af6012062fe037a6");
+  assert(sha_1::toHex(derive("password", "salt", 2)) == "ea6c014dc72d6f8ccd1ed92ace1d41f0d8de8957");
+  assert(sha_1::toHex(derive("password", "salt", 4096)) == "4b007901b765489abead49d926f721d065a429c1");
+  assert(sha_1::toHex(derive("passwordPASSWORDpassword", "saltSALTsaltSALTsaltSALTsaltSALTsalt", 4096)) ==
+         "3d2eec4fe41c849b80c8d83662c0e44a8b291a96");
+
+  //Запись проверяется своей стоимостью, даже если стоимость новых записей изменилась
+  const uint32_t previousCost = getCost();
+  setCost(3);
+  const sha_1::Digest hash = sha_1::digest("password");
+  const Record stored = make(hash);
+  assert(stored.iterations == 3);
+  setCost(5);
+  assert(verify(stored, hash) == true);
+  assert(verify(stored, sha_1::digest("incorrect_password")) == false);
+
+  //Соль случайная - записи одного пароля различаются
+  assert(make(hash).salt != make(hash).salt);
+
+  //Пустая запись не подходит ни к какому паролю
+  assert(verify(Record(), hash) == false);
+  assert(verify(Record(), sha_1::Digest()) == false);
+
+  //Сравнение хэшей
+  sha_1::Digest other = hash;
+  assert(isEqual(hash, other) == true);
+  other[other.size() - 1] ^= 1;
+  assert(isEqual(hash, other) == false);
+  setCost(previousCost);
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+/**
+\file Credential.h
+\brief Модуль "Учётные данные" - хранимая проверка пароля
+Сервер хранит не хэш пароля, присланный клиентом, а ключ, выведенный из него
+PBKDF2-HMAC-SHA1 со случайной солью и заданным количеством итераций (стоимостью).
+Запись хранит свою стоимость, поэтому смена стоимости не ломает старые записи.
+Запись фиксированного размера хранится прямо в данных пользователя, ключи
+сравниваются за время, не зависящее от совпадающих байт.
+*/
+
+#pragma once
+
+#include <array>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+
+#include "../SHA_1/SHA_1_Wrapper.h"
+
+
+namespace credential{
+  //Размер соли, байт
+  const size_t SALT_SIZE = 16;
+
+  /**
+  Запись учётных данных
+  */
+  struct Record {
+    uint32_t iterations = 0;                ///<Количество итераций (0 - учётных данных нет)
+    std::array<uint8_t, SALT_SIZE> salt{};  ///<Соль
+    sha_1::Digest key{};                    ///<Ключ, выведенный из хэша пароля
+  };
+
+  /**
+  Задать стоимость (количество итераций) для новых записей
+  \param[in] iterations Количество итераций
+  */
+  void setCost(uint32_t iterations);
+
+  /**
+  \return Стоимость новых записей
+  */
+  uint32_t getCost();
+
+  /**
+  Создать запись для хранения
+  \param[in] passwordHash Хэш пароля, присланный клиентом
+  \return Запись со случайной солью и текущей стоимостью
+  */
+  Record make(const sha_1::Digest& passwordHash);
+
+  /**
+  Проверить хэш пароля по записи
+  \param[in] stored Запись из Базы
+  \param[in] passwordHash Хэш пароля, присланный клиентом
+  \return Признак правильный ли Пароль (для пустой записи - false)
+  */
+  bool verify(const Record& stored, const sha_1::Digest& passwordHash);
+
+  /**
+  Сравнить хэши за время, не зависящее от их содержимого
+  \param[in] first Первый хэш
+  \param[in] second Второй хэш
+  \return Признак равенства
+  */
+  bool isEqual(const sha_1::Digest& first, const sha_1::Digest& second);
+
+  /**
+  Вывести ключ PBKDF2-HMAC-SHA1 (длина ключа - 20 байт)
+  \param[in] password Пароль
+  \param[in] salt Соль
+  \param[in] iterations Количество итераций
+  \return Ключ
+  */
+  sha_1::Digest derive(std::string_view password, std::string_view salt, uint32_t iterations);
+
+  /**
+  Запустить тестирование функций модуля
+  */
+  void test();
+}
\ No newline at end of file
@@ -1,460 +1,3609 @@
-#include "DataBase.h"
-
-#include <map>
-#include <list>
-#include <assert.h>
-#include <iostream>
-
-#include "../User/User.h"
-#include "../SHA_1/SHA_1_Wrapper.h"
-
-
-namespace {
-	//Имя адресата чтобы отправить сообщение всем
-	const std::string MSG_TO_ALL = "all";
-
-	/*
-	Хэш таблица данных пользователей
-	Ключ 	 - Логин пользователя
-	Значение - Пользователь
-	*/
-	std::map <std::string, User> userData;
-}
-
-
-
-void database::initialize()
-{
-	database::addUser("G", "Ger", sha_1::hash("123"));
-	database::addUser("S", "Sve", sha_1::hash("qwe"));
-}
-
-
-
-bool database::isLoginRegistered(const std::string& login)
-{
-	//Логина нет в базе
-	if (userData.find(login) == userData.end()) {
-		return false;
-	}
-	return true;
-}
-
-
-
-bool database::isNicknameRegistered(const std::string& name)
-{
-	for (const auto& dataPair : userData) {
-		if (dataPair.second.getName() == name) {
-			return true;
-		}
-	}
-	return false;
-}
-
-
-
-bool database::isPasswordRight(const std::string& login,
-  const std::string& passwordHash)
-{
-	//Пользователь не зарегистрирован
-	if (!isLoginRegistered(login)) {
-		return false;
-	}
-
-	//Хэш пароля совпадает с хэшем пароля в базе
-	if (passwordHash == userData[login].getHashPassword()) {
-		return true;
-	}
-
-	return false;
-}
-
-
-
-static std::string getLoginByName(const std::string& name);
-
-void database::pushMessage(const std::string& nameAdressee,
-	const Message& message)
-{
-	//Сообщение для всех
-	if (nameAdressee == MSG_TO_ALL) {
-		//Каждому пользователю в базе отправить сообщение
-		for (auto& dataPair : userData) {
-			dataPair.second.setMessage(message);
-		}
-	}
-
-	//Сообщение личное
-	else {
-		//Пользователь не зарегистрирован
-		if (!isNicknameRegistered(nameAdressee)) {
-			return;
-		}
-		userData[getLoginByName(nameAdressee)].setMessage(message);
-	}
-}
-
-
-
-void database::loadMessages(const std::string& login, std::shared_ptr<std::list<Message> >& messages)
-{
-	//Пользователь не зарегистрирован
-	if (!isLoginRegistered(login)) {
-		return;
-	}
-
-	messages->clear();
-	messages = userData[login].getMessageList();
-}
-
-
-void database::removeUser(const std::string& login)
-{
-	userData.erase(login);
-}
-
-
-
-std::string database::getNickname(const std::string& login)
-{
-	//Логина нет в базе
-	if (!database::isLoginRegistered(login)) {
-		return "";
-	}
-	return userData.find(login)->second.getName();
-}
-
-
-
-size_t database::getNumberUsers()
-{
-	return userData.size();
-}
-
-
-
-void database::loadUserNames(std::shared_ptr<std::vector<std::string> > userNames)
-{
-	userNames->clear();
-	for (const auto& dataPair : userData) {
-		userNames->push_back(dataPair.second.getName());
-	}
-}
-
-
-
-void database::addUser(const std::string& name,
-	const std::string& login,
-	const std::string& passwordHash)
-{
-	//Пользователь уже есть в базе
-	if (userData.find(login) != userData.end()) {
-		return;
-	}
-	//Данные пользователя не введены
-	if (name.empty() || login.empty() || passwordHash.empty()) {
-		return;
-	}
-
-	//Создать в базе пару Логин-Пользователь
-	userData.emplace(std::make_pair(login,
-																	User(name, login, passwordHash)));
-}
-
-
-
-//-----------------------------------------------------------------------------
-static std::string getLoginByName(const std::string& name)
-{
-	//Пользователь не зарегистрирован
-	if (!database::isNicknameRegistered(name)) {
-		return "";
-	}
-
-	for (const auto& dataPair : userData) {
-		if (dataPair.second.getName() == name) {
-			return dataPair.second.getLogin();
-		}
-	}
-	return "";
-}
-
-
-
-//=============================================================================
-static void testIsExistLogin();
-static void testIsExistName();
-static void testIsCorrectPassword();
-static void testPushMessage();
-static void testLoadMessages();
-static void testRemoveUser();
-static void testGetNameByLogin();
-static void testGetLoginByName();
-static void testGetNumberUser();
-static void testLoadUserNames();
-
-
-void database::test()
-{
-	testIsExistLogin();
-	testIsExistName();
-	testIsCorrectPassword();
-	testPushMessage();
-	testLoadMessages();
-	testRemoveUser();
-	testGetNameByLogin();
-	testGetLoginByName();
-	testGetNumberUser();
-	testLoadUserNames();
-
-	//После тестов база должна быть пуста
-	assert(userData.empty() == true);
-}
-
-
-
-static void testIsExistLogin()
-{
-	//Поместить тестовое значение
-	const std::string login = "login";
-	database::addUser("name", login, sha_1::hash("password"));
-
-	assert(database::isLoginRegistered(login) == true);
-	assert(database::isLoginRegistered("incorrect_login") == false);
-
-	//Очистить от тестовых значений
-	userData.clear();
-}
-
-
-
-static void testIsExistName()
-{
-	//Поместить тестовое значение
-	const std::string name = "name";
-	database::addUser(name, "login", sha_1::hash("password"));
-
-	assert(database::isNicknameRegistered(name) == true);
-	assert(database::isNicknameRegistered("incorrect_name") == false);
-
-	//Очистить от тестовых значений
-	userData.clear();
-}
-
-
-
-static void testIsCorrectPassword()
-{
-	//Поместить тестовое значение
-	const std::string login = "login";
-	const std::string password = "password";
-	database::addUser("name", login, sha_1::hash(password));
-
-	assert(database::isPasswordRight(login, sha_1::hash(password)) == true);
-	assert(database::isPasswordRight(login, sha_1::hash("incorrect_password")) == false);
-	assert(database::isPasswordRight("incorrect_login", sha_1::hash(password)) == false);
-
-	//Очистить от тестовых значений
-	userData.clear();
-}
-
-
-
-static void testPushMessage()
-{
-	//Поместить тестовое значение
-	User user_1("name_1", "login_1", "1");
-	User user_2("name_2", "login_2", "1");
-	User user_3("name_3", "login_3", "1");
-
-	database::addUser(user_1.getName(), user_1.getLogin(), "1");
-	database::addUser(user_2.getName(), user_2.getLogin(), "1");
-	database::addUser(user_3.getName(), user_3.getLogin(), "1");
-
-	//Собщение User_1 -> User_2
-	const std::string nameFromUser = user_1.getName();
-	const std::string nameToUser = user_2.getName();
-	const std::string textToUser = "Hello " + nameToUser;
-	database::pushMessage(nameToUser, Message(nameFromUser, textToUser));
-
-	//Собщение User_2 -> ALL
-	const std::string nameFromToAll = user_2.getName();
-	const std::string nameToAll = MSG_TO_ALL;
-	const std::string textToAll = "Hello ALL";
-	database::pushMessage(nameToAll, Message(nameFromToAll, textToAll));
-
-	assert(userData[user_1.getLogin()].getMessageList()->back().getNameFrom() == nameFromToAll);
-	assert(userData[user_1.getLogin()].getMessageList()->back().getText() == textToAll);
-	assert(userData[user_1.getLogin()].getMessageList()->size() == 1);
-
-	assert(userData[user_2.getLogin()].getMessageList()->back().getNameFrom() == nameFromUser);
-	assert(userData[user_2.getLogin()].getMessageList()->back().getText() == textToUser);
-	assert(userData[user_2.getLogin()].getMessageList()->front().getNameFrom() == nameFromToAll);
-	assert(userData[user_2.getLogin()].getMessageList()->front().getText() == textToAll);
-	assert(userData[user_2.getLogin()].getMessageList()->size() == 2);
-
-	assert(userData[user_3.getLogin()].getMessageList()->back().getNameFrom() == nameFromToAll);
-	assert(userData[user_3.getLogin()].getMessageList()->back().getText() == textToAll);
-	assert(userData[user_3.getLogin()].getMessageList()->size() == 1);
-
-	//Очистить от тестовых значений
-	userData.clear();
-}
-
-
-
-static void testLoadMessages()
-{
-	//Поместить тестовое значение
-	User user_1("name_1", "login_1", "1");
-	User user_2("name_2", "login_2", "1");
-	User user_3("name_3", "login_3", "1");
-
-	database::addUser(user_1.getName(), user_1.getLogin(), "1");
-	database::addUser(user_2.getName(), user_2.getLogin(), "1");
-	database::addUser(user_3.getName(), user_3.getLogin(), "1");
-
-	//Собщение User_1 -> User_2
-	const std::string nameFromUser = user_1.getName();
-	const std::string nameToUser = user_2.getName();
-	const std::string textToUser = "Hello " + nameToUser;
-	database::pushMessage(nameToUser, Message(nameFromUser, textToUser));
-
-	//Собщение User_2 -> ALL
-	const std::string nameFromToAll = user_2.getName();
-	const std::string nameToAll = MSG_TO_ALL;
-	const std::string textToAll = "Hello ALL";
-	database::pushMessage(nameToAll, Message(nameFromToAll, textToAll));
-
-	//Укзатель на сообщения конкретному пользователю
-	auto messagesToUser_1 = std::make_shared<std::list<Message> >();
-	auto messagesToUser_2 = std::make_shared<std::list<Message> >();
-	auto messagesToUser_3 = std::make_shared<std::list<Message> >();
-	database::loadMessages(user_1.getLogin(), messagesToUser_1);
-	database::loadMessages(user_2.getLogin(), messagesToUser_2);
-	database::loadMessages(user_3.getLogin(), messagesToUser_3);
-
-	assert(messagesToUser_1->back().getNameFrom() == nameFromToAll);
-	assert(messagesToUser_1->back().getText() == textToAll);
-	assert(messagesToUser_1->size() == 1);
-
-	assert(messagesToUser_2->back().getNameFrom() == nameFromUser);
-	assert(messagesToUser_2->back().getText() == textToUser);
-	assert(messagesToUser_2->front().getNameFrom() == nameFromToAll);
-	assert(messagesToUser_2->front().getText() == textToAll);
-	assert(messagesToUser_2->size() == 2);
-
-	assert(messagesToUser_3->back().getNameFrom() == nameFromToAll);
-	assert(messagesToUser_3->back().getText() == textToAll);
-	assert(messagesToUser_3->size() == 1);
-
-	//Очистить от тестовых значений
-	userData.clear();
-}
-
-
-
-static void testRemoveUser()
-{
-	//Поместить тестовое значение
-	const std::string name = "name";
-	const std::string login = "login";
-	const std::string password = "password";
-	database::addUser(name, login, sha_1::hash(password));
-
-	database::removeUser(login);
-
-	assert(userData.empty() == true);
-	assert(database::isNicknameRegistered(name) == false);
-	assert(database::isLoginRegistered(login) == false);
-	assert(database::isPasswordRight(login, password) == false);
-
-	//Очистить от тестовых значений
-	userData.clear();
-}
-
-
-
-static void testGetNameByLogin()
-{
-	//Поместить тестовое значение
-	const std::string name = "name";
-	const std::string login = "login";
-	const std::string password = "password";
-	database::addUser(name, login, sha_1::hash(password));
-
-	assert(database::getNickname(login) == name);
-	assert(database::getNickname("Not_Exist") == "");
-
-	//Очистить от тестовых значений
-	userData.clear();
-}
-
-
-static void testGetLoginByName()
-{
-	//Поместить тестовое значение
-	const std::string name = "name";
-	const std::string login = "login";
-	const std::string password = "password";
-	database::addUser(name, login, sha_1::hash(password));
-
-	assert(getLoginByName(name) == login);
-	assert(getLoginByName("Not_Exist") == "");
-
-	//Очистить от тестовых значений
-	userData.clear();
-}
-
-
-
-static void testGetNumberUser()
-{
-	//Поместить тестовое значение
-	std::string name = "name_1";
-	std::string login = "login_1";
-	std::string password = "password_1";
-	database::addUser(name, login, password);
-
-	assert(database::getNumberUsers() == 1);
-
-	//Поместить тестовое значение
-	name = "name_2";
-	login = "login_2";
-	password = "password_2";
-	database::addUser(name, login, password);
-
-	assert(database::getNumberUsers() == 2);
-
-	//Очистить от тестовых значений
-	userData.clear();
-}
-
-
-
-static void testLoadUserNames()
-{
-	//Поместить тестовое значение
-	const std::string name_1 = "name_1";
-	const std::string login_1 = "login_1";
-	const std::string password_1 = "password_1";
-
-	const std::string name_2 = "name_2";
-	const std::string login_2 = "login_2";
-	const std::string password_2 = "password_2";
-
-	database::addUser(name_1, login_1, password_1);
-	database::addUser(name_2, login_2, password_2);
-
-	//Укзатель на вектор сообщений конкретному пользователю
-	auto userNames = std::make_shared<std::vector<std::string> >();
-
-	database::loadUserNames(userNames);
-	assert(userNames->size() == 2);
-	assert(userNames->at(0) == name_1);
-	assert(userNames->at(1) == name_2);
-
-	//Очистить от тестовых значений
-	userData.clear();
-}
\ No newline at end of file
+#include "DataBase.h"
+
+#include <map>
+#include <list>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <set>
+#include <mutex>
+#include <thread>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <filesystem>
+#include <cstdint>
+#include <functional>
+#include <exception>
+#include <assert.h>
+#include <stdlib.h>
+#include <iostream>
+
+#include "../User/User.h"
+#include "../ColdStore/ColdStore.h"
+#include "../BloomFilter/BloomFilter.h"
+#include "../UserTable/UserTable.h"
+#include "../SHA_1/SHA_1_Wrapper.h"
+#include "../Credential/Credential.h"
+
+
+namespace {
+	//Имя адресата чтобы отправить сообщение всем
+	const std::string MSG_TO_ALL = "all";
+
+	/*
+	Хэш таблица данных пользователей
+	Ключ 	 - Логин пользователя
+	Значение - Пользователь
+	*/
+	std::map <std::string, User> userData;
+
+	/*
+	Индекс Ников
+	Ключ 	 - Ник пользователя
+	Значение - Логин пользователя
+	*/
+	std::map <std::string, std::string> nameIndex;
+
+	//Ники и указатели на пользователей по столбцам - для переборов всех пользователей
+	UserTable userTable;
+
+	/*
+	Номера пользователей в таблице по столбцам
+	Ключ 	 - Логин пользователя
+	Значение - Номер пользователя
+	*/
+	std::unordered_map<std::string, UserTable::Id> userIds;
+
+	//Номер последнего добавленного пользователя. Номера не повторяются - по ним
+	//сообщения связаны с отправителем и после смены Ника
+	uint64_t lastUserId = 0;
+
+	//Фильтры Блума по Логинам и Никам - отсекают проверки отсутствующих значений
+	//без поиска по таблицам (частый случай при массовой регистрации)
+	const size_t FILTER_HASHES = 5;	//Количество хэш-функций
+	const size_t FILTER_COUNTERS_PER_KEY = 10;	//Счётчиков на значение (доля ложных ответов ~1%)
+	const size_t FILTER_MIN_COUNTERS = 1 << 12;	//Размер фильтра пустой базы
+	BloomFilter loginFilter(FILTER_MIN_COUNTERS, FILTER_HASHES);
+	BloomFilter nameFilter(FILTER_MIN_COUNTERS, FILTER_HASHES);
+
+	//Доступ к базе из потока обработки запросов и фоновых задач
+	std::recursive_mutex mutex;
+
+	//Политика хранения сообщений для всех пользователей
+	database::Retention retention;
+
+	/*
+	Политики хранения сообщений отдельных пользователей
+	Ключ 	 - Логин пользователя
+	Значение - Политика (заменяет общую)
+	*/
+	std::map <std::string, database::Retention> userRetention;
+
+	//Логин, с которого продолжить очередной проход уплотнения
+	std::string compactionCursor;
+
+	//Хранилище старых сообщений на диске
+	ColdStore coldStore;
+	std::string coldStorePath;	//Путь к файлам хранилища без номера поколения
+	uint64_t coldGeneration = 0;	//Поколение текущего файла хранилища (из снимка)
+	//Прежние файлы хранилища - на них ссылается снимок, сохранённый до перезаписи
+	std::vector<std::string> staleColdFiles;
+	//Переписывать файл хранилища, когда забытые записи занимают больше и не меньше этого
+	const uint64_t COLD_REWRITE_MIN_BYTES = 16 * 1024 * 1024;
+	size_t hotBudget = 0;	//Допустимый объём сообщений в памяти, байт (0 - без ограничения)
+	size_t hotBytes = 0;	//Объём сообщений в памяти, байт
+
+	//Запись журнала переписки - ссылка на сообщение в списке адресата
+	//Текст в журнале не хранится: политика хранения и перенос на диск действуют
+	//на сообщения переписок так же, как на списки адресатов
+	struct ConversationEntry {
+		uint64_t sequence;	//Номер сообщения в переписке
+		uint64_t inboxSequence;	//Номер сообщения в списке адресата
+		bool isToFirst;	//Адресат - первый Логин ключа переписки (иначе второй)
+	};
+
+	//Удалённый пользователь, память которого ещё не освобождена
+	struct Tombstone {
+		std::map <std::string, User>::node_type node;	//Извлечённый из таблицы пользователь
+		std::vector<std::deque<ConversationEntry> > conversations;	//Журналы переписок пользователя
+	};
+	//Очередь удалённых пользователей
+	std::deque<Tombstone> tombstones;
+
+	//Номера удалённых пользователей, чьи сообщения вычищаются текущим проходом
+	//(номер, а не Ник: Ник мог смениться или перейти к другому пользователю)
+	std::unordered_set<uint64_t> purging;
+
+	//Логин, с которого продолжить текущий проход очистки
+	std::string purgeCursor;
+	//Пользователи пройдены - проход очистки идёт по журналам комнат
+	bool isPurgingRooms = false;
+	//Комната, с которой продолжить проход очистки по журналам комнат
+	std::string purgeRoomCursor;
+
+	//Версия списка пользователей - меняется при добавлении, удалении и смене Ника
+	//Начальное значение зависит от времени запуска - чтобы версии после перезапуска
+	//сервера были больше всех прежних и клиенты не применили к себе чужие изменения
+	uint64_t directoryVersion = static_cast<uint64_t>(std::time(nullptr)) << 20;
+
+	//Журнал последних изменений списка пользователей (от старых к новым)
+	const size_t DIRECTORY_LOG_SIZE = 4096;
+	std::deque<database::DirectoryChange> directoryLog;
+
+	//Комната - общий журнал сообщений группы пользователей
+	//Сообщение хранится в журнале один раз, участники читают его по своим курсорам
+	struct Room {
+		/*
+		Участники комнаты
+		Ключ 	 - Логин участника
+		Значение - Номер последнего прочитанного им сообщения
+		*/
+		std::map <std::string, uint64_t> cursors;
+		std::deque<Message> log;	//Журнал сообщений (от старых к новым)
+		uint64_t lastSequence = 0;	//Номер последнего сообщения комнаты
+	};
+
+	//Комнаты по названию
+	std::map <std::string, Room> rooms;
+
+	/*
+	Индекс участия в комнатах
+	Ключ 	 - Логин пользователя
+	Значение - Названия комнат, в которых он состоит
+	*/
+	std::map <std::string, std::set<std::string> > userRooms;
+
+	//Переписка двух пользователей - сообщения в обе стороны (от старых к новым)
+	struct Conversation {
+		std::deque<ConversationEntry> log;	//Ссылки на сообщения в списках адресатов
+		uint64_t lastSequence = 0;	//Номер последнего сообщения переписки
+	};
+
+	/*
+	Индекс переписок
+	Ключ 	 - Логины собеседников (по возрастанию)
+	Значение - Переписка
+	*/
+	std::map <std::pair<std::string, std::string>, Conversation> conversations;
+
+	/*
+	Собеседники пользователей (для удаления переписок вместе с пользователем)
+	Ключ 	 - Логин пользователя
+	Значение - Логины собеседников
+	*/
+	std::map <std::string, std::set<std::string> > userPeers;
+
+	//Непрочитанные пользователем сообщения одного собеседника
+	struct PeerUnread {
+		std::deque<uint64_t> sequences;	//Номера непрочитанных сообщений в переписке (по возрастанию)
+		uint64_t lastRead = 0;	//Номер последнего прочитанного сообщения переписки
+	};
+
+	//Непрочитанные сообщения пользователя
+	struct UserUnread {
+		size_t total = 0;	//Всего непрочитанных сообщений
+		std::unordered_map<std::string, PeerUnread> peers;	//По Логину собеседника
+	};
+
+	/*
+	Счётчики непрочитанных сообщений - меняются при каждом сообщении и подтверждении
+	прочтения без пересчёта по спискам сообщений
+	Ключ 	 - Логин пользователя
+	Значение - Непрочитанные сообщения
+	*/
+	std::unordered_map<std::string, UserUnread> unread;
+
+	const size_t CONVERSATION_MAX = 10000;	//MAX сообщений в переписке (старые удаляются)
+
+	const size_t ROOM_LOG_TRIM = 256;	//Убирать прочитанные всеми сообщения, когда их столько
+	const size_t ROOM_LOG_MAX = 10000;	//MAX сообщений в журнале комнаты (старые теряют отставшие)
+
+	//Снимок базы на диске. Файлы снимка - с номером поколения снимка в расширении:
+	//новое поколение пишется рядом с прежним и становится снимком после замены манифеста
+	const std::string SNAPSHOT_MANIFEST = "manifest";	//Файл с количеством сегментов и поколениями
+	const std::string SNAPSHOT_SEGMENT = "segment_";	//Префикс файла сегмента
+	const uint32_t SNAPSHOT_MAGIC = 0x53434E43;	//Сигнатура сегмента
+	const uint32_t SNAPSHOT_VERSION = 8;	//Версия формата сегмента
+	const std::string SNAPSHOT_ROOMS = "rooms";	//Файл комнат
+	const std::string SNAPSHOT_CONVERSATIONS = "conversations";	//Файл переписок
+	const std::string SNAPSHOT_UNREAD = "unread";	//Файл счётчиков непрочитанных сообщений
+	//Файл текстов сообщений: текст, общий у нескольких адресатов, пишется один раз,
+	//сегменты ссылаются на него по номеру
+	const std::string SNAPSHOT_TEXTS = "texts";
+
+	//Копия пользователя для записи снимка без блокировки базы
+	struct SavedUser {
+		std::string name;
+		std::string login;
+		credential::Record credential;
+		uint64_t id = 0;
+		uint64_t lastSequence = 0;
+		bool hasPolicy = false;	//У пользователя собственная политика хранения
+		database::Retention policy;
+		std::vector<Message> messages;	//Сообщения в памяти (от новых к старым)
+		std::deque<ColdStore::Entry> entries;	//Индекс сообщений на диске
+	};
+
+	//Копия данных базы для записи снимка без блокировки базы
+	struct SavedData {
+		std::vector<std::vector<SavedUser> > parts;	//Пользователи по сегментам
+		std::map <std::string, Room> rooms;
+		std::map <std::pair<std::string, std::string>, Conversation> conversations;
+		std::unordered_map<std::string, UserUnread> unread;
+		uint64_t coldGeneration = 0;	//Поколение файла хранилища, на которое ссылается индекс
+		std::vector<std::string> staleColdFiles;	//Прежние файлы хранилища на момент копии
+	};
+}
+
+
+
+void database::initialize()
+{
+	database::addUser("G", "Ger", credential::make(sha_1::digest("123")));
+	database::addUser("S", "Sve", credential::make(sha_1::digest("qwe")));
+}
+
+
+
+bool database::isLoginRegistered(const std::string& login)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	//Логина точно нет в базе
+	if (!loginFilter.mayContain(login)) {
+		return false;
+	}
+	//Логина нет в базе
+	if (userData.find(login) == userData.end()) {
+		loginFilter.reportFalsePositive();
+		return false;
+	}
+	return true;
+}
+
+
+
+bool database::isNicknameRegistered(const std::string& name)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	//Ника точно нет в базе
+	if (!nameFilter.mayContain(name)) {
+		return false;
+	}
+	//Ника нет в базе
+	if (nameIndex.find(name) == nameIndex.end()) {
+		nameFilter.reportFalsePositive();
+		return false;
+	}
+	return true;
+}
+
+
+
+bool database::isPasswordRight(const std::string& login,
+  const sha_1::Digest& passwordHash)
+{
+	//Запись фиксированного размера - копия без выделения памяти
+	credential::Record stored;
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+		//Пользователь не зарегистрирован
+		if (!isLoginRegistered(login)) {
+			return false;
+		}
+		stored = userData[login].getCredential();
+	}
+
+	//Проверка учётных данных дорогая - без блокировки Базы
+	return credential::verify(stored, passwordHash);
+}
+
+
+
+static std::string getLoginByName(const std::string& name);
+
+//Заполнить фильтры заново по таблицам, размер - по количеству пользователей
+static void rebuildFilters();
+
+//Записать изменение списка пользователей в журнал и увеличить версию
+static void logDirectoryChange(database::DirectoryChange::Type type,
+	const std::string& name, const std::string& oldName);
+
+//Добавить сообщение в переписку отправителя и адресата
+static void appendConversation(const std::string& loginAdressee, const Message& message,
+	uint64_t inboxSequence);
+
+//Сообщение с номером отправителя по его текущему Нику (номер уже задан - без изменений)
+static Message stampSender(const Message& message);
+
+void database::pushMessage(const std::string& nameAdressee,
+	const Message& original)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	const Message message = stampSender(original);
+	//Сообщение для всех
+	if (nameAdressee == MSG_TO_ALL) {
+		//Каждому пользователю в базе отправить сообщение
+		const size_t size = getMessageSize(message);
+		userTable.forEachUser([&message, size](User& user) {
+			user.setMessage(message);
+			user.setMessageBytes(user.getMessageBytes() + size);
+		});
+		hotBytes += size * userData.size();
+	}
+
+	//Сообщение личное
+	else {
+		//Пользователь не зарегистрирован
+		if (!isNicknameRegistered(nameAdressee)) {
+			return;
+		}
+		const std::string login = getLoginByName(nameAdressee);
+		User& user = userData[login];
+		user.setMessage(message);
+		user.setMessageBytes(user.getMessageBytes() + getMessageSize(message));
+		hotBytes += getMessageSize(message);
+		appendConversation(login, message, user.getLastSequence());
+	}
+}
+
+
+
+void database::pushMessage(const std::vector<std::string>& namesAdressee,
+	const Message& original,
+	std::vector<bool>& delivered)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	const Message message = stampSender(original);
+	delivered.assign(namesAdressee.size(), false);
+	//Логины, которым сообщение уже доставлено - повтор Ника не дублирует сообщение
+	std::set<std::string> logins;
+	for (size_t i = 0; i < namesAdressee.size(); ++i) {
+		auto name = nameIndex.find(namesAdressee[i]);
+		//Пользователь не зарегистрирован
+		if (name == nameIndex.end()) {
+			continue;
+		}
+		delivered[i] = true;
+		if (!logins.insert(name->second).second) {
+			continue;
+		}
+		User& user = userData.find(name->second)->second;
+		user.setMessage(message);
+		user.setMessageBytes(user.getMessageBytes() + getMessageSize(message));
+		hotBytes += getMessageSize(message);
+		appendConversation(name->second, message, user.getLastSequence());
+	}
+}
+
+
+
+//Ключ переписки двух пользователей
+static std::pair<std::string, std::string> conversationKey(const std::string& login,
+	const std::string& peer);
+
+bool database::loadConversation(const std::string& login, const std::string& namePeer,
+	uint64_t before, size_t limit, std::list<Message>& messages)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	messages.clear();
+	const std::string peer = getLoginByName(namePeer);
+	if (peer.empty() || userData.find(login) == userData.end()) {
+		return false;
+	}
+	auto conversation = conversations.find(conversationKey(login, peer));
+	if (conversation == conversations.end()) {
+		return true;
+	}
+
+	//Номера в журнале переписки возрастают - найти страницу двоичным поиском
+	const std::deque<ConversationEntry>& log = conversation->second.log;
+	auto end = (before == 0) ? log.end() :
+		std::lower_bound(log.begin(), log.end(), before,
+			[](const ConversationEntry& value, uint64_t sequence) {
+				return value.sequence < sequence;
+			});
+
+	//Сообщения - в списках адресатов. Записи идут от новых к старым, поэтому
+	//по списку каждого адресата достаточно одного прохода от начала
+	const std::string* logins[2] = {&conversation->first.first, &conversation->first.second};
+	std::shared_ptr<std::list<Message> > inboxes[2];
+	std::list<Message>::const_iterator positions[2];
+	for (size_t side = 0; side < 2; ++side) {
+		inboxes[side] = userData[*logins[side]].getMessageList();
+		positions[side] = inboxes[side]->begin();
+	}
+	std::list<Message> cold;
+	for (auto entry = end; entry != log.begin() && messages.size() < limit; ) {
+		--entry;
+		const size_t side = entry->isToFirst ? 0 : 1;
+		auto& position = positions[side];
+		while (position != inboxes[side]->end() &&
+				position->getSequence() > entry->inboxSequence) {
+			++position;
+		}
+		if (position != inboxes[side]->end() &&
+				position->getSequence() == entry->inboxSequence) {
+			messages.emplace_back(*position, entry->sequence);
+			continue;
+		}
+		//Сообщение старше списка в памяти - на диске или уже удалено политикой хранения
+		if (position == inboxes[side]->end()) {
+			cold.clear();
+			coldStore.load(*logins[side], entry->inboxSequence, entry->inboxSequence, cold);
+			if (!cold.empty()) {
+				messages.emplace_back(cold.front(), entry->sequence);
+			}
+		}
+	}
+	return true;
+}
+
+
+
+static void appendConversation(const std::string& loginAdressee, const Message& message,
+	uint64_t inboxSequence)
+{
+	//Отправитель не зарегистрирован
+	const std::string loginFrom = getLoginByName(message.getNameFrom());
+	if (loginFrom.empty()) {
+		return;
+	}
+	const auto key = conversationKey(loginFrom, loginAdressee);
+	Conversation& conversation = conversations[key];
+	conversation.log.push_back(ConversationEntry{++conversation.lastSequence, inboxSequence,
+		key.first == loginAdressee});
+	if (conversation.log.size() > CONVERSATION_MAX) {
+		conversation.log.pop_front();
+	}
+	userPeers[loginFrom].insert(loginAdressee);
+	userPeers[loginAdressee].insert(loginFrom);
+
+	//Сообщение самому себе прочитано сразу
+	if (loginFrom != loginAdressee) {
+		UserUnread& adresseeUnread = unread[loginAdressee];
+		adresseeUnread.peers[loginFrom].sequences.push_back(conversation.lastSequence);
+		++adresseeUnread.total;
+	}
+}
+
+
+
+static Message stampSender(const Message& message)
+{
+	if (message.getSenderId() != 0) {
+		return message;
+	}
+	//Отправитель не зарегистрирован - сообщение остаётся без номера
+	auto name = nameIndex.find(message.getNameFrom());
+	if (name == nameIndex.end()) {
+		return message;
+	}
+	return Message(message, message.getSequence(), userData[name->second].getId());
+}
+
+
+
+size_t database::loadUnreadSummary(const std::string& login, std::vector<UnreadCount>& counts)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	counts.clear();
+	auto userUnread = unread.find(login);
+	if (userUnread == unread.end()) {
+		return 0;
+	}
+	for (const auto& peer : userUnread->second.peers) {
+		auto user = userData.find(peer.first);
+		if (peer.second.sequences.empty() || user == userData.end()) {
+			continue;
+		}
+		counts.push_back(UnreadCount{user->second.getName(), peer.second.sequences.size(),
+			peer.second.sequences.back()});
+	}
+	return userUnread->second.total;
+}
+
+
+
+void database::acknowledgeRead(const std::string& login,
+	const std::vector<std::pair<std::string, uint64_t> >& acknowledgements)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	auto userUnread = unread.find(login);
+	if (userUnread == unread.end()) {
+		return;
+	}
+	for (const auto& acknowledgement : acknowledgements) {
+		auto peer = userUnread->second.peers.find(getLoginByName(acknowledgement.first));
+		if (peer == userUnread->second.peers.end()) {
+			continue;
+		}
+		//Прочитано всё до заданного номера включительно
+		PeerUnread& peerUnread = peer->second;
+		peerUnread.lastRead = std::max(peerUnread.lastRead, acknowledgement.second);
+		while (!peerUnread.sequences.empty() &&
+				peerUnread.sequences.front() <= peerUnread.lastRead) {
+			peerUnread.sequences.pop_front();
+			--userUnread->second.total;
+		}
+	}
+}
+
+
+
+static std::pair<std::string, std::string> conversationKey(const std::string& login,
+	const std::string& peer)
+{
+	return (login < peer) ? std::make_pair(login, peer) : std::make_pair(peer, login);
+}
+
+
+
+void database::loadMessages(const std::string& login, std::shared_ptr<std::list<Message> >& messages,
+	size_t limit)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	//Пользователь не зарегистрирован
+	if (!isLoginRegistered(login)) {
+		return;
+	}
+
+	//Копия - список пользователя может уплотняться в фоновом потоке.
+	//Копируется только начало списка - новые сообщения, которые будут отправлены
+	const auto list = userData[login].getMessageList();
+	auto end = list->begin();
+	if (limit == 0 || limit >= list->size()) {
+		end = list->end();
+	}
+	else {
+		std::advance(end, limit);
+	}
+	messages = std::make_shared<std::list<Message> >(list->begin(), end);
+}
+
+
+
+uint64_t database::getLastSequence(const std::string& login)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	auto user = userData.find(login);
+	return (user == userData.end()) ? 0 : user->second.getLastSequence();
+}
+
+
+
+void database::removeUser(const std::string& login)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	auto user = userData.find(login);
+	//Логина нет в базе
+	if (user == userData.end()) {
+		return;
+	}
+	nameIndex.erase(user->second.getName());
+	loginFilter.remove(login);
+	nameFilter.remove(user->second.getName());
+	userTable.erase(userIds[login]);
+	userIds.erase(login);
+	userRetention.erase(login);
+	coldStore.erase(login);
+	//Удалить переписки с собеседниками - журналы освободит фоновая задача
+	std::vector<std::deque<ConversationEntry> > logs;
+	auto peers = userPeers.find(login);
+	if (peers != userPeers.end()) {
+		for (const auto& peer : peers->second) {
+			auto conversation = conversations.find(conversationKey(login, peer));
+			if (conversation != conversations.end()) {
+				logs.push_back(std::move(conversation->second.log));
+				conversations.erase(conversation);
+			}
+			//Непрочитанные сообщения от пользователя бывают только у его собеседников
+			auto peerUnread = unread.find(peer);
+			if (peer != login && peerUnread != unread.end()) {
+				auto fromUser = peerUnread->second.peers.find(login);
+				if (fromUser != peerUnread->second.peers.end()) {
+					peerUnread->second.total -= fromUser->second.sequences.size();
+					peerUnread->second.peers.erase(fromUser);
+				}
+			}
+			auto peerPeers = userPeers.find(peer);
+			if (peer != login && peerPeers != userPeers.end()) {
+				peerPeers->second.erase(login);
+				if (peerPeers->second.empty()) {
+					userPeers.erase(peerPeers);
+				}
+			}
+		}
+		userPeers.erase(login);
+	}
+	//Удалить непрочитанные сообщения пользователя
+	unread.erase(login);
+	//Выйти из всех комнат
+	auto memberOf = userRooms.find(login);
+	if (memberOf != userRooms.end()) {
+		const std::set<std::string> names = memberOf->second;
+		for (const auto& room : names) {
+			database::leaveRoom(room, login);
+		}
+	}
+
+	//Извлечь узел без освобождения памяти - сообщения освободит фоновая задача
+	const std::string name = user->second.getName();
+	tombstones.push_back(Tombstone{userData.extract(user), std::move(logs)});
+	logDirectoryChange(DirectoryChange::REMOVED, name, "");
+}
+
+
+
+std::string database::getNickname(const std::string& login)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	//Логина нет в базе
+	if (!database::isLoginRegistered(login)) {
+		return "";
+	}
+	return userData.find(login)->second.getName();
+}
+
+
+
+size_t database::getNumberUsers()
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	return userData.size();
+}
+
+
+
+void database::loadUserNames(std::shared_ptr<std::vector<std::string> > userNames)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	userTable.loadNames(*userNames);
+}
+
+
+
+bool database::addUser(const std::string& name,
+	const std::string& login,
+	const credential::Record& credential)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	//Пользователь уже есть в базе
+	if (userData.find(login) != userData.end()) {
+		return false;
+	}
+	//Данные пользователя не введены
+	if (name.empty() || login.empty()) {
+		return false;
+	}
+	//Ник уже занят другим пользователем
+	if (nameIndex.find(name) != nameIndex.end()) {
+		return false;
+	}
+
+	//Создать в базе пару Логин-Пользователь
+	auto user = userData.emplace(std::make_pair(login,
+																	User(name, login, credential))).first;
+	user->second.setId(++lastUserId);
+	nameIndex.emplace(name, login);
+	userIds.emplace(login, userTable.insert(name, &user->second));
+	//Фильтр переполнен - доля ложных ответов растёт, увеличить его
+	if (userData.size() * FILTER_COUNTERS_PER_KEY > loginFilter.getCounters()) {
+		rebuildFilters();
+	}
+	else {
+		loginFilter.add(login);
+		nameFilter.add(name);
+	}
+	logDirectoryChange(DirectoryChange::ADDED, name, "");
+	return true;
+}
+
+
+
+bool database::setNickname(const std::string& login, const std::string& name)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	auto user = userData.find(login);
+	//Логина нет в базе или Ник не введён
+	if (user == userData.end() || name.empty()) {
+		return false;
+	}
+	//Ник уже занят
+	if (nameIndex.find(name) != nameIndex.end()) {
+		return false;
+	}
+
+	const std::string oldName = user->second.getName();
+	nameIndex.erase(oldName);
+	nameIndex.emplace(name, login);
+	nameFilter.remove(oldName);
+	nameFilter.add(name);
+	userTable.rename(userIds[login], name);
+	user->second.setName(name);
+	logDirectoryChange(DirectoryChange::RENAMED, name, oldName);
+	return true;
+}
+
+
+
+uint64_t database::getDirectoryVersion()
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	return directoryVersion;
+}
+
+
+
+void database::loadFilterStatistics(BloomFilter::Statistics& logins,
+	BloomFilter::Statistics& nicknames)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	logins = loginFilter.getStatistics();
+	nicknames = nameFilter.getStatistics();
+}
+
+
+
+bool database::loadDirectoryChanges(uint64_t version,
+	std::vector<DirectoryChange>& changes)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	changes.clear();
+	//Версия из будущего (например, до перезапуска сервера) - нужен полный список
+	if (version > directoryVersion) {
+		return false;
+	}
+	//Изменения после version в журнале уже не сохранились
+	const uint64_t oldest = directoryLog.empty() ?
+		directoryVersion + 1 : directoryLog.front().version;
+	if (version != directoryVersion && version + 1 < oldest) {
+		return false;
+	}
+
+	//Журнал упорядочен по версиям - найти первое изменение после version
+	auto change = std::upper_bound(directoryLog.begin(), directoryLog.end(), version,
+		[](uint64_t value, const DirectoryChange& item) { return value < item.version; });
+	changes.assign(change, directoryLog.end());
+	return true;
+}
+
+
+
+static void logDirectoryChange(database::DirectoryChange::Type type,
+	const std::string& name, const std::string& oldName)
+{
+	database::DirectoryChange change;
+	change.type = type;
+	change.version = ++directoryVersion;
+	change.name = name;
+	change.oldName = oldName;
+	directoryLog.push_back(change);
+	if (directoryLog.size() > DIRECTORY_LOG_SIZE) {
+		directoryLog.pop_front();
+	}
+}
+
+
+
+void database::findNicknames(const std::string& prefix, const std::string& after,
+	size_t limit, std::vector<std::string>& nicknames)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	nicknames.clear();
+
+	//Индекс упорядочен по Никам - начать с первого подходящего после after
+	auto index = (after < prefix) ?
+		nameIndex.lower_bound(prefix) : nameIndex.upper_bound(after);
+	for (; index != nameIndex.end() && nicknames.size() < limit; ++index) {
+		//Ники с заданным началом закончились
+		if (index->first.compare(0, prefix.size(), prefix) != 0) {
+			break;
+		}
+		nicknames.push_back(index->first);
+	}
+}
+
+
+
+//Убрать из журнала комнаты сообщения, прочитанные всеми участниками
+static void trimRoom(Room& room);
+
+bool database::createRoom(const std::string& room, const std::string& login)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	//Название не введено или совпадает с адресатом "всем"
+	if (room.empty() || room == MSG_TO_ALL) {
+		return false;
+	}
+	//Комната уже есть или пользователь не зарегистрирован
+	if (rooms.find(room) != rooms.end() || userData.find(login) == userData.end()) {
+		return false;
+	}
+	rooms.emplace(room, Room());
+	return database::joinRoom(room, login);
+}
+
+
+
+bool database::joinRoom(const std::string& room, const std::string& login)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	auto found = rooms.find(room);
+	if (found == rooms.end() || userData.find(login) == userData.end()) {
+		return false;
+	}
+	//Новый участник видит всю сохранённую историю комнаты
+	const uint64_t cursor = found->second.log.empty() ?
+		found->second.lastSequence : found->second.log.front().getSequence() - 1;
+	found->second.cursors.emplace(login, cursor);
+	userRooms[login].insert(room);
+	return true;
+}
+
+
+
+bool database::leaveRoom(const std::string& room, const std::string& login)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	auto found = rooms.find(room);
+	if (found == rooms.end() || found->second.cursors.erase(login) == 0) {
+		return false;
+	}
+	auto memberOf = userRooms.find(login);
+	memberOf->second.erase(room);
+	if (memberOf->second.empty()) {
+		userRooms.erase(memberOf);
+	}
+
+	//Последний участник вышел - комната больше не нужна
+	if (found->second.cursors.empty()) {
+		rooms.erase(found);
+	}
+	return true;
+}
+
+
+
+bool database::postToRoom(const std::string& room, const std::string& login,
+	const std::string& text)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	auto found = rooms.find(room);
+	//Писать в комнату могут только её участники
+	if (found == rooms.end() ||
+			found->second.cursors.find(login) == found->second.cursors.end()) {
+		return false;
+	}
+
+	Room& target = found->second;
+	const User& sender = userData[login];
+	target.log.emplace_back(sender.getName(), text, std::time(nullptr),
+		++target.lastSequence, sender.getId());
+	if (target.log.size() > ROOM_LOG_MAX) {
+		target.log.pop_front();
+	}
+	return true;
+}
+
+
+
+bool database::loadRoomMessages(const std::string& room, const std::string& login,
+	std::list<Message>& messages, size_t limit)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	messages.clear();
+	auto found = rooms.find(room);
+	if (found == rooms.end()) {
+		return false;
+	}
+	auto cursor = found->second.cursors.find(login);
+	if (cursor == found->second.cursors.end()) {
+		return false;
+	}
+
+	//Журнал упорядочен по номерам - непрочитанные сообщения лежат в конце
+	const std::deque<Message>& log = found->second.log;
+	auto message = std::upper_bound(log.begin(), log.end(), cursor->second,
+		[](uint64_t sequence, const Message& value) {
+			return sequence < value.getSequence();
+		});
+	const size_t unreadCount = log.end() - message;
+	const size_t count = (limit == 0) ? unreadCount : std::min(limit, unreadCount);
+	messages.insert(messages.end(), message, message + count);
+	return true;
+}
+
+
+
+bool database::markRoomRead(const std::string& room, const std::string& login,
+	uint64_t sequence)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	auto found = rooms.find(room);
+	if (found == rooms.end()) {
+		return false;
+	}
+	auto cursor = found->second.cursors.find(login);
+	if (cursor == found->second.cursors.end()) {
+		return false;
+	}
+	sequence = std::min(sequence, found->second.lastSequence);
+	cursor->second = std::max(cursor->second, sequence);
+
+	if (found->second.log.size() >= ROOM_LOG_TRIM) {
+		trimRoom(found->second);
+	}
+	return true;
+}
+
+
+
+void database::loadUserRooms(const std::string& login, std::vector<std::string>& names)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	names.clear();
+	auto memberOf = userRooms.find(login);
+	if (memberOf != userRooms.end()) {
+		names.assign(memberOf->second.begin(), memberOf->second.end());
+	}
+}
+
+
+
+static void trimRoom(Room& room)
+{
+	uint64_t minCursor = room.lastSequence;
+	for (const auto& cursor : room.cursors) {
+		minCursor = std::min(minCursor, cursor.second);
+	}
+	while (!room.log.empty() && room.log.front().getSequence() <= minCursor) {
+		room.log.pop_front();
+	}
+}
+
+
+
+void database::clear()
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	userData.clear();
+	nameIndex.clear();
+	userTable.clear();
+	userIds.clear();
+	loginFilter.reset(FILTER_MIN_COUNTERS);
+	nameFilter.reset(FILTER_MIN_COUNTERS);
+	userRetention.clear();
+	compactionCursor.clear();
+	coldStore.clear();
+	hotBytes = 0;
+	tombstones.clear();
+	purging.clear();
+	purgeCursor.clear();
+	isPurgingRooms = false;
+	purgeRoomCursor.clear();
+	lastUserId = 0;
+	rooms.clear();
+	userRooms.clear();
+	conversations.clear();
+	userPeers.clear();
+	unread.clear();
+	//Журнал не описывает переход к пустой базе - клиентам нужен полный список
+	directoryLog.clear();
+	++directoryVersion;
+}
+
+
+
+void database::setRetention(const Retention& policy)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	retention = policy;
+}
+
+
+
+void database::setRetention(const std::string& login, const Retention& policy)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	//Логина нет в базе
+	if (!isLoginRegistered(login)) {
+		return;
+	}
+	userRetention[login] = policy;
+}
+
+
+
+//Отделить от списка сообщения, не удовлетворяющие политике хранения
+static size_t trimMessages(const std::string& login,
+													User& user,
+													const database::Retention& policy,
+													std::time_t now,
+													database::Garbage& garbage);
+
+//Отобрать для переноса на диск сообщения сверх допустимого объёма в памяти
+//Сообщения остаются в списке, пока не записаны
+static void selectSpill(const std::string& login,
+												const User& user,
+												size_t allowance,
+												std::vector<ColdStore::Batch>& spills);
+
+//Внести записанные на диск сообщения в индекс хранилища и убрать их из памяти
+static size_t commitSpill(const ColdStore::Batch& spill, database::Garbage& garbage);
+
+//Перенести в garbage хвост списка сообщений пользователя, начиная с first
+//Обходится только остающееся начало списка, объём хвоста - из объёма списка
+static size_t detachTail(User& user, std::list<Message>::iterator first,
+												size_t keptBytes, database::Garbage& garbage);
+
+//Убрать из начала журналов переписок пользователя ссылки на сообщения,
+//которых у адресатов уже нет ни в памяти, ни на диске
+static void pruneConversations(const std::string& login);
+
+//Номер самого старого сообщения пользователя - на диске, иначе в конце списка в памяти
+static uint64_t getFirstSequence(const std::string& login);
+
+//Переписать файл хранилища без забытых записей, если они занимают больше половины файла
+static void rewriteColdStore();
+
+//Путь к файлу хранилища заданного поколения
+static std::string coldFilePath(uint64_t generation);
+
+
+size_t database::compact(Garbage& garbage, size_t batch)
+{
+	const std::time_t now = std::time(nullptr);
+	size_t bytes = 0;
+	//Сообщения для переноса на диск - пишутся без блокировки
+	std::vector<ColdStore::Batch> spills;
+	bool isFinished = false;
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+		//Доля каждого пользователя в допустимом объёме сообщений в памяти
+		//(пользователей нет - переносить нечего, объём освободит reclaim)
+		const bool isSpill = coldStore.isOpen() && hotBudget != 0 && hotBytes > hotBudget &&
+			!userData.empty();
+		const size_t allowance = isSpill ? hotBudget / userData.size() : 0;
+
+		auto user = userData.upper_bound(compactionCursor);
+		for (size_t i = 0; i < batch && user != userData.end(); ++i, ++user) {
+			auto policy = userRetention.find(user->first);
+			bytes += trimMessages(user->first, user->second,
+														policy == userRetention.end() ? retention : policy->second,
+														now, garbage);
+			if (isSpill) {
+				selectSpill(user->first, user->second, allowance, spills);
+			}
+			pruneConversations(user->first);
+		}
+
+		//Проход по базе завершён - следующий начнётся с первого пользователя
+		isFinished = user == userData.end();
+		if (isFinished) {
+			compactionCursor.clear();
+		}
+		else {
+			compactionCursor = std::prev(user)->first;
+		}
+	}
+
+	//Записать на диск без блокировки, затем под ней внести записи в индекс
+	if (!spills.empty() && coldStore.write(spills)) {
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+		for (const auto& spill : spills) {
+			bytes += commitSpill(spill, garbage);
+		}
+	}
+	if (isFinished) {
+		rewriteColdStore();
+	}
+	return bytes;
+}
+
+
+
+bool database::isCompactionFinished()
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	return compactionCursor.empty();
+}
+
+
+
+size_t database::reclaim(Garbage& garbage, size_t batch)
+{
+	//Забранные из очереди удалённые пользователи с журналами их переписок
+	//Объявлены до блокировки - освобождаются при выходе, уже после её снятия
+	std::deque<Tombstone> removed;
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	size_t bytes = 0;
+
+	//Начало прохода - забрать сообщения всех ожидающих пользователей
+	if (purging.empty()) {
+		removed.swap(tombstones);
+		for (auto& tombstone : removed) {
+			User& removedUser = tombstone.node.mapped();
+			auto messages = removedUser.getMessageList();
+			bytes += removedUser.getMessageBytes();
+			garbage.count += messages->size();
+			garbage.lists.emplace_back();
+			garbage.lists.back().splice(garbage.lists.back().end(), *messages);
+			removedUser.setMessageBytes(0);
+			//Текст сообщений переписок общий со списками адресатов - объём уже учтён
+			purging.insert(removedUser.getId());
+		}
+		purgeCursor.clear();
+		isPurgingRooms = false;
+		purgeRoomCursor.clear();
+		hotBytes -= bytes;
+		if (purging.empty()) {
+			return bytes;
+		}
+	}
+
+	//Вычистить из списков и хранилища остальных пользователей сообщения удалённых
+	size_t i = 0;
+	if (!isPurgingRooms) {
+		auto user = userData.upper_bound(purgeCursor);
+		for (; i < batch && user != userData.end(); ++i, ++user) {
+			auto messages = user->second.getMessageList();
+			std::list<Message> purged;
+			size_t purgedBytes = 0;
+			for (auto message = messages->begin(); message != messages->end(); ) {
+				if (purging.count(message->getSenderId()) == 0) {
+					++message;
+					continue;
+				}
+				purgedBytes += getMessageSize(*message);
+				purged.splice(purged.end(), *messages, message++);
+			}
+			if (!purged.empty()) {
+				user->second.setMessageBytes(user->second.getMessageBytes() - purgedBytes);
+				hotBytes -= purgedBytes;
+				bytes += purgedBytes;
+				garbage.count += purged.size();
+				garbage.lists.push_back(std::move(purged));
+			}
+			//Записи на диске забываются в индексе - файл освободит перезапись
+			coldStore.purge(user->first, purging);
+		}
+		if (user != userData.end()) {
+			purgeCursor = std::prev(user)->first;
+			return bytes;
+		}
+		isPurgingRooms = true;
+	}
+
+	//Вычистить журналы комнат. Сообщения журнала неизменяемы - журнал с сообщениями
+	//удалённых пересобирается из остальных
+	const auto firstRoom = rooms.upper_bound(purgeRoomCursor);
+	auto room = firstRoom;
+	for (; i < batch && room != rooms.end(); ++i, ++room) {
+		std::deque<Message>& log = room->second.log;
+		if (std::none_of(log.begin(), log.end(), [](const Message& message) {
+					return purging.count(message.getSenderId()) != 0;
+				})) {
+			continue;
+		}
+		std::deque<Message> kept;
+		std::list<Message> purged;
+		for (const auto& message : log) {
+			if (purging.count(message.getSenderId()) == 0) {
+				kept.push_back(message);
+			}
+			else {
+				bytes += getMessageSize(message);
+				purged.push_back(message);
+			}
+		}
+		log.swap(kept);
+		garbage.count += purged.size();
+		garbage.lists.push_back(std::move(purged));
+	}
+	if (room != rooms.end()) {
+		//Пакет исчерпан на пользователях - комнаты начнутся со следующего вызова
+		if (room != firstRoom) {
+			purgeRoomCursor = std::prev(room)->first;
+		}
+		return bytes;
+	}
+
+	//Проход по базе завершён
+	purging.clear();
+	purgeCursor.clear();
+	isPurgingRooms = false;
+	purgeRoomCursor.clear();
+	return bytes;
+}
+
+
+
+bool database::isReclaimFinished()
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	return tombstones.empty() && purging.empty();
+}
+
+
+
+size_t database::getMessageSize(const Message& message)
+{
+	return sizeof(Message) + message.getNameFrom().size() + message.getText().size();
+}
+
+
+
+bool database::openColdStore(const std::string& path)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	//Файл поколения из загруженного снимка - индекс к нему уже восстановлен
+	coldStorePath = path;
+	return coldStore.open(coldFilePath(coldGeneration));
+}
+
+
+
+void database::setHotBudget(size_t bytes)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	hotBudget = bytes;
+}
+
+
+
+size_t database::getHotBytes()
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	return hotBytes;
+}
+
+
+
+void database::loadMessages(const std::string& login, uint64_t first, uint64_t last,
+	std::list<Message>& messages)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	messages.clear();
+	auto user = userData.find(login);
+	//Логина нет в базе
+	if (user == userData.end()) {
+		return;
+	}
+
+	//Сообщения в памяти - от новых к старым
+	const auto hot = user->second.getMessageList();
+	for (const auto& message : *hot) {
+		if (message.getSequence() < first) {
+			break;
+		}
+		if (message.getSequence() <= last) {
+			messages.push_back(message);
+		}
+	}
+
+	//Диапазон продолжается в хранилище на диске
+	if (hot->empty() || hot->back().getSequence() > first) {
+		const uint64_t coldLast = hot->empty() ? last :
+			std::min(last, hot->back().getSequence() - 1);
+		coldStore.load(login, first, coldLast, messages);
+	}
+}
+
+
+
+void database::loadMessagesByTime(const std::string& login, std::time_t from, std::time_t to,
+	uint64_t before, std::list<Message>& messages)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	messages.clear();
+	auto user = userData.find(login);
+	uint64_t first = 0;
+	uint64_t last = 0;
+	//Логина нет в базе или в интервале времени сообщений нет
+	if (user == userData.end() ||
+			!user->second.getTimeIndex().find(from, to, first, last)) {
+		return;
+	}
+	if (before != 0) {
+		if (before <= first) {
+			return;
+		}
+		last = std::min(last, before - 1);
+	}
+
+	//Индекс разреженный - на краях интервала номеров могут быть лишние сообщения
+	database::loadMessages(login, first, last, messages);
+	messages.remove_if([from, to](const Message& message) {
+		return message.getTime() < from || message.getTime() > to;
+	});
+}
+
+
+
+//Записать в поток строку в формате ДЛИНА|БАЙТЫ
+static void writeString(std::ostream& stream, const std::string& value);
+
+//Прочитать из потока строку в формате ДЛИНА|БАЙТЫ
+//Длина больше остатка потока - ошибка, а не попытка выделить под неё память
+static bool readString(std::istream& stream, std::string& value);
+
+//Прочитать файл целиком в поток в памяти - остаток такого потока известен
+static bool readFile(const std::string& path, std::istringstream& stream);
+
+//Количество непрочитанных байт потока в памяти
+static uint64_t getRemaining(std::istream& stream);
+
+//Прочитать манифест снимка: количество сегментов, поколение файла хранилища
+//на диске и поколение снимка
+static bool readManifest(const std::string& directory, size_t& segments,
+	uint64_t& storeGeneration, uint64_t& generation);
+
+//Путь к файлу снимка заданного поколения
+static std::string snapshotPath(const std::string& directory, const std::string& name,
+	uint64_t generation);
+
+//Записать в поток целое число
+template <typename T>
+static void writeValue(std::ostream& stream, T value);
+
+//Прочитать из потока целое число
+template <typename T>
+static bool readValue(std::istream& stream, T& value);
+
+//Путь к файлу сегмента с заданным номером
+static std::string segmentPath(const std::string& directory, size_t segment,
+	uint64_t generation);
+
+//Записи индекса хранилища на диске одного пользователя
+using ColdIndex = std::pair<std::string, std::deque<ColdStore::Entry> >;
+
+//Общие тексты сообщений снимка по номеру
+using Texts = std::vector<std::shared_ptr<const std::string> >;
+
+//Декодировать сегмент снимка в список пользователей, их политик хранения
+//и индексов хранилища на диске. Тексты сообщений берутся из общей таблицы
+static bool loadSegment(const std::string& path, const Texts& texts, std::vector<User>& users,
+	std::vector<std::pair<std::string, database::Retention> >& policies,
+	std::vector<ColdIndex>& coldIndexes);
+
+//Снять под блокировкой копию данных базы для снимка
+static void copySnapshot(size_t segments, SavedData& saved);
+
+//Записать тексты сообщений в файл (по номерам)
+static bool writeTexts(const std::string& path, const std::vector<const std::string*>& texts);
+
+//Считать тексты сообщений из файла
+static bool readTexts(const std::string& path, Texts& result);
+
+//Записать комнаты в файл
+static bool writeRooms(const std::string& path, const std::map<std::string, Room>& savedRooms);
+
+//Считать комнаты из файла
+static bool readRooms(const std::string& path, std::map<std::string, Room>& result);
+
+//Записать переписки в файл
+static bool writeConversations(const std::string& path,
+	const std::map<std::pair<std::string, std::string>, Conversation>& savedConversations);
+
+//Считать переписки из файла
+static bool readConversations(const std::string& path,
+	std::map<std::pair<std::string, std::string>, Conversation>& result);
+
+//Записать счётчики непрочитанных сообщений в файл
+static bool writeUnread(const std::string& path,
+	const std::unordered_map<std::string, UserUnread>& savedUnread);
+
+//Считать счётчики непрочитанных сообщений из файла
+static bool readUnread(const std::string& path,
+	std::unordered_map<std::string, UserUnread>& result);
+
+
+bool database::save(const std::string& directory, size_t segments)
+{
+	if (segments == 0) {
+		segments = 1;
+	}
+	//Копия данных - под блокировкой, кодирование и запись на диск - без неё
+	SavedData saved;
+	copySnapshot(segments, saved);
+
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+	if (error) {
+		return false;
+	}
+	//Файлы нового поколения не затрагивают снимок, на который указывает манифест
+	size_t previousSegments = 0;
+	uint64_t previousStore = 0;
+	uint64_t generation = 0;
+	if (readManifest(directory, previousSegments, previousStore, generation)) {
+		++generation;
+	}
+
+	//Номера текстов сообщений: копии сообщения у разных адресатов хранят один текст
+	std::unordered_map<const std::string*, uint64_t> textIds;
+	std::vector<const std::string*> texts;
+	for (size_t segment = 0; segment < segments; ++segment) {
+		std::ofstream stream(segmentPath(directory, segment, generation),
+			std::ios::binary | std::ios::trunc);
+		if (!stream) {
+			return false;
+		}
+
+		writeValue<uint32_t>(stream, SNAPSHOT_MAGIC);
+		writeValue<uint32_t>(stream, SNAPSHOT_VERSION);
+		writeValue<uint64_t>(stream, saved.parts[segment].size());
+		for (const SavedUser& user : saved.parts[segment]) {
+			writeString(stream, user.name);
+			writeString(stream, user.login);
+			writeValue<uint64_t>(stream, user.id);
+			writeValue(stream, user.credential.iterations);
+			writeValue(stream, user.credential.salt);
+			writeValue(stream, user.credential.key);
+			writeValue<uint64_t>(stream, user.lastSequence);
+
+			//Собственная политика хранения пользователя
+			writeValue<uint8_t>(stream, user.hasPolicy);
+			if (user.hasPolicy) {
+				writeValue<uint64_t>(stream, user.policy.maxCount);
+				writeValue<uint64_t>(stream, user.policy.maxBytes);
+				writeValue<int64_t>(stream, user.policy.maxAge);
+			}
+
+			writeValue<uint64_t>(stream, user.messages.size());
+			for (const auto& message : user.messages) {
+				auto text = textIds.emplace(&message.getText(), texts.size());
+				if (text.second) {
+					texts.push_back(&message.getText());
+				}
+				writeString(stream, message.getNameFrom());
+				writeValue<uint64_t>(stream, text.first->second);
+				writeValue<int64_t>(stream, message.getTime());
+				writeValue<uint64_t>(stream, message.getSequence());
+				writeValue<uint64_t>(stream, message.getSenderId());
+			}
+
+			writeValue<uint64_t>(stream, user.entries.size());
+			for (const auto& entry : user.entries) {
+				writeValue<uint64_t>(stream, entry.sequence);
+				writeValue<int64_t>(stream, entry.time);
+				writeValue<uint64_t>(stream, entry.sender);
+				writeValue<uint64_t>(stream, entry.offset);
+				writeValue<uint32_t>(stream, entry.size);
+				writeValue<uint32_t>(stream, entry.length);
+			}
+		}
+		stream.close();
+		if (!stream) {
+			return false;
+		}
+	}
+
+	if (!writeTexts(snapshotPath(directory, SNAPSHOT_TEXTS, generation), texts) ||
+			!writeRooms(snapshotPath(directory, SNAPSHOT_ROOMS, generation), saved.rooms) ||
+			!writeConversations(snapshotPath(directory, SNAPSHOT_CONVERSATIONS, generation),
+				saved.conversations) ||
+			!writeUnread(snapshotPath(directory, SNAPSHOT_UNREAD, generation), saved.unread)) {
+		return false;
+	}
+
+	//Манифест пишется последним - его замена переключает снимок на новое поколение целиком
+	const std::string manifestPath = directory + "/" + SNAPSHOT_MANIFEST;
+	std::ofstream manifest(manifestPath + ".tmp", std::ios::trunc);
+	if (!manifest) {
+		return false;
+	}
+	manifest << segments << " " << saved.coldGeneration << " " << generation;
+	manifest.close();
+	if (!manifest || std::rename((manifestPath + ".tmp").c_str(), manifestPath.c_str()) != 0) {
+		return false;
+	}
+
+	//Файлы прежнего поколения и недописанных снимков больше не нужны
+	const std::string extension = "." + std::to_string(generation);
+	std::vector<std::filesystem::path> stale;
+	for (const auto& file : std::filesystem::directory_iterator(directory, error)) {
+		if (file.path().filename() != SNAPSHOT_MANIFEST && file.path().extension() != extension) {
+			stale.push_back(file.path());
+		}
+	}
+	for (const auto& path : stale) {
+		std::filesystem::remove(path, error);
+	}
+
+	//Снимок ссылается на файл хранилища на момент копии - прежние больше не нужны
+	//(файлы, ставшие прежними во время записи, удалит следующий снимок)
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	for (const auto& path : saved.staleColdFiles) {
+		std::remove(path.c_str());
+		staleColdFiles.erase(std::remove(staleColdFiles.begin(), staleColdFiles.end(), path),
+			staleColdFiles.end());
+	}
+	return true;
+}
+
+
+
+static void copySnapshot(size_t segments, SavedData& saved)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	//Удалённые пользователи, чьи сообщения ещё не вычищены - их сообщения
+	//(в списках, на диске и в комнатах) в снимок не попадают
+	std::unordered_set<uint64_t> removed = purging;
+	for (const auto& tombstone : tombstones) {
+		removed.insert(tombstone.node.mapped().getId());
+	}
+
+	//Распределить пользователей по сегментам по хэшу Логина
+	saved.parts.resize(segments);
+	for (const auto& dataPair : userData) {
+		const User& user = dataPair.second;
+		const size_t segment = std::hash<std::string>()(dataPair.first) % segments;
+		saved.parts[segment].emplace_back();
+		SavedUser& copy = saved.parts[segment].back();
+		copy.name = user.getName();
+		copy.login = user.getLogin();
+		copy.id = user.getId();
+		copy.credential = user.getCredential();
+		copy.lastSequence = user.getLastSequence();
+		auto policy = userRetention.find(dataPair.first);
+		copy.hasPolicy = policy != userRetention.end();
+		if (copy.hasPolicy) {
+			copy.policy = policy->second;
+		}
+
+		//Сообщения в памяти - текст общий с базой и не копируется. Сообщения с диска
+		//в снимок не копируются - сохраняется только индекс: файл хранилища
+		//дописывается, но не изменяется
+		const auto messages = user.getMessageList();
+		copy.messages.reserve(messages->size());
+		for (const auto& message : *messages) {
+			if (removed.count(message.getSenderId()) == 0) {
+				copy.messages.push_back(message);
+			}
+		}
+		coldStore.getEntries(dataPair.first, copy.entries);
+		if (!removed.empty()) {
+			copy.entries.erase(std::remove_if(copy.entries.begin(), copy.entries.end(),
+				[&removed](const ColdStore::Entry& entry) {
+					return removed.count(entry.sender) != 0;
+				}), copy.entries.end());
+		}
+	}
+
+	saved.rooms = rooms;
+	if (!removed.empty()) {
+		for (auto& room : saved.rooms) {
+			std::deque<Message> kept;
+			for (const auto& message : room.second.log) {
+				if (removed.count(message.getSenderId()) == 0) {
+					kept.push_back(message);
+				}
+			}
+			room.second.log.swap(kept);
+		}
+	}
+	saved.conversations = conversations;
+	saved.unread = unread;
+	saved.coldGeneration = coldGeneration;
+	saved.staleColdFiles = staleColdFiles;
+	//Индекс ссылается только на записи, уже сброшенные в файл - сбрасывать нечего
+}
+
+
+
+bool database::load(const std::string& directory, size_t threads)
+{
+	size_t segments = 0;
+	uint64_t storeGeneration = 0;
+	uint64_t generation = 0;
+	if (!readManifest(directory, segments, storeGeneration, generation)) {
+		return false;
+	}
+
+	if (threads == 0) {
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+	threads = std::min(threads, segments);
+
+	//Тексты сообщений - до сегментов: потоки только читают таблицу
+	Texts texts;
+	if (!readTexts(snapshotPath(directory, SNAPSHOT_TEXTS, generation), texts)) {
+		return false;
+	}
+
+	//Каждый поток декодирует свои сегменты в собственный список
+	std::vector<std::vector<User> > parts(segments);
+	std::vector<std::vector<std::pair<std::string, Retention> > > policies(segments);
+	std::vector<std::vector<ColdIndex> > coldIndexes(segments);
+	std::vector<char> isDecoded(segments, false);
+	//Исключение потока (например, нехватка памяти) передаётся вызывающему
+	std::vector<std::exception_ptr> errors(threads);
+	std::vector<std::thread> workers;
+	for (size_t worker = 0; worker < threads; ++worker) {
+		workers.emplace_back([&, worker]() {
+			try {
+				for (size_t segment = worker; segment < segments; segment += threads) {
+					isDecoded[segment] = loadSegment(segmentPath(directory, segment, generation),
+						texts, parts[segment], policies[segment], coldIndexes[segment]);
+				}
+			}
+			catch (...) {
+				errors[worker] = std::current_exception();
+			}
+		});
+	}
+	for (auto& thread : workers) {
+		thread.join();
+	}
+	for (const auto& error : errors) {
+		if (error) {
+			std::rethrow_exception(error);
+		}
+	}
+
+	for (size_t segment = 0; segment < segments; ++segment) {
+		if (!isDecoded[segment]) {
+			return false;
+		}
+	}
+
+	std::map<std::string, Room> loadedRooms;
+	if (!readRooms(snapshotPath(directory, SNAPSHOT_ROOMS, generation), loadedRooms)) {
+		return false;
+	}
+	std::map<std::pair<std::string, std::string>, Conversation> loadedConversations;
+	if (!readConversations(snapshotPath(directory, SNAPSHOT_CONVERSATIONS, generation),
+			loadedConversations)) {
+		return false;
+	}
+	std::unordered_map<std::string, UserUnread> loadedUnread;
+	if (!readUnread(snapshotPath(directory, SNAPSHOT_UNREAD, generation), loadedUnread)) {
+		return false;
+	}
+
+	//Слить сегменты в таблицу пользователей и индексы. Слияние последовательное:
+	//вставки в дерево не распараллеливаются, пользователи только перемещаются
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	database::clear();
+	for (auto& part : parts) {
+		for (auto& user : part) {
+			size_t userBytes = 0;
+			for (const auto& message : *user.getMessageList()) {
+				userBytes += getMessageSize(message);
+			}
+			user.setMessageBytes(userBytes);
+			hotBytes += userBytes;
+			//Сообщения удалённых в снимок не попадают - номера после наибольшего свободны
+			lastUserId = std::max(lastUserId, user.getId());
+			nameIndex.emplace(user.getName(), user.getLogin());
+			std::string login = user.getLogin();
+			auto inserted = userData.emplace(login, std::move(user)).first;
+			userIds.emplace(std::move(login),
+				userTable.insert(inserted->second.getName(), &inserted->second));
+		}
+	}
+	for (auto& part : policies) {
+		userRetention.insert(part.begin(), part.end());
+	}
+	//Индекс хранилища относится к файлу поколения из снимка
+	for (auto& part : coldIndexes) {
+		for (auto& index : part) {
+			coldStore.restore(index.first, std::move(index.second));
+		}
+	}
+	coldGeneration = storeGeneration;
+	if (!coldStorePath.empty()) {
+		coldStore.open(coldFilePath(coldGeneration));
+	}
+	for (auto& room : loadedRooms) {
+		for (const auto& cursor : room.second.cursors) {
+			userRooms[cursor.first].insert(room.first);
+		}
+	}
+	rooms = std::move(loadedRooms);
+	for (const auto& conversation : loadedConversations) {
+		userPeers[conversation.first.first].insert(conversation.first.second);
+		userPeers[conversation.first.second].insert(conversation.first.first);
+	}
+	conversations = std::move(loadedConversations);
+	unread = std::move(loadedUnread);
+	rebuildFilters();
+	return true;
+}
+
+
+
+bool database::hasSnapshot(const std::string& directory)
+{
+	return std::filesystem::exists(directory + "/" + SNAPSHOT_MANIFEST);
+}
+
+
+
+//-----------------------------------------------------------------------------
+static std::string getLoginByName(const std::string& name)
+{
+	auto index = nameIndex.find(name);
+	//Пользователь не зарегистрирован
+	if (index == nameIndex.end()) {
+		return "";
+	}
+	return index->second;
+}
+
+
+
+static void rebuildFilters()
+{
+	//Размер - степень двойки с запасом вдвое, чтобы не перестраивать на каждом добавлении
+	size_t counters = FILTER_MIN_COUNTERS;
+	while (counters < userData.size() * FILTER_COUNTERS_PER_KEY * 2) {
+		counters *= 2;
+	}
+	loginFilter.reset(counters);
+	nameFilter.reset(counters);
+	for (const auto& dataPair : userData) {
+		loginFilter.add(dataPair.first);
+		nameFilter.add(dataPair.second.getName());
+	}
+}
+
+
+
+static void writeString(std::ostream& stream, const std::string& value)
+{
+	writeValue<uint32_t>(stream, value.size());
+	stream.write(value.data(), value.size());
+}
+
+
+
+static bool readString(std::istream& stream, std::string& value)
+{
+	uint32_t length = 0;
+	if (!readValue(stream, length) || length > getRemaining(stream)) {
+		return false;
+	}
+	value.resize(length);
+	stream.read(&value[0], length);
+	return static_cast<bool>(stream);
+}
+
+
+
+static bool readFile(const std::string& path, std::istringstream& stream)
+{
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file) {
+		return false;
+	}
+	std::string content(static_cast<size_t>(file.tellg()), '\0');
+	file.seekg(0);
+	file.read(&content[0], content.size());
+	if (!file) {
+		return false;
+	}
+	stream.str(std::move(content));
+	return true;
+}
+
+
+
+static uint64_t getRemaining(std::istream& stream)
+{
+	//У потока в памяти в буфере весь непрочитанный остаток
+	const std::streamsize remaining = stream.rdbuf()->in_avail();
+	return remaining > 0 ? static_cast<uint64_t>(remaining) : 0;
+}
+
+
+
+static bool readManifest(const std::string& directory, size_t& segments,
+	uint64_t& storeGeneration, uint64_t& generation)
+{
+	std::ifstream manifest(directory + "/" + SNAPSHOT_MANIFEST);
+	return (manifest >> segments >> storeGeneration >> generation) && segments != 0;
+}
+
+
+
+static std::string snapshotPath(const std::string& directory, const std::string& name,
+	uint64_t generation)
+{
+	return directory + "/" + name + "." + std::to_string(generation);
+}
+
+
+
+template <typename T>
+static void writeValue(std::ostream& stream, T value)
+{
+	stream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+
+
+template <typename T>
+static bool readValue(std::istream& stream, T& value)
+{
+	stream.read(reinterpret_cast<char*>(&value), sizeof(value));
+	return static_cast<bool>(stream);
+}
+
+
+
+static std::string segmentPath(const std::string& directory, size_t segment,
+	uint64_t generation)
+{
+	return snapshotPath(directory, SNAPSHOT_SEGMENT + std::to_string(segment), generation);
+}
+
+
+
+static bool loadSegment(const std::string& path, const Texts& texts, std::vector<User>& users,
+	std::vector<std::pair<std::string, database::Retention> >& policies,
+	std::vector<ColdIndex>& coldIndexes)
+{
+	std::istringstream stream;
+	if (!readFile(path, stream)) {
+		return false;
+	}
+	uint32_t magic = 0;
+	uint32_t version = 0;
+	uint64_t numberUsers = 0;
+	if (!readValue(stream, magic) || !readValue(stream, version) ||
+			!readValue(stream, numberUsers)) {
+		return false;
+	}
+	//Чужой файл или неизвестная версия формата
+	if (magic != SNAPSHOT_MAGIC || version != SNAPSHOT_VERSION) {
+		return false;
+	}
+
+	//Запись пользователя не короче байта - больший счётчик испорчен
+	if (numberUsers > getRemaining(stream)) {
+		return false;
+	}
+	users.reserve(numberUsers);
+	for (uint64_t i = 0; i < numberUsers; ++i) {
+		std::string name;
+		std::string login;
+		uint64_t id = 0;
+		credential::Record credential;
+		uint64_t lastSequence = 0;
+		uint8_t hasPolicy = 0;
+		if (!readString(stream, name) || !readString(stream, login) || !readValue(stream, id) ||
+				!readValue(stream, credential.iterations) || !readValue(stream, credential.salt) ||
+				!readValue(stream, credential.key) || !readValue(stream, lastSequence) ||
+				!readValue(stream, hasPolicy)) {
+			return false;
+		}
+
+		if (hasPolicy) {
+			uint64_t maxCount = 0;
+			uint64_t maxBytes = 0;
+			int64_t maxAge = 0;
+			if (!readValue(stream, maxCount) || !readValue(stream, maxBytes) ||
+					!readValue(stream, maxAge)) {
+				return false;
+			}
+			database::Retention policy;
+			policy.maxCount = maxCount;
+			policy.maxBytes = maxBytes;
+			policy.maxAge = maxAge;
+			policies.emplace_back(login, policy);
+		}
+
+		uint64_t numberMessages = 0;
+		if (!readValue(stream, numberMessages)) {
+			return false;
+		}
+		users.emplace_back(name, login, credential);
+		users.back().setId(id);
+		users.back().setLastSequence(lastSequence);
+		auto messages = users.back().getMessageList();
+		for (uint64_t j = 0; j < numberMessages; ++j) {
+			std::string nameFrom;
+			uint64_t text = 0;
+			int64_t time = 0;
+			uint64_t sequence = 0;
+			uint64_t sender = 0;
+			if (!readString(stream, nameFrom) || !readValue(stream, text) ||
+					!readValue(stream, time) || !readValue(stream, sequence) ||
+					!readValue(stream, sender) || text >= texts.size()) {
+				return false;
+			}
+			//Сообщения в сегменте идут в том же порядке, что и в списке
+			messages->emplace_back(nameFrom, texts[text], time, sequence, sender);
+		}
+		users.back().indexMessages();
+
+		uint64_t numberEntries = 0;
+		if (!readValue(stream, numberEntries)) {
+			return false;
+		}
+		std::deque<ColdStore::Entry> entries;
+		for (uint64_t j = 0; j < numberEntries; ++j) {
+			ColdStore::Entry entry;
+			int64_t time = 0;
+			if (!readValue(stream, entry.sequence) || !readValue(stream, time) ||
+					!readValue(stream, entry.sender) || !readValue(stream, entry.offset) || !readValue(stream, entry.size) ||
+					!readValue(stream, entry.length)) {
+				return false;
+			}
+			entry.time = time;
+			entries.push_back(entry);
+		}
+		if (!entries.empty()) {
+			coldIndexes.emplace_back(login, std::move(entries));
+		}
+	}
+	return true;
+}
+
+
+
+static bool writeTexts(const std::string& path, const std::vector<const std::string*>& texts)
+{
+	std::ofstream stream(path + ".tmp", std::ios::binary | std::ios::trunc);
+	if (!stream) {
+		return false;
+	}
+
+	writeValue<uint32_t>(stream, SNAPSHOT_MAGIC);
+	writeValue<uint32_t>(stream, SNAPSHOT_VERSION);
+	writeValue<uint64_t>(stream, texts.size());
+	for (const std::string* text : texts) {
+		writeString(stream, *text);
+	}
+	stream.close();
+	return stream && std::rename((path + ".tmp").c_str(), path.c_str()) == 0;
+}
+
+
+
+static bool readTexts(const std::string& path, Texts& result)
+{
+	std::istringstream stream;
+	if (!readFile(path, stream)) {
+		return false;
+	}
+	uint32_t magic = 0;
+	uint32_t version = 0;
+	uint64_t numberTexts = 0;
+	if (!readValue(stream, magic) || !readValue(stream, version) ||
+			!readValue(stream, numberTexts)) {
+		return false;
+	}
+	if (magic != SNAPSHOT_MAGIC || version != SNAPSHOT_VERSION ||
+			numberTexts > getRemaining(stream)) {
+		return false;
+	}
+
+	result.reserve(numberTexts);
+	for (uint64_t i = 0; i < numberTexts; ++i) {
+		std::string text;
+		if (!readString(stream, text)) {
+			return false;
+		}
+		result.push_back(std::make_shared<const std::string>(std::move(text)));
+	}
+	return true;
+}
+
+
+
+static bool writeRooms(const std::string& path, const std::map<std::string, Room>& savedRooms)
+{
+	std::ofstream stream(path + ".tmp", std::ios::binary | std::ios::trunc);
+	if (!stream) {
+		return false;
+	}
+
+	writeValue<uint32_t>(stream, SNAPSHOT_MAGIC);
+	writeValue<uint32_t>(stream, SNAPSHOT_VERSION);
+	writeValue<uint64_t>(stream, savedRooms.size());
+	for (const auto& room : savedRooms) {
+		writeString(stream, room.first);
+		writeValue<uint64_t>(stream, room.second.lastSequence);
+		writeValue<uint64_t>(stream, room.second.cursors.size());
+		for (const auto& cursor : room.second.cursors) {
+			writeString(stream, cursor.first);
+			writeValue<uint64_t>(stream, cursor.second);
+		}
+		writeValue<uint64_t>(stream, room.second.log.size());
+		for (const auto& message : room.second.log) {
+			writeString(stream, message.getNameFrom());
+			writeString(stream, message.getText());
+			writeValue<int64_t>(stream, message.getTime());
+			writeValue<uint64_t>(stream, message.getSequence());
+			writeValue<uint64_t>(stream, message.getSenderId());
+		}
+	}
+	stream.close();
+	return stream && std::rename((path + ".tmp").c_str(), path.c_str()) == 0;
+}
+
+
+
+static bool readRooms(const std::string& path, std::map<std::string, Room>& result)
+{
+	std::istringstream stream;
+	if (!readFile(path, stream)) {
+		return false;
+	}
+	uint32_t magic = 0;
+	uint32_t version = 0;
+	uint64_t numberRooms = 0;
+	if (!readValue(stream, magic) || !readValue(stream, version) ||
+			!readValue(stream, numberRooms)) {
+		return false;
+	}
+	if (magic != SNAPSHOT_MAGIC || version != SNAPSHOT_VERSION) {
+		return false;
+	}
+
+	for (uint64_t i = 0; i < numberRooms; ++i) {
+		std::string name;
+		Room room;
+		uint64_t numberMembers = 0;
+		if (!readString(stream, name) || !readValue(stream, room.lastSequence) ||
+				!readValue(stream, numberMembers)) {
+			return false;
+		}
+		for (uint64_t j = 0; j < numberMembers; ++j) {
+			std::string login;
+			uint64_t cursor = 0;
+			if (!readString(stream, login) || !readValue(stream, cursor)) {
+				return false;
+			}
+			room.cursors.emplace(std::move(login), cursor);
+		}
+
+		uint64_t numberMessages = 0;
+		if (!readValue(stream, numberMessages)) {
+			return false;
+		}
+		for (uint64_t j = 0; j < numberMessages; ++j) {
+			std::string nameFrom;
+			std::string text;
+			int64_t time = 0;
+			uint64_t sequence = 0;
+			uint64_t sender = 0;
+			if (!readString(stream, nameFrom) || !readString(stream, text) ||
+					!readValue(stream, time) || !readValue(stream, sequence) ||
+					!readValue(stream, sender)) {
+				return false;
+			}
+			room.log.emplace_back(nameFrom, text, time, sequence, sender);
+		}
+		result.emplace(std::move(name), std::move(room));
+	}
+	return true;
+}
+
+
+
+static bool writeConversations(const std::string& path,
+	const std::map<std::pair<std::string, std::string>, Conversation>& savedConversations)
+{
+	std::ofstream stream(path + ".tmp", std::ios::binary | std::ios::trunc);
+	if (!stream) {
+		return false;
+	}
+
+	writeValue<uint32_t>(stream, SNAPSHOT_MAGIC);
+	writeValue<uint32_t>(stream, SNAPSHOT_VERSION);
+	writeValue<uint64_t>(stream, savedConversations.size());
+	for (const auto& conversation : savedConversations) {
+		writeString(stream, conversation.first.first);
+		writeString(stream, conversation.first.second);
+		writeValue<uint64_t>(stream, conversation.second.lastSequence);
+		writeValue<uint64_t>(stream, conversation.second.log.size());
+		for (const auto& entry : conversation.second.log) {
+			writeValue<uint64_t>(stream, entry.sequence);
+			writeValue<uint64_t>(stream, entry.inboxSequence);
+			writeValue<uint8_t>(stream, entry.isToFirst);
+		}
+	}
+	stream.close();
+	return stream && std::rename((path + ".tmp").c_str(), path.c_str()) == 0;
+}
+
+
+
+static bool readConversations(const std::string& path,
+	std::map<std::pair<std::string, std::string>, Conversation>& result)
+{
+	std::istringstream stream;
+	if (!readFile(path, stream)) {
+		return false;
+	}
+	uint32_t magic = 0;
+	uint32_t version = 0;
+	uint64_t numberConversations = 0;
+	if (!readValue(stream, magic) || !readValue(stream, version) ||
+			!readValue(stream, numberConversations)) {
+		return false;
+	}
+	if (magic != SNAPSHOT_MAGIC || version != SNAPSHOT_VERSION) {
+		return false;
+	}
+
+	for (uint64_t i = 0; i < numberConversations; ++i) {
+		std::string login;
+		std::string peer;
+		Conversation conversation;
+		uint64_t numberMessages = 0;
+		if (!readString(stream, login) || !readString(stream, peer) ||
+				!readValue(stream, conversation.lastSequence) ||
+				!readValue(stream, numberMessages)) {
+			return false;
+		}
+		if (numberMessages > getRemaining(stream)) {
+			return false;
+		}
+		for (uint64_t j = 0; j < numberMessages; ++j) {
+			ConversationEntry entry;
+			uint8_t isToFirst = 0;
+			if (!readValue(stream, entry.sequence) || !readValue(stream, entry.inboxSequence) ||
+					!readValue(stream, isToFirst)) {
+				return false;
+			}
+			entry.isToFirst = isToFirst != 0;
+			conversation.log.push_back(entry);
+		}
+		result.emplace(std::make_pair(std::move(login), std::move(peer)),
+			std::move(conversation));
+	}
+	return true;
+}
+
+
+
+static bool writeUnread(const std::string& path,
+	const std::unordered_map<std::string, UserUnread>& savedUnread)
+{
+	std::ofstream stream(path + ".tmp", std::ios::binary | std::ios::trunc);
+	if (!stream) {
+		return false;
+	}
+
+	writeValue<uint32_t>(stream, SNAPSHOT_MAGIC);
+	writeValue<uint32_t>(stream, SNAPSHOT_VERSION);
+	writeValue<uint64_t>(stream, savedUnread.size());
+	for (const auto& userUnread : savedUnread) {
+		writeString(stream, userUnread.first);
+		writeValue<uint64_t>(stream, userUnread.second.peers.size());
+		for (const auto& peer : userUnread.second.peers) {
+			writeString(stream, peer.first);
+			writeValue<uint64_t>(stream, peer.second.lastRead);
+			writeValue<uint64_t>(stream, peer.second.sequences.size());
+			for (uint64_t sequence : peer.second.sequences) {
+				writeValue<uint64_t>(stream, sequence);
+			}
+		}
+	}
+	stream.close();
+	return stream && std::rename((path + ".tmp").c_str(), path.c_str()) == 0;
+}
+
+
+
+static bool readUnread(const std::string& path,
+	std::unordered_map<std::string, UserUnread>& result)
+{
+	std::istringstream stream;
+	if (!readFile(path, stream)) {
+		return false;
+	}
+	uint32_t magic = 0;
+	uint32_t version = 0;
+	uint64_t numberUsers = 0;
+	if (!readValue(stream, magic) || !readValue(stream, version) ||
+			!readValue(stream, numberUsers)) {
+		return false;
+	}
+	if (magic != SNAPSHOT_MAGIC || version != SNAPSHOT_VERSION) {
+		return false;
+	}
+
+	for (uint64_t i = 0; i < numberUsers; ++i) {
+		std::string login;
+		uint64_t numberPeers = 0;
+		if (!readString(stream, login) || !readValue(stream, numberPeers)) {
+			return false;
+		}
+		UserUnread& userUnread = result[login];
+		for (uint64_t j = 0; j < numberPeers; ++j) {
+			std::string peer;
+			if (!readString(stream, peer)) {
+				return false;
+			}
+			PeerUnread& peerUnread = userUnread.peers[peer];
+			uint64_t numberSequences = 0;
+			if (!readValue(stream, peerUnread.lastRead) || !readValue(stream, numberSequences)) {
+				return false;
+			}
+			for (uint64_t k = 0; k < numberSequences; ++k) {
+				uint64_t sequence = 0;
+				if (!readValue(stream, sequence)) {
+					return false;
+				}
+				peerUnread.sequences.push_back(sequence);
+			}
+			userUnread.total += numberSequences;
+		}
+	}
+	return true;
+}
+
+
+
+static size_t trimMessages(const std::string& login,
+													User& user,
+													const database::Retention& policy,
+													std::time_t now,
+													database::Garbage& garbage)
+{
+	//Новые сообщения в начале списка - найти первое, которое хранить не нужно
+	auto messages = user.getMessageList();
+	size_t count = 0;
+	size_t bytes = 0;
+	auto message = messages->begin();
+	for (; message != messages->end(); ++message) {
+		bytes += database::getMessageSize(*message);
+		++count;
+		if ((policy.maxCount != 0 && count > policy.maxCount) ||
+				(policy.maxBytes != 0 && bytes > policy.maxBytes) ||
+				(policy.maxAge != 0 && now - message->getTime() > policy.maxAge)) {
+			break;
+		}
+	}
+
+	//В памяти ограничение не достигнуто - остаток ограничения действует на диске
+	if (message == messages->end()) {
+		if ((policy.maxCount != 0 && count == policy.maxCount) ||
+				(policy.maxBytes != 0 && bytes == policy.maxBytes)) {
+			coldStore.erase(login);
+		}
+		else {
+			coldStore.trim(login,
+										policy.maxCount != 0 ? policy.maxCount - count : 0,
+										policy.maxBytes != 0 ? policy.maxBytes - bytes : 0,
+										policy.maxAge != 0 ? now - policy.maxAge : 0);
+		}
+		return 0;
+	}
+	//Всё, что старше отделённого хвоста, на диске тоже не нужно
+	coldStore.erase(login);
+
+	return detachTail(user, message, bytes - database::getMessageSize(*message), garbage);
+}
+
+
+
+static void selectSpill(const std::string& login,
+												const User& user,
+												size_t allowance,
+												std::vector<ColdStore::Batch>& spills)
+{
+	//Доля не превышена - список не обходится
+	if (user.getMessageBytes() <= allowance) {
+		return;
+	}
+
+	//Найти первое сообщение, не помещающееся в долю пользователя
+	const auto messages = user.getMessageList();
+	size_t bytes = 0;
+	auto message = messages->begin();
+	for (; message != messages->end(); ++message) {
+		bytes += database::getMessageSize(*message);
+		if (bytes > allowance) {
+			break;
+		}
+	}
+	if (message == messages->end()) {
+		return;
+	}
+
+	//Хвост копируется от старых к новым - тексты общие, копии дешёвые
+	ColdStore::Batch spill;
+	spill.login = login;
+	spill.messages.reserve(std::distance(message, messages->end()));
+	for (auto oldest = messages->rbegin(); oldest.base() != message; ++oldest) {
+		spill.messages.push_back(*oldest);
+	}
+	spills.push_back(std::move(spill));
+}
+
+
+
+static size_t commitSpill(const ColdStore::Batch& spill, database::Garbage& garbage)
+{
+	auto user = userData.find(spill.login);
+	if (user == userData.end() || spill.entries.empty()) {
+		return 0;
+	}
+
+	//Пока шла запись, старые сообщения могли быть удалены (trim, erase) - переносится
+	//только совпадающее начало пакета, остальные записи файла станут мёртвыми
+	auto messages = user->second.getMessageList();
+	auto oldest = messages->rbegin();
+	size_t count = 0;
+	size_t spilledBytes = 0;
+	for (; count < spill.entries.size() && oldest != messages->rend(); ++count, ++oldest) {
+		const Message& written = spill.messages[count];
+		if (oldest->getSequence() != written.getSequence() ||
+				&oldest->getText() != &written.getText()) {
+			break;
+		}
+		spilledBytes += database::getMessageSize(*oldest);
+	}
+	if (count == 0) {
+		return 0;
+	}
+
+	coldStore.commit(spill.login, std::deque<ColdStore::Entry>(spill.entries.begin(),
+																															spill.entries.begin() + count));
+	return detachTail(user->second, oldest.base(),
+										user->second.getMessageBytes() - spilledBytes, garbage);
+}
+
+
+
+static size_t detachTail(User& user, std::list<Message>::iterator first,
+												size_t keptBytes, database::Garbage& garbage)
+{
+	//Начало списка переносится в новый список, а список пользователя меняется
+	//с ним местами - так хвост не обходится ради подсчёта размера при splice
+	std::list<Message>& messages = *user.getMessageList();
+	std::list<Message> kept;
+	kept.splice(kept.end(), messages, messages.begin(), first);
+	kept.swap(messages);
+
+	const size_t detachedBytes = user.getMessageBytes() - keptBytes;
+	user.setMessageBytes(keptBytes);
+	hotBytes -= detachedBytes;
+	garbage.count += kept.size();
+	garbage.lists.push_back(std::move(kept));
+	return detachedBytes;
+}
+
+
+
+static void pruneConversations(const std::string& login)
+{
+	auto peers = userPeers.find(login);
+	if (peers == userPeers.end()) {
+		return;
+	}
+	const uint64_t first = getFirstSequence(login);
+	for (const auto& peer : peers->second) {
+		auto conversation = conversations.find(conversationKey(login, peer));
+		if (conversation == conversations.end()) {
+			continue;
+		}
+		//Записи обоих адресатов идут вперемешку - граница нужна для каждого
+		const bool isFirst = conversation->first.first == login;
+		const uint64_t peerFirst = (peer == login) ? first : getFirstSequence(peer);
+		std::deque<ConversationEntry>& log = conversation->second.log;
+		while (!log.empty() &&
+				log.front().inboxSequence < (log.front().isToFirst == isFirst ? first : peerFirst)) {
+			log.pop_front();
+		}
+	}
+}
+
+
+
+static uint64_t getFirstSequence(const std::string& login)
+{
+	const uint64_t cold = coldStore.getFirstSequence(login);
+	if (cold != 0) {
+		return cold;
+	}
+	const User& user = userData[login];
+	const auto messages = user.getMessageList();
+	return messages->empty() ? user.getLastSequence() + 1 : messages->back().getSequence();
+}
+
+
+
+static void rewriteColdStore()
+{
+	uint64_t generation = 0;
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+		if (!coldStore.isOpen() || coldStorePath.empty()) {
+			return;
+		}
+		const uint64_t deadBytes = coldStore.getFileBytes() - coldStore.getLiveBytes();
+		if (deadBytes < COLD_REWRITE_MIN_BYTES || deadBytes <= coldStore.getLiveBytes()) {
+			return;
+		}
+		generation = coldGeneration + 1;
+	}
+
+	//Новое поколение - в свободный файл: существующие могут быть нужны снимкам
+	while (std::filesystem::exists(coldFilePath(generation))) {
+		++generation;
+	}
+
+	//Индекс снимается под блокировкой, файл копируется без неё
+	ColdStore::Rewrite rewrite;
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+		if (!coldStore.beginRewrite(coldFilePath(generation), rewrite)) {
+			return;
+		}
+	}
+	if (!ColdStore::writeRewrite(rewrite)) {
+		return;
+	}
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	const std::string previous = coldStore.getPath();
+	if (coldStore.finishRewrite(rewrite)) {
+		staleColdFiles.push_back(previous);
+		coldGeneration = generation;
+	}
+}
+
+
+
+static std::string coldFilePath(uint64_t generation)
+{
+	return coldStorePath + "." + std::to_string(generation);
+}
+
+
+
+//=============================================================================
+static void testIsExistLogin();
+static void testIsExistName();
+static void testIsCorrectPassword();
+static void testPushMessage();
+static void testPushMessages();
+static void testLoadMessages();
+static void testRemoveUser();
+static void testGetNameByLogin();
+static void testGetLoginByName();
+static void testGetNumberUser();
+static void testLoadUserNames();
+static void testSaveLoad();
+static void testCompact();
+static void testColdStore();
+static void testReclaim();
+static void testSetNickname();
+static void testDirectoryChanges();
+static void testFindNicknames();
+static void testFilters();
+static void testRooms();
+static void testConversations();
+static void testLoadMessagesByTime();
+static void testUnread();
+
+//Создать для теста каталог с уникальным именем во временном каталоге
+static std::string makeTestDirectory();
+
+
+void database::test()
+{
+	testIsExistLogin();
+	testIsExistName();
+	testIsCorrectPassword();
+	testPushMessage();
+	testPushMessages();
+	testLoadMessages();
+	testRemoveUser();
+	testGetNameByLogin();
+	testGetLoginByName();
+	testGetNumberUser();
+	testLoadUserNames();
+	testSaveLoad();
+	testCompact();
+	testColdStore();
+	testReclaim();
+	testSetNickname();
+	testDirectoryChanges();
+	testFindNicknames();
+	testFilters();
+	testRooms();
+	testConversations();
+	testLoadMessagesByTime();
+	testUnread();
+
+	//После тестов база должна быть пуста
+	assert(userData.empty() == true);
+	assert(userTable.size() == 0);
+	assert(rooms.empty() == true);
+	assert(conversations.empty() == true);
+	assert(unread.empty() == true);
+}
+
+
+
+static void testIsExistLogin()
+{
+	//Поместить тестовое значение
+	const std::string login = "login";
+	database::addUser("name", login, credential::make(sha_1::digest("password")));
+
+	assert(database::isLoginRegistered(login) == true);
+	assert(database::isLoginRegistered("incorrect_login") == false);
+
+	//Очистить от тестовых значений
+	database::clear();
+}
+
+
+
+static void testIsExistName()
+{
+	//Поместить тестовое значение
+	const std::string name = "name";
+	database::addUser(name, "login", credential::make(sha_1::digest("password")));
+
+	assert(database::isNicknameRegistered(name) == true);
+	assert(database::isNicknameRegistered("incorrect_name") == false);
+
+	//Очистить от тестовых значений
+	database::clear();
+}
+
+
+
+static void testIsCorrectPassword()
+{
+	//Поместить тестовое значение
+	const std::string login = "login";
+	const std::string password = "password";
+	database::addUser("name", login, credential::make(sha_1::digest(password)));
+
+	assert(database::isPasswordRight(login, sha_1::digest(password)) == true);
+	assert(database::isPasswordRight(login, sha_1::digest("incorrect_password")) == false);
+	assert(database::isPasswordRight("incorrect_login", sha_1::digest(password)) == false);
+
+	//Соль у каждой записи своя - одинаковые пароли хранятся разными ключами
+	database::addUser("name_2", "login_2", credential::make(sha_1::digest(password)));
+	assert(database::isPasswordRight("login_2", sha_1::digest(password)) == true);
+	assert(userData[login].getCredential().key != userData["login_2"].getCredential().key);
+
+	//Очистить от тестовых значений
+	database::clear();
+}
+
+
+
+static void testPushMessage()
+{
+	//Поместить тестовое значение
+	User user_1("name_1", "login_1", credential::Record());
+	User user_2("name_2", "login_2", credential::Record());
+	User user_3("name_3", "login_3", credential::Record());
+
+	database::addUser(user_1.getName(), user_1.getLogin(), credential::Record());
+	database::addUser(user_2.getName(), user_2.getLogin(), credential::Record());
+	database::addUser(user_3.getName(), user_3.getLogin(), credential::Record());
+
+	//Собщение User_1 -> User_2
+	const std::string nameFromUser = user_1.getName();
+	const std::string nameToUser = user_2.getName();
+	const std::string textToUser = "Hello " + nameToUser;
+	database::pushMessage(nameToUser, Message(nameFromUser, textToUser));
+
+	//Собщение User_2 -> ALL
+	const std::string nameFromToAll = user_2.getName();
+	const std::string nameToAll = MSG_TO_ALL;
+	const std::string textToAll = "Hello ALL";
+	database::pushMessage(nameToAll, Message(nameFromToAll, textToAll));
+
+	assert(userData[user_1.getLogin()].getMessageList()->back().getNameFrom() == nameFromToAll);
+	assert(userData[user_1.getLogin()].getMessageList()->back().getText() == textToAll);
+	assert(userData[user_1.getLogin()].getMessageList()->size() == 1);
+
+	assert(userData[user_2.getLogin()].getMessageList()->back().getNameFrom() == nameFromUser);
+	assert(userData[user_2.getLogin()].getMessageList()->back().getText() == textToUser);
+	assert(userData[user_2.getLogin()].getMessageList()->front().getNameFrom() == nameFromToAll);
+	assert(userData[user_2.getLogin()].getMessageList()->front().getText() == textToAll);
+	assert(userData[user_2.getLogin()].getMessageList()->size() == 2);
+
+	assert(userData[user_3.getLogin()].getMessageList()->back().getNameFrom() == nameFromToAll);
+	assert(userData[user_3.getLogin()].getMessageList()->back().getText() == textToAll);
+	assert(userData[user_3.getLogin()].getMessageList()->size() == 1);
+
+	//Очистить от тестовых значений
+	database::clear();
+}
+
+
+
+static void testPushMessages()
+{
+	//Поместить тестовые значения
+	database::addUser("name_1", "login_1", credential::Record());
+	database::addUser("name_2", "login_2", credential::Record());
+	database::addUser("name_3", "login_3", credential::Record());
+
+	//Несколько адресатов, в том числе незарегистрированный и повтор
+	std::vector<bool> delivered;
+	database::pushMessage({"name_1", "not_exist_name", "name_3", "name_1", "all"},
+												Message("name_2", "text"), delivered);
+	assert(delivered.size() == 5);
+	assert(delivered[0] == true);
+	assert(delivered[1] == false);
+	assert(delivered[2] == true);
+	assert(delivered[3] == true);
+	assert(delivered[4] == false);
+
+	//Каждому по одному сообщению, текст общий
+	const auto& messages_1 = *userData["login_1"].getMessageList();
+	const auto& messages_3 = *userData["login_3"].getMessageList();
+	assert(messages_1.size() == 1);
+	assert(messages_3.size() == 1);
+	assert(userData["login_2"].getMessageList()->empty() == true);
+	assert(messages_1.front().getText() == "text");
+	assert(&messages_1.front().getText() == &messages_3.front().getText());
+
+	//Очистить от тестовых значений
+	database::clear();
+}
+
+
+
+static void testLoadMessages()
+{
+	//Поместить тестовое значение
+	User user_1("name_1", "login_1", credential::Record());
+	User user_2("name_2", "login_2", credential::Record());
+	User user_3("name_3", "login_3", credential::Record());
+
+	database::addUser(user_1.getName(), user_1.getLogin(), credential::Record());
+	database::addUser(user_2.getName(), user_2.getLogin(), credential::Record());
+	database::addUser(user_3.getName(), user_3.getLogin(), credential::Record());
+
+	//Собщение User_1 -> User_2
+	const std::string nameFromUser = user_1.getName();
+	const std::string nameToUser = user_2.getName();
+	const std::string textToUser = "Hello " + nameToUser;
+	database::pushMessage(nameToUser, Message(nameFromUser, textToUser));
+
+	//Собщение User_2 -> ALL
+	const std::string nameFromToAll = user_2.getName();
+	const std::string nameToAll = MSG_TO_ALL;
+	const std::string textToAll = "Hello ALL";
+	database::pushMessage(nameToAll, Message(nameFromToAll, textToAll));
+
+	//Укзатель на сообщения конкретному пользователю
+	auto messagesToUser_1 = std::make_shared<std::list<Message> >();
+	auto messagesToUser_2 = std::make_shared<std::list<Message> >();
+	auto messagesToUser_3 = std::make_shared<std::list<Message> >();
+	database::loadMessages(user_1.getLogin(), messagesToUser_1);
+	database::loadMessages(user_2.getLogin(), messagesToUser_2);
+	database::loadMessages(user_3.getLogin(), messagesToUser_3);
+
+	assert(messagesToUser_1->back().getNameFrom() == nameFromToAll);
+	assert(messagesToUser_1->back().getText() == textToAll);
+	assert(messagesToUser_1->size() == 1);
+
+	assert(messagesToUser_2->back().getNameFrom() == nameFromUser);
+	assert(messagesToUser_2->back().getText() == textToUser);
+	assert(messagesToUser_2->front().getNameFrom() == nameFromToAll);
+	assert(messagesToUser_2->front().getText() == textToAll);
+	assert(messagesToUser_2->size() == 2);
+
+	//Ограничение - только новые сообщения
+	database::loadMessages(user_2.getLogin(), messagesToUser_2, 1);
+	assert(messagesToUser_2->size() == 1);
+	assert(messagesToUser_2->front().getText() == textToAll);
+	database::loadMessages(user_2.getLogin(), messagesToUser_2, 5);
+	assert(messagesToUser_2->size() == 2);
+	assert(database::getLastSequence(user_2.getLogin()) == 2);
+	assert(database::getLastSequence("not_exist") == 0);
+
+	assert(messagesToUser_3->back().getNameFrom() == nameFromToAll);
+	assert(messagesToUser_3->back().getText() == textToAll);
+	assert(messagesToUser_3->size() == 1);
+
+	//Очистить от тестовых значений
+	database::clear();
+}
+
+
+
+static void testRemoveUser()
+{
+	//Поместить тестовое значение
+	const std::string name = "name";
+	const std::string login = "login";
+	const std::string password = "password";
+	database::addUser(name, login, credential::make(sha_1::digest(password)));
+
+	database::removeUser(login);
+
+	assert(userData.empty() == true);
+	assert(database::isNicknameRegistered(name) == false);
+	assert(database::isLoginRegistered(login) == false);
+	assert(database::isPasswordRight(login, sha_1::digest(password)) == false);
+
+	//Очистить от тестовых значений
+	database::clear();
+}
+
+
+
+static void testGetNameByLogin()
+{
+	//Поместить тестовое значение
+	const std::string name = "name";
+	const std::string login = "login";
+	const std::string password = "password";
+	database::addUser(name, login, credential::make(sha_1::digest(password)));
+
+	assert(database::getNickname(login) == name);
+	assert(database::getNickname("Not_Exist") == "");
+
+	//Очистить от тестовых значений
+	database::clear();
+}
+
+
+static void testGetLoginByName()
+{
+	//Поместить тестовое значение
+	const std::string name = "name";
+	const std::string login = "login";
+	const std::string password = "password";
+	database::addUser(name, login, credential::make(sha_1::digest(password)));
+
+	assert(getLoginByName(name) == login);
+	assert(getLoginByName("Not_Exist") == "");
+
+	//Очистить от тестовых значений
+	database::clear();
+}
+
+
+
+static void testGetNumberUser()
+{
+	//Поместить тестовое значение
+	std::string name = "name_1";
+	std::string login = "login_1";
+	std::string password = "password_1";
+	database::addUser(name, login, credential::make(sha_1::digest(password)));
+
+	assert(database::getNumberUsers() == 1);
+
+	//Поместить тестовое значение
+	name = "name_2";
+	login = "login_2";
+	password = "password_2";
+	assert(database::addUser(name, login, credential::make(sha_1::digest(password))) == true);
+
+	assert(database::getNumberUsers() == 2);
+
+	//Занятые Логин или Ник и пустые значения не добавляются
+	assert(database::addUser("name_3", login, credential::Record()) == false);
+	assert(database::addUser(name, "login_3", credential::Record()) == false);
+	assert(database::addUser("", "login_3", credential::Record()) == false);
+	assert(database::getNumberUsers() == 2);
+
+	//Очистить от тестовых значений
+	database::clear();
+}
+
+
+
+static void testLoadUserNames()
+{
+	//Поместить тестовое значение
+	const std::string name_1 = "name_1";
+	const std::string login_1 = "login_1";
+	const std::string password_1 = "password_1";
+
+	const std::string name_2 = "name_2";
+	const std::string login_2 = "login_2";
+	const std::string password_2 = "password_2";
+
+	database::addUser(name_1, login_1, credential::make(sha_1::digest(password_1)));
+	database::addUser(name_2, login_2, credential::make(sha_1::digest(password_2)));
+
+	//Укзатель на вектор сообщений конкретному пользователю
+	auto userNames = std::make_shared<std::vector<std::string> >();
+
+	database::loadUserNames(userNames);
+	assert(userNames->size() == 2);
+	assert(userNames->at(0) == name_1);
+	assert(userNames->at(1) == name_2);
+
+	//Смена Ника и удаление видны в списке
+	assert(database::setNickname(login_1, "renamed") == true);
+	database::removeUser(login_2);
+	database::loadUserNames(userNames);
+	assert(userNames->size() == 1);
+	assert(userNames->at(0) == "renamed");
+
+	//Очистить от тестовых значений
+	database::clear();
+}
+
+
+
+static void testSaveLoad()
+{
+	//Поместить тестовые значения
+	const size_t numberUsers = 20;
+	for (size_t i = 0; i < numberUsers; ++i) {
+		database::addUser("name_" + std::to_string(i),
+											"login_" + std::to_string(i),
+											credential::make(sha_1::digest("password")));
+	}
+	database::pushMessage("name_1", Message("name_2", "first"));
+	database::pushMessage("name_1", Message("name_3", "second"));
+	std::vector<bool> delivered;
+	database::pushMessage({"name_4", "name_5"}, Message("name_2", "shared"), delivered);
+
+	const std::string directory = makeTestDirectory();
+	assert(database::save(directory, 4) == true);
+	database::clear();
+
+	//Загрузка разным количеством потоков даёт одну и ту же базу
+	for (size_t threads = 1; threads <= 4; ++threads) {
+		assert(database::load(directory, threads) == true);
+		assert(database::getNumberUsers() == numberUsers);
+		assert(database::isNicknameRegistered("name_7") == true);
+		assert(getLoginByName("name_7") == "login_7");
+		assert(database::isPasswordRight("login_7", sha_1::digest("password")) == true);
+
+		auto messages = std::make_shared<std::list<Message> >();
+		database::loadMessages("login_1", messages);
+		assert(messages->size() == 2);
+		assert(messages->front().getText() == "second");
+		assert(messages->back().getText() == "first");
+
+		//Текст, общий у нескольких адресатов, после загрузки снова общий
+		auto other = std::make_shared<std::list<Message> >();
+		database::loadMessages("login_4", messages);
+		database::loadMessages("login_5", other);
+		assert(messages->front().getText() == "shared");
+		assert(&messages->front().getText() == &other->front().getText());
+		database::clear();
+	}
+
+	//Снимка нет
+	assert(database::load("/not_exist_directory", 1) == false);
+	assert(database::hasSnapshot("/not_exist_directory") == false);
+	assert(database::hasSnapshot(directory) == true);
+
+	//Новое поколение заменяет прежнее, файлы недописанного снимка удаляются
+	size_t segments = 0;
+	uint64_t storeGeneration = 0;
+	uint64_t generation = 0;
+	assert(readManifest(directory, segments, storeGeneration, generation) == true);
+	std::ofstream(segmentPath(directory, 0, generation + 5)).close();
+	assert(database::load(directory, 2) == true);
+	assert(database::save(directory, 2) == true);
+	uint64_t saved = 0;
+	assert(readManifest(directory, segments, storeGeneration, saved) == true);
+	assert(segments == 2 && saved == generation + 1);
+	assert(std::filesystem::exists(segmentPath(directory, 0, generation)) == false);
+	assert(std::filesystem::exists(segmentPath(directory, 3, generation)) == false);
+	assert(std::filesystem::exists(segmentPath(directory, 0, generation + 5)) == false);
+	assert(std::filesystem::exists(segmentPath(directory, 1, saved)) == true);
+
+	//Испорченный сегмент: длина строки и количество пользователей больше файла
+	const std::string path = segmentPath(directory, 1, saved);
+	for (const uint64_t count : {uint64_t(1), UINT64_MAX / 2}) {
+		std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+		writeValue<uint32_t>(stream, SNAPSHOT_MAGIC);
+		writeValue<uint32_t>(stream, SNAPSHOT_VERSION);
+		writeValue<uint64_t>(stream, count);
+		writeValue<uint32_t>(stream, UINT32_MAX);
+		stream.close();
+		assert(database::load(directory, 2) == false);
+		assert(database::getNumberUsers() == numberUsers);
+	}
+	std::filesystem::remove_all(directory);
+
+	//Очистить от тестовых значений
+	database::clear();
+}
+
+
+
+static void testCompact()
+{
+	//Поместить тестовые значения
+	database::addUser("name_1", "login_1", credential::Record());
+	database::addUser("name_2", "login_2", credential::Record());
+	const std::time_t now = std::time(nullptr);
+	for (int i = 0; i < 10; ++i) {
+		database::pushMessage("name_1", Message("name_2", std::to_string(i), now));
+		database::pushMessage("name_2", Message("name_1", std::to_string(i), now - 100 + i));
+	}
+
+	//Общая политика - не больше 4 сообщений, у name_2 - не старше 95 секунд
+	database::Retention policy;
+	policy.maxCount = 4;
+	database::setRetention(policy);
+	database::Retention policyAge;
+	policyAge.maxAge = 95;
+	database::setRetention("login_2", policyAge);
+
+	//Проход по одному пользователю за вызов
+	database::Garbage garbage;
+	size_t bytes = database::compact(garbage, 1);
+	assert(database::isCompactionFinished() == false);
+	bytes += database::compact(garbage, 1);
+	assert(database::isCompactionFinished() == true);
+	assert(garbage.count == 6 + 5);
+	assert(garbage.lists.size() == 2);
+
+	//Объём пакета совпадает с объёмом отделённых сообщений
+	size_t garbageBytes = 0;
+	for (const auto& list : garbage.lists) {
+		for (const auto& message : list) {
+			garbageBytes += database::getMessageSize(message);
+		}
+	}
+	assert(bytes == garbageBytes);
+	assert(userData["login_1"].getMessageBytes() == 4 * database::getMessageSize(Message("name_2", "9")));
+
+	//Остались самые новые сообщения
+	auto messages = std::make_shared<std::list<Message> >();
+	database::loadMessages("login_1", messages);
+	assert(messages->size() == 4);
+	assert(messages->front().getText() == "9");
+	assert(messages->back().getText() == "6");
+	database::loadMessages("login_2", messages);
+	assert(messages->size() == 5);
+	assert(messages->back().getText() == "5");
+
+	//Повторный проход ничего не освобождает
+	garbage = database::Garbage();
+	assert(database::compact(garbage, 10) == 0);
+	assert(garbage.lists.empty() == true);
+
+	//Очистить от тестовых значений
+	database::setRetention(database::Retention());
+	database::clear();
+}
+
+
+
+static void testColdStore()
+{
+	//Поместить тестовые значения
+	const std::string directory = makeTestDirectory();
+	const std::string coldPath = directory + "/cold_messages";
+	const std::string snapshotDirectory = directory + "/snapshot";
+	assert(database::openColdStore(coldPath) == true);
+	database::addUser("name_1", "login_1", credential::Record());
+	database::addUser("name_2", "login_2", credential::Record());
+	//Тексты одной длины - чтобы объём сообщений был одинаковым
+	for (int i = 1; i <= 10; ++i) {
+		const std::string text(1, '0' + i % 10);
+		database::pushMessage("name_1", Message("name_2", text));
+		database::pushMessage("name_2", Message("name_1", text));
+	}
+	const size_t messageSize = database::getMessageSize(Message("name_2", "1"));
+	assert(database::getHotBytes() == 20 * messageSize);
+
+	//В памяти - не больше трёх сообщений на пользователя
+	database::setHotBudget(2 * 3 * messageSize);
+	database::Garbage garbage;
+	database::compact(garbage, 10);
+	assert(garbage.count == 2 * 7);
+	assert(database::getHotBytes() == 2 * 3 * messageSize);
+
+	auto hot = std::make_shared<std::list<Message> >();
+	database::loadMessages("login_1", hot);
+	assert(hot->size() == 3);
+	assert(hot->back().getSequence() == 8);
+
+	//Диапазон на границе памяти и диска
+	std::list<Message> messages;
+	database::loadMessages("login_1", 6, 9, messages);
+	assert(messages.size() == 4);
+	assert(messages.front().getSequence() == 9);
+	assert(messages.back().getSequence() == 6);
+	assert(messages.back().getText() == "6");
+
+	//Ограничение политики хранения действует и на диске
+	database::Retention policy;
+	policy.maxCount = 5;
+	database::setRetention("login_2", policy);
+	database::compact(garbage, 10);
+	database::loadMessages("login_2", 0, UINT64_MAX, messages);
+	assert(messages.size() == 5);
+	assert(messages.back().getSequence() == 6);
+
+	//Снимок ссылается на сообщения на диске - после загрузки они остаются на диске
+	assert(database::save(snapshotDirectory, 2) == true);
+	assert(database::load(snapshotDirectory, 2) == true);
+	database::loadMessages("login_1", hot);
+	assert(hot->size() == 3);
+	assert(hot->front().getSequence() == 10);
+	assert(database::getHotBytes() == 2 * 3 * messageSize);
+	database::loadMessages("login_1", 0, UINT64_MAX, messages);
+	assert(messages.size() == 10);
+	assert(messages.back().getText() == "1");
+
+	//Перезапуск: база пуста, хранилище открыто заново после загрузки снимка
+	database::clear();
+	assert(database::load(snapshotDirectory, 2) == true);
+	assert(database::openColdStore(coldPath) == true);
+	database::loadMessages("login_2", 0, UINT64_MAX, messages);
+	assert(messages.size() == 5);
+	assert(messages.back().getSequence() == 6);
+
+	//Номера продолжаются после восстановления
+	database::pushMessage("name_1", Message("name_2", "1"));
+	database::loadMessages("login_1", hot);
+	assert(hot->front().getSequence() == 11);
+
+	//Переписка читает сообщения адресатов из памяти и с диска
+	assert(database::loadConversation("login_1", "name_2", 0, 100, messages) == true);
+	assert(messages.size() == 11 + 5);
+	assert(messages.front().getSequence() == 21);
+	assert(messages.back().getText() == "1");
+
+	//Политика хранения действует и на переписку, ссылки на удалённое убираются
+	policy.maxCount = 6;
+	database::setRetention("login_1", policy);
+	database::compact(garbage, 10);
+	assert(database::loadConversation("login_1", "name_2", 0, 100, messages) == true);
+	assert(messages.size() == 6 + 5);
+	assert(messages.back().getText() == "6");
+	assert(conversations[conversationKey("login_1", "login_2")].log.size() == 6 + 5);
+
+	//Очистить от тестовых значений
+	database::setHotBudget(0);
+	database::clear();
+	std::filesystem::remove_all(directory);
+}
+
+
+
+static void testReclaim()
+{
+	//Поместить тестовые значения
+	database::addUser("name_1", "login_1", credential::Record());
+	database::addUser("name_2", "login_2", credential::Record());
+	database::addUser("name_3", "login_3", credential::Record());
+	const std::time_t now = std::time(nullptr);
+	database::pushMessage("all", Message("name_1", "to all", now));
+	database::pushMessage("name_2", Message("name_1", "private", now));
+	database::pushMessage("name_2", Message("name_3", "private", now));
+	const size_t hotBytes = database::getHotBytes();
+	size_t conversationMessages = 0;
+	for (const auto& conversation : conversations) {
+		if (conversation.first.first == "login_1" || conversation.first.second == "login_1") {
+			conversationMessages += conversation.second.log.size();
+		}
+	}
+	assert(conversationMessages != 0);
+
+	//Пользователь удалён сразу, его сообщения и переписки - ещё в памяти
+	database::removeUser("login_1");
+	assert(database::isLoginRegistered("login_1") == false);
+	assert(database::getNumberUsers() == 2);
+	assert(database::isReclaimFinished() == false);
+	assert(database::getHotBytes() == hotBytes);
+
+	//Сообщения удалённого пользователя освобождаются порциями
+	database::Garbage garbage;
+	size_t bytes = 0;
+	while (!database::isReclaimFinished()) {
+		bytes += database::reclaim(garbage, 1);
+	}
+	//Журналы переписок освобождаются вместе с узлом пользователя, а не через garbage
+	assert(garbage.count == 4);
+	assert(database::getHotBytes() == hotBytes - bytes);
+	assert(database::getHotBytes() == database::getMessageSize(Message("name_3", "private")));
+
+	auto messages = std::make_shared<std::list<Message> >();
+	database::loadMessages("login_2", messages);
+	assert(messages->size() == 1);
+	assert(messages->front().getNameFrom() == "name_3");
+	database::loadMessages("login_3", messages);
+	assert(messages->empty() == true);
+
+	//Сообщения нового владельца Ника не затрагиваются
+	database::addUser("name_1", "login_4", credential::Record());
+	database::removeUser("login_3");
+	database::pushMessage("name_2", Message("name_1", "new owner", now + 1));
+	garbage = database::Garbage();
+	database::reclaim(garbage, 10);
+	database::loadMessages("login_2", messages);
+	assert(messages->size() == 1);
+	assert(messages->front().getText() == "new owner");
+	assert(database::isReclaimFinished() == true);
+
+	//Сообщения удалённого вычищаются по номеру отправителя: отправленные до смены
+	//Ника, перенесённые на диск и записанные в журнал комнаты
+	const std::string directory = makeTestDirectory();
+	assert(database::openColdStore(directory + "/cold_messages") == true);
+	database::addUser("name_5", "login_5", credential::Record());
+	assert(database::createRoom("room", "login_5") == true);
+	assert(database::joinRoom("room", "login_2") == true);
+	assert(database::postToRoom("room", "login_2", "member") == true);
+	assert(database::postToRoom("room", "login_5", "before rename") == true);
+	database::pushMessage("name_2", Message("name_5", "on disk", now));
+	database::setHotBudget(1);
+	database::compact(garbage, 10);
+	database::setHotBudget(0);
+	assert(coldStore.getCount("login_2") == 2);
+	assert(database::setNickname("login_5", "renamed") == true);
+	database::pushMessage("name_2", Message("renamed", "after rename", now));
+	assert(database::postToRoom("room", "login_5", "after rename") == true);
+
+	database::removeUser("login_5");
+	garbage = database::Garbage();
+	while (!database::isReclaimFinished()) {
+		database::reclaim(garbage, 1);
+	}
+	assert(garbage.count == 1 + 2);
+	std::list<Message> all;
+	database::loadMessages("login_2", 0, UINT64_MAX, all);
+	assert(all.size() == 1);
+	assert(all.front().getText() == "new owner");
+	assert(coldStore.getCount("login_2") == 1);
+	assert(database::loadRoomMessages("room", "login_2", all) == true);
+	assert(all.size() == 1);
+	assert(all.front().getText() == "member");
+
+	//Очистить от тестовых значений
+	database::clear();
+	std::filesystem::remove_all(directory);
+}
+
+
+
+static void testSetNickname()
+{
+	//Поместить тестовые значения
+	database::addUser("name_1", "login_1", credential::Record());
+	uint64_t version = database::getDirectoryVersion();
+	database::addUser("name_2", "login_2", credential::Record());
+	assert(database::getDirectoryVersion() > version);
+
+	version = database::getDirectoryVersion();
+	assert(database::setNickname("login_1", "new_name") == true);
+	assert(database::getDirectoryVersion() > version);
+	assert(database::getNickname("login_1") == "new_name");
+	assert(database::isNicknameRegistered("name_1") == false);
+	assert(getLoginByName("new_name") == "login_1");
+
+	//Ник занят или пользователя нет - версия не меняется
+	version = database::getDirectoryVersion();
+	assert(database::setNickname("login_1", "name_2") == false);
+	assert(database::setNickname("not_exist", "name_3") == false);
+	assert(database::getDirectoryVersion() == version);
+
+	database::removeUser("login_2");
+	assert(database::getDirectoryVersion() > version);
+
+	//Очистить от тестовых значений
+	database::clear();
+}
+
+
+
+static void testDirectoryChanges()
+{
+	//После очистки базы журнал пуст - клиентам нужен полный список
+	database::clear();
+	const uint64_t start = database::getDirectoryVersion();
+	std::vector<database::DirectoryChange> changes;
+	assert(database::loadDirectoryChanges(start - 1, changes) == false);
+	assert(database::loadDirectoryChanges(start, changes) == true);
+	assert(changes.empty() == true);
+
+	database::addUser("name_1", "login_1", credential::Record());
+	database::addUser("name_2", "login_2", credential::Record());
+	database::setNickname("login_1", "new_name");
+	database::removeUser("login_2");
+	assert(database::getDirectoryVersion() == start + 4);
+
+	assert(database::loadDirectoryChanges(start, changes) == true);
+	assert(changes.size() == 4);
+	assert(changes[0].type == database::DirectoryChange::ADDED);
+	assert(changes[0].name == "name_1");
+	assert(changes[0].version == start + 1);
+	assert(changes[2].type == database::DirectoryChange::RENAMED);
+	assert(changes[2].name == "new_name");
+	assert(changes[2].oldName == "name_1");
+	assert(changes[3].type == database::DirectoryChange::REMOVED);
+	assert(changes[3].name == "name_2");
+
+	//Только изменения после заданной версии
+	assert(database::loadDirectoryChanges(start + 3, changes) == true);
+	assert(changes.size() == 1);
+	assert(database::loadDirectoryChanges(start + 4, changes) == true);
+	assert(changes.empty() == true);
+	assert(database::loadDirectoryChanges(start + 5, changes) == false);
+
+	//Очистить от тестовых значений
+	database::clear();
+}
+
+
+
+static void testFindNicknames()
+{
+	//Поместить тестовые значения
+	database::addUser("bob", "login_1", credential::Record());
+	database::addUser("alice", "login_2", credential::Record());
+	database::addUser("alex", "login_3", credential::Record());
+	database::addUser("alfred", "login_4", credential::Record());
+	database::addUser("al", "login_5", credential::Record());
+
+	//Ники с заданным началом по алфавиту
+	std::vector<std::string> nicknames;
+	database::findNicknames("al", "", 10, nicknames);
+	assert(nicknames.size() == 4);
+	assert(nicknames[0] == "al");
+	assert(nicknames[1] == "alex");
+	assert(nicknames[3] == "alice");
+
+	//Постранично
+	database::findNicknames("al", "", 2, nicknames);
+	assert(nicknames.size() == 2);
+	database::findNicknames("al", nicknames.back(), 2, nicknames);
+	assert(nicknames.size() == 2);
+	assert(nicknames[0] == "alfred");
+	assert(nicknames[1] == "alice");
+	database::findNicknames("al", "alice", 2, nicknames);
+	assert(nicknames.empty() == true);
+
+	//Без начала - все Ники
+	database::findNicknames("", "", 10, nicknames);
+	assert(nicknames.size() == 5);
+	assert(nicknames.back() == "bob");
+	database::findNicknames("c", "", 10, nicknames);
+	assert(nicknames.empty() == true);
+
+	//Очистить от тестовых значений
+	database::clear();
+}
+
+
+
+static void testFilters()
+{
+	//Много пользователей - фильтры увеличиваются
+	for (size_t i = 0; i < 1000; ++i) {
+		database::addUser("name_" + std::to_string(i), "login_" + std::to_string(i), credential::Record());
+	}
+	assert(loginFilter.getCounters() >= 1000 * FILTER_COUNTERS_PER_KEY);
+	assert(nameFilter.getCounters() == loginFilter.getCounters());
+
+	//Добавленные значения всегда находятся
+	for (size_t i = 0; i < 1000; ++i) {
+		assert(database::isLoginRegistered("login_" + std::to_string(i)) == true);
+		assert(database::isNicknameRegistered("name_" + std::to_string(i)) == true);
+	}
+
+	//Отсутствующие значения почти всегда отсекаются фильтром
+	BloomFilter::Statistics logins;
+	BloomFilter::Statistics nicknames;
+	database::loadFilterStatistics(logins, nicknames);
+	const uint64_t negatives = logins.negatives;
+	for (size_t i = 1000; i < 2000; ++i) {
+		assert(database::isLoginRegistered("login_" + std::to_string(i)) == false);
+	}
+	database::loadFilterStatistics(logins, nicknames);
+	assert(logins.negatives - negatives > 950);
+
+	//Удалённые и переименованные значения не находятся
+	database::removeUser("login_1");
+	assert(database::isLoginRegistered("login_1") == false);
+	assert(database::isNicknameRegistered("name_1") == false);
+	assert(database::setNickname("login_2", "renamed") == true);
+	assert(database::isNicknameRegistered("name_2") == false);
+	assert(database::isNicknameRegistered("renamed") == true);
+
+	//Фильтры перестраиваются при загрузке снимка
+	const std::string directory = makeTestDirectory();
+	assert(database::save(directory, 2) == true);
+	database::clear();
+	assert(database::isLoginRegistered("login_3") == false);
+	assert(database::load(directory, 2) == true);
+	assert(database::isLoginRegistered("login_3") == true);
+	assert(database::isNicknameRegistered("renamed") == true);
+	std::filesystem::remove_all(directory);
+
+	//Очистить от тестовых значений
+	database::clear();
+}
+
+
+static void testRooms()
+{
+	//Поместить тестовые значения
+	database::addUser("name_1", "login_1", credential::Record());
+	database::addUser("name_2", "login_2", credential::Record());
+	database::addUser("name_3", "login_3", credential::Record());
+
+	//Создание
+	assert(database::createRoom("room", "login_1") == true);
+	assert(database::createRoom("room", "login_2") == false);
+	assert(database::createRoom("all", "login_1") == false);
+	assert(database::createRoom("other", "not_exist_login") == false);
+	assert(database::joinRoom("room", "login_2") == true);
+	assert(database::joinRoom("not_exist_room", "login_2") == false);
+
+	//Писать могут только участники, сообщение хранится один раз
+	assert(database::postToRoom("room", "login_1", "first") == true);
+	assert(database::postToRoom("room", "login_2", "second") == true);
+	assert(database::postToRoom("room", "login_3", "stranger") == false);
+	assert(rooms["room"].log.size() == 2);
+
+	//Каждый участник читает по своему курсору (от старых к новым)
+	std::list<Message> messages;
+	assert(database::loadRoomMessages("room", "login_1", messages) == true);
+	assert(messages.size() == 2);
+	assert(messages.front().getNameFrom() == "name_1");
+	assert(messages.back().getText() == "second");
+	const uint64_t first = messages.front().getSequence();
+	assert(database::loadRoomMessages("room", "login_3", messages) == false);
+	assert(database::markRoomRead("room", "login_3", first) == false);
+
+	//Курсор сдвигается только до полученного сообщения
+	assert(database::markRoomRead("room", "login_1", first) == true);
+	assert(database::loadRoomMessages("room", "login_1", messages) == true);
+	assert(messages.size() == 1);
+	assert(messages.front().getText() == "second");
+	assert(database::markRoomRead("room", "login_1", messages.front().getSequence()) == true);
+	assert(database::markRoomRead("room", "login_1", first) == true);
+	assert(database::loadRoomMessages("room", "login_1", messages) == true);
+	assert(messages.empty() == true);
+
+	//Новый участник видит историю
+	assert(database::joinRoom("room", "login_3") == true);
+	assert(database::postToRoom("room", "login_3", "third") == true);
+	assert(database::loadRoomMessages("room", "login_3", messages) == true);
+	assert(messages.size() == 3);
+	assert(database::loadRoomMessages("room", "login_2", messages) == true);
+	assert(messages.size() == 3);
+
+	//Ограничение - только самые старые непрочитанные
+	assert(database::loadRoomMessages("room", "login_2", messages, 2) == true);
+	assert(messages.size() == 2);
+	assert(messages.front().getText() == "first");
+	assert(messages.back().getText() == "second");
+
+	//Прочитанное всеми убирается из журнала
+	for (size_t i = 0; i < ROOM_LOG_TRIM; ++i) {
+		database::postToRoom("room", "login_1", "text");
+	}
+	const uint64_t last = rooms["room"].lastSequence;
+	database::markRoomRead("room", "login_1", last);
+	database::markRoomRead("room", "login_2", last);
+	assert(rooms["room"].log.empty() == false);
+	database::markRoomRead("room", "login_3", last);
+	assert(rooms["room"].log.empty() == true);
+
+	std::vector<std::string> names;
+	database::loadUserRooms("login_2", names);
+	assert(names.size() == 1);
+	assert(names.front() == "room");
+
+	//Комнаты переживают снимок
+	database::postToRoom("room", "login_1", "saved");
+	const std::string directory = makeTestDirectory();
+	assert(database::save(directory, 2) == true);
+	database::clear();
+	assert(database::load(directory, 2) == true);
+	assert(database::loadRoomMessages("room", "login_3", messages) == true);
+	assert(messages.size() == 1);
+	assert(messages.front().getText() == "saved");
+	std::filesystem::remove_all(directory);
+
+	//Удалённый пользователь выходит из комнат, пустая комната исчезает
+	database::removeUser("login_1");
+	database::loadUserRooms("login_1", names);
+	assert(names.empty() == true);
+	assert(database::leaveRoom("room", "login_2") == true);
+	assert(database::leaveRoom("room", "login_2") == false);
+	assert(database::leaveRoom("room", "login_3") == true);
+	assert(rooms.empty() == true);
+
+	//Очистить от тестовых значений
+	database::clear();
+}
+
+
+
+static void testConversations()
+{
+	//Поместить тестовые значения
+	database::addUser("name_1", "login_1", credential::Record());
+	database::addUser("name_2", "login_2", credential::Record());
+	database::addUser("name_3", "login_3", credential::Record());
+
+	//Переписка хранит сообщения в обе стороны
+	database::pushMessage("name_2", Message("name_1", "to_2_first"));
+	database::pushMessage("name_1", Message("name_2", "to_1"));
+	database::pushMessage("name_3", Message("name_1", "to_3"));
+	std::vector<bool> delivered;
+	database::pushMessage({"name_2", "name_3"}, Message("name_1", "to_both"), delivered);
+	database::pushMessage("all", Message("name_1", "to_all"));
+
+	std::list<Message> messages;
+	assert(database::loadConversation("login_1", "name_2", 0, 10, messages) == true);
+	assert(messages.size() == 3);
+	assert(messages.front().getText() == "to_both");
+	assert(messages.back().getText() == "to_2_first");
+	assert(messages.front().getSequence() == 3);
+
+	//Со стороны собеседника - та же переписка, текст общий со списком адресата
+	assert(database::loadConversation("login_2", "name_1", 0, 10, messages) == true);
+	assert(messages.size() == 3);
+	assert(&messages.front().getText() ==
+				 &std::next(userData["login_2"].getMessageList()->begin())->getText());
+	assert(database::loadConversation("login_3", "name_1", 0, 10, messages) == true);
+	assert(messages.size() == 2);
+
+	//Страницы: до заданного номера, не больше limit
+	assert(database::loadConversation("login_1", "name_2", 3, 1, messages) == true);
+	assert(messages.size() == 1);
+	assert(messages.front().getText() == "to_1");
+	assert(database::loadConversation("login_1", "name_2", 2, 10, messages) == true);
+	assert(messages.size() == 1);
+	assert(messages.front().getText() == "to_2_first");
+	assert(database::loadConversation("login_1", "name_2", 1, 10, messages) == true);
+	assert(messages.empty() == true);
+
+	//Собеседник не зарегистрирован
+	assert(database::loadConversation("login_1", "not_exist_name", 0, 10, messages) == false);
+
+	//Переписки переживают снимок
+	const std::string directory = makeTestDirectory();
+	assert(database::save(directory, 2) == true);
+	database::clear();
+	assert(database::load(directory, 2) == true);
+	assert(database::loadConversation("login_2", "name_1", 0, 10, messages) == true);
+	assert(messages.size() == 3);
+	std::filesystem::remove_all(directory);
+
+	//Переписки удаляются вместе с пользователем, журналы освобождает reclaim
+	const size_t ownMessages = userData["login_1"].getMessageList()->size();
+	database::removeUser("login_1");
+	assert(conversations.empty() == true);
+	assert(userPeers.empty() == true);
+	assert(tombstones.back().conversations.size() == 2);
+	database::Garbage garbage;
+	database::reclaim(garbage, 10);
+	assert(tombstones.empty() == true);
+	//Собственный список и 6 копий его сообщений у name_2 и name_3 - без копий журналов
+	assert(garbage.count == ownMessages + 6);
+
+	//Очистить от тестовых значений
+	database::clear();
+}
+
+
+
+static void testLoadMessagesByTime()
+{
+	//Поместить тестовые значения: сообщение в минуту, начиная с 1000000
+	database::addUser("name_1", "login_1", credential::Record());
+	for (size_t i = 0; i < 1000; ++i) {
+		database::pushMessage("name_1", Message("name_2", std::to_string(i), 1000000 + i * 60));
+	}
+
+	//Интервал внутри истории - ровно сообщения интервала
+	std::list<Message> messages;
+	database::loadMessagesByTime("login_1", 1000000 + 100 * 60, 1000000 + 109 * 60, 0, messages);
+	assert(messages.size() == 10);
+	assert(messages.front().getText() == "109");
+	assert(messages.back().getText() == "100");
+
+	//Следующая страница - сообщения интервала до заданного номера
+	const uint64_t before = std::next(messages.begin(), 4)->getSequence();
+	database::loadMessagesByTime("login_1", 1000000 + 100 * 60, 1000000 + 109 * 60, before,
+		messages);
+	assert(messages.size() == 5);
+	assert(messages.front().getText() == "104");
+	database::loadMessagesByTime("login_1", 1000000 + 100 * 60, 1000000 + 109 * 60,
+		messages.back().getSequence(), messages);
+	assert(messages.empty() == true);
+
+	//Интервал вне истории и неизвестный пользователь
+	database::loadMessagesByTime("login_1", 0, 999999, 0, messages);
+	assert(messages.empty() == true);
+	database::loadMessagesByTime("not_exist_login", 0, 2000000, 0, messages);
+	assert(messages.empty() == true);
+
+	//Индекс восстанавливается при загрузке снимка
+	const std::string directory = makeTestDirectory();
+	assert(database::save(directory, 2) == true);
+	database::clear();
+	assert(database::load(directory, 2) == true);
+	database::loadMessagesByTime("login_1", 1000000 + 990 * 60, 2000000, 0, messages);
+	assert(messages.size() == 10);
+	assert(messages.back().getSequence() == 991);
+	std::filesystem::remove_all(directory);
+
+	//Очистить от тестовых значений
+	database::clear();
+}
+
+
+static void testUnread()
+{
+	//Поместить тестовые значения
+	database::addUser("name_1", "login_1", credential::Record());
+	database::addUser("name_2", "login_2", credential::Record());
+	database::addUser("name_3", "login_3", credential::Record());
+
+	database::pushMessage("name_2", Message("name_1", "first"));
+	database::pushMessage("name_2", Message("name_1", "second"));
+	database::pushMessage("name_1", Message("name_2", "answer"));
+	std::vector<bool> delivered;
+	database::pushMessage({"name_2", "name_1"}, Message("name_3", "to_both"), delivered);
+	database::pushMessage("all", Message("name_1", "to_all"));
+	database::pushMessage("name_1", Message("name_1", "to_self"));
+
+	//Общие сообщения и сообщения себе не считаются
+	std::vector<database::UnreadCount> counts;
+	assert(database::loadUnreadSummary("login_2", counts) == 3);
+	assert(counts.size() == 2);
+	for (const auto& count : counts) {
+		if (count.name == "name_1") {
+			assert(count.count == 2);
+			assert(count.lastSequence == 2);
+		} else {
+			assert(count.name == "name_3");
+			assert(count.count == 1);
+		}
+	}
+	assert(database::loadUnreadSummary("login_1", counts) == 2);
+	assert(database::loadUnreadSummary("not_exist_login", counts) == 0);
+	assert(counts.empty() == true);
+
+	//Подтверждение прочтения до номера включительно, повтор ничего не меняет
+	database::acknowledgeRead("login_2", {{"name_1", 1}});
+	assert(database::loadUnreadSummary("login_2", counts) == 2);
+	database::acknowledgeRead("login_2", {{"name_1", 1}, {"name_3", 1}, {"not_exist_name", 5}});
+	assert(database::loadUnreadSummary("login_2", counts) == 1);
+	assert(counts.size() == 1);
+	assert(counts.front().name == "name_1");
+
+	//Ответ в переписке не отмечает прочитанным
+	database::pushMessage("name_1", Message("name_2", "answer_2"));
+	assert(database::loadUnreadSummary("login_2", counts) == 1);
+
+	//Счётчики переживают снимок
+	const std::string directory = makeTestDirectory();
+	assert(database::save(directory, 2) == true);
+	database::clear();
+	assert(database::load(directory, 2) == true);
+	assert(database::loadUnreadSummary("login_2", counts) == 1);
+	assert(database::loadUnreadSummary("login_1", counts) == 3);
+	std::filesystem::remove_all(directory);
+
+	//Непрочитанные от удалённого пользователя исчезают
+	database::removeUser("login_3");
+	assert(database::loadUnreadSummary("login_1", counts) == 2);
+	database::removeUser("login_2");
+	assert(database::loadUnreadSummary("login_1", counts) == 0);
+	assert(unread.count("login_2") == 0);
+
+	//Очистить от тестовых значений
+	database::clear();
+}
+
+
+
+static std::string makeTestDirectory()
+{
+	std::string path = (std::filesystem::temp_directory_path() / "chat_test_XXXXXX").string();
+	assert(mkdtemp(&path[0]) != nullptr);
+	return path;
+}
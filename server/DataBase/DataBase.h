@@ -1,103 +1,454 @@
-/**
-\file DataBase.h
-\brief Модуль "База данных" - содержит данные о Пользователях
-Предоставляет функции работы с базой данных Пользователей:
-- проверить есть ли заданный Логин в Базе
-- проверить корректный ли Пароль
-- добавить пользователя в Базу
-*/
-
-#pragma once
-#include <string>
-#include <vector>
-#include <list>
-#include <memory>
-
-#include "../Message/Message.h"
-
-
-namespace database {
-	/**
-	Заполнить базу начальными значениями
-	*/
-	void initialize();
-
-	/**
-	Добавить нового пользователя в базу
-	\param[in] name Ник пользователя
-	\param[in] login Логин пользователя
-	\param[in] passwordHash Хэш пароля
-	*/
-	void addUser(const std::string& name,
-							const std::string& login,
-							const std::string& passwordHash);
-
-	/**
-	Проверить есть ли в базе заданный Логин
-	\param[in] login Логин
-	\return Признак наличия заданного Логина в базе
-	*/
-	bool isLoginRegistered(const std::string& login);
-
-	/**
-	Проверить есть ли в базе заданный Ник
-	\param[in] name Ник
-	\return Признак наличия заданного Ника в базе
-	*/
-	bool isNicknameRegistered(const std::string& name);
-
-	/**
-	Проверить соответствует ли Пароль заданному Логину
-	\param[in] login Логин
-	\param[in] passwordHash Хэш пароля
-	\return Признак правильный ли Пароль
-	*/
-	bool isPasswordRight(const std::string& login,
-											const std::string& passwordHash);
-
-	/**
-	Поместить в базу сообщение от одного пользователя другому
-	\param[in] nameAdressee Ник пользователя кому сообщение
-	\param[in] message Сообщение
-	*/
-	void pushMessage(const std::string& nameAdressee,
-									const Message& message);
-
-	/**
-	Загрузить сообщения, адресованные заданному пользователю
-	\param[in] login Логин пользователя
-	\param[in] destination Указатель на список в который поместить сообщения
-	*/
-	void loadMessages(const std::string& login,
-		std::shared_ptr<std::list<Message> >& messages);
-
-	/**
-	Удалить заданного пользователя из базы
-	\param[in] login Логин пользователя которого удалить
-	*/
-	void removeUser(const std::string& login);
-
-	/**
-	Вернуть ник по логину
-	Если пользователь не зарегистрирован - возвращает пустую строку
-	\param[in] login Логин
-	\return Ник пользователя
-	*/
-	std::string getNickname(const std::string& login);
-
-	/**
-	\return Количество зарегистрированных пользователей
-	*/
-	size_t getNumberUsers();
-
-	/**
-	Загрузить имена зарегистрированных пользователей
-	\param[in] userNames Умный указатель на вектор в который поместить имена пользователей
-	*/
-	void loadUserNames(std::shared_ptr<std::vector<std::string> > userNames);
-
-	/**
-	Запустить тесты методов модуля
-	*/
-	void test();
+/**
+\file DataBase.h
+\brief Модуль "База данных" - содержит данные о Пользователях
+Предоставляет функции работы с базой данных Пользователей:
+- проверить есть ли заданный Логин в Базе
+- проверить корректный ли Пароль
+- добавить пользователя в Базу
+*/
+
+#pragma once
+#include <string>
+#include <vector>
+#include <list>
+#include <memory>
+#include <ctime>
+#include <cstdint>
+
+#include "../Message/Message.h"
+#include "../BloomFilter/BloomFilter.h"
+#include "../Credential/Credential.h"
+
+
+namespace database {
+	/**
+	Политика хранения сообщений пользователя
+	Значение 0 - ограничение не действует
+	*/
+	struct Retention {
+		size_t maxCount = 0;	///<Максимальное количество сообщений
+		size_t maxBytes = 0;	///<Максимальный объём сообщений, байт
+		std::time_t maxAge = 0;	///<Максимальный возраст сообщения, секунд
+	};
+
+	/**
+	Изменение списка пользователей
+	*/
+	struct DirectoryChange {
+		enum Type {
+			ADDED,		///<Пользователь добавлен
+			REMOVED,	///<Пользователь удалён
+			RENAMED		///<Пользователь сменил Ник
+		};
+		Type type;					///<Вид изменения
+		uint64_t version;		///<Версия списка после изменения
+		std::string name;		///<Ник пользователя (новый - при смене Ника)
+		std::string oldName;	///<Прежний Ник (при смене Ника)
+	};
+
+	/**
+	Непрочитанные сообщения от одного собеседника
+	*/
+	struct UnreadCount {
+		std::string name;	///<Ник собеседника
+		size_t count;	///<Количество непрочитанных сообщений
+		uint64_t lastSequence;	///<Номер последнего из них в переписке
+	};
+
+	/**
+	Сообщения, отделённые от списков под блокировкой базы
+	Хвосты списков переносятся целиком, без обхода - память освобождается
+	вне блокировки одним вызовом lists.clear()
+	*/
+	struct Garbage {
+		std::vector<std::list<Message> > lists;	///<Отделённые части списков
+		size_t count = 0;	///<Количество сообщений
+	};
+
+	/**
+	Заполнить базу начальными значениями
+	*/
+	void initialize();
+
+	/**
+	Добавить нового пользователя в базу
+	\param[in] name Ник пользователя
+	\param[in] login Логин пользователя
+	\param[in] credential Учётные данные (credential::make)
+	\return Признак того, что пользователь добавлен (false - Логин или Ник заняты,
+	либо не заданы)
+	*/
+	bool addUser(const std::string& name,
+							const std::string& login,
+							const credential::Record& credential);
+
+	/**
+	Проверить есть ли в базе заданный Логин
+	\param[in] login Логин
+	\return Признак наличия заданного Логина в базе
+	*/
+	bool isLoginRegistered(const std::string& login);
+
+	/**
+	Проверить есть ли в базе заданный Ник
+	\param[in] name Ник
+	\return Признак наличия заданного Ника в базе
+	*/
+	bool isNicknameRegistered(const std::string& name);
+
+	/**
+	Проверить соответствует ли Пароль заданному Логину.
+	Учётные данные проверяются вне блокировки Базы
+	\param[in] login Логин
+	\param[in] passwordHash Хэш пароля, присланный клиентом
+	\return Признак правильный ли Пароль
+	*/
+	bool isPasswordRight(const std::string& login,
+											const sha_1::Digest& passwordHash);
+
+	/**
+	Поместить в базу сообщение от одного пользователя другому
+	\param[in] nameAdressee Ник пользователя кому сообщение
+	\param[in] message Сообщение
+	*/
+	void pushMessage(const std::string& nameAdressee,
+									const Message& message);
+
+	/**
+	Поместить в базу сообщение от одного пользователя нескольким
+	Текст сообщения хранится один раз - списки адресатов ссылаются на него
+	\param[in] namesAdressee Ники пользователей кому сообщение
+	\param[in] message Сообщение
+	\param[in] delivered Вектор в который поместить признаки доставки каждому адресату
+	(false - адресат не зарегистрирован)
+	*/
+	void pushMessage(const std::vector<std::string>& namesAdressee,
+									const Message& message,
+									std::vector<bool>& delivered);
+
+	/**
+	Загрузить сообщения, адресованные заданному пользователю
+	Копируются только новые сообщения в пределах limit - остальной список под
+	блокировкой базы не копируется
+	\param[in] login Логин пользователя
+	\param[in] destination Указатель на список в который поместить сообщения (от новых к старым)
+	\param[in] limit Максимальное количество сообщений (0 - все сообщения в памяти)
+	*/
+	void loadMessages(const std::string& login,
+		std::shared_ptr<std::list<Message> >& messages, size_t limit = 0);
+
+	/**
+	\param[in] login Логин пользователя
+	\return Номер последнего сообщения пользователю (0 - сообщений не было
+	или пользователь не зарегистрирован)
+	*/
+	uint64_t getLastSequence(const std::string& login);
+
+	/**
+	Удалить заданного пользователя из базы
+	Пользователь сразу исключается из таблицы, а память его сообщений, его переписок
+	и копии его сообщений у других пользователей освобождает reclaim()
+	\param[in] login Логин пользователя которого удалить
+	*/
+	void removeUser(const std::string& login);
+
+	/**
+	Вернуть ник по логину
+	Если пользователь не зарегистрирован - возвращает пустую строку
+	\param[in] login Логин
+	\return Ник пользователя
+	*/
+	std::string getNickname(const std::string& login);
+
+	/**
+	Сменить Ник пользователя
+	\param[in] login Логин пользователя
+	\param[in] name Новый Ник
+	\return Признак успешной смены (Ник не занят, пользователь зарегистрирован)
+	*/
+	bool setNickname(const std::string& login, const std::string& name);
+
+	/**
+	Версия списка пользователей - увеличивается при каждом добавлении,
+	удалении пользователя и смене Ника
+	\return Версия списка пользователей
+	*/
+	uint64_t getDirectoryVersion();
+
+	/**
+	Загрузить изменения списка пользователей после заданной версии
+	Хранится ограниченное количество последних изменений
+	\param[in] version Версия списка, известная клиенту
+	\param[in] changes Вектор в который поместить изменения (от старых к новым)
+	\return Признак того, что изменения известны - иначе нужен полный список
+	*/
+	bool loadDirectoryChanges(uint64_t version, std::vector<DirectoryChange>& changes);
+
+	/**
+	\return Количество зарегистрированных пользователей
+	*/
+	size_t getNumberUsers();
+
+	/**
+	Загрузить имена зарегистрированных пользователей
+	\param[in] userNames Умный указатель на вектор в который поместить имена пользователей
+	*/
+	void loadUserNames(std::shared_ptr<std::vector<std::string> > userNames);
+
+	/**
+	Найти Ники с заданным началом (по алфавиту, постранично)
+	\param[in] prefix Начало Ника (пустая строка - любой Ник)
+	\param[in] after Ник, после которого начать страницу (пустая строка - с начала)
+	\param[in] limit Максимальное количество Ников на странице
+	\param[in] nicknames Вектор в который поместить Ники
+	*/
+	void findNicknames(const std::string& prefix, const std::string& after,
+		size_t limit, std::vector<std::string>& nicknames);
+
+	/**
+	Загрузить страницу переписки пользователя с собеседником (сообщения в обе стороны)
+	\param[in] login Логин пользователя
+	\param[in] namePeer Ник собеседника
+	\param[in] before Загрузить сообщения с номерами меньше заданного (0 - с последнего)
+	\param[in] limit Максимальное количество сообщений
+	\param[in] messages Список в который поместить сообщения (от новых к старым,
+	с номерами сообщений в переписке). Сообщения, удалённые политикой хранения
+	из списков адресатов, в переписку не попадают
+	\return Признак того, что пользователь и собеседник зарегистрированы
+	*/
+	bool loadConversation(const std::string& login, const std::string& namePeer,
+		uint64_t before, size_t limit, std::list<Message>& messages);
+
+	/**
+	Загрузить количество непрочитанных сообщений пользователя по собеседникам
+	\param[in] login Логин пользователя
+	\param[in] counts Вектор в который поместить счётчики собеседников с непрочитанными
+	\return Всего непрочитанных сообщений
+	*/
+	size_t loadUnreadSummary(const std::string& login, std::vector<UnreadCount>& counts);
+
+	/**
+	Отметить прочитанными сообщения переписок пользователя
+	\param[in] login Логин пользователя
+	\param[in] acknowledgements Пары Ник собеседника - номер последнего прочитанного
+	сообщения переписки с ним
+	*/
+	void acknowledgeRead(const std::string& login,
+		const std::vector<std::pair<std::string, uint64_t> >& acknowledgements);
+
+	/**
+	Создать комнату - общий журнал сообщений группы пользователей
+	Создатель становится её участником
+	\param[in] room Название комнаты
+	\param[in] login Логин создателя
+	\return Признак успешного создания (название свободно, пользователь зарегистрирован)
+	*/
+	bool createRoom(const std::string& room, const std::string& login);
+
+	/**
+	Вступить в комнату - участнику доступна сохранённая история комнаты
+	\param[in] room Название комнаты
+	\param[in] login Логин пользователя
+	\return Признак того, что комната и пользователь существуют
+	*/
+	bool joinRoom(const std::string& room, const std::string& login);
+
+	/**
+	Выйти из комнаты - комната без участников удаляется
+	\param[in] room Название комнаты
+	\param[in] login Логин участника
+	\return Признак того, что пользователь был участником комнаты
+	*/
+	bool leaveRoom(const std::string& room, const std::string& login);
+
+	/**
+	Отправить сообщение в комнату (хранится один раз для всех участников)
+	\param[in] room Название комнаты
+	\param[in] login Логин участника
+	\param[in] text Текст сообщения
+	\return Признак того, что пользователь - участник комнаты
+	*/
+	bool postToRoom(const std::string& room, const std::string& login,
+		const std::string& text);
+
+	/**
+	Загрузить участнику непрочитанные сообщения комнаты (прочитанными не отмечаются)
+	Копируются только старые непрочитанные в пределах limit - остальной журнал под
+	блокировкой базы не копируется
+	\param[in] room Название комнаты
+	\param[in] login Логин участника
+	\param[in] messages Список в который поместить сообщения (от старых к новым)
+	\param[in] limit Максимальное количество сообщений (0 - все непрочитанные)
+	\return Признак того, что пользователь - участник комнаты
+	*/
+	bool loadRoomMessages(const std::string& room, const std::string& login,
+		std::list<Message>& messages, size_t limit = 0);
+
+	/**
+	Отметить прочитанными сообщения комнаты до заданного номера включительно
+	(курсор участника назад не сдвигается)
+	\param[in] room Название комнаты
+	\param[in] login Логин участника
+	\param[in] sequence Номер последнего полученного участником сообщения
+	\return Признак того, что пользователь - участник комнаты
+	*/
+	bool markRoomRead(const std::string& room, const std::string& login,
+		uint64_t sequence);
+
+	/**
+	Загрузить названия комнат, в которых состоит пользователь
+	\param[in] login Логин пользователя
+	\param[in] names Вектор в который поместить названия (по алфавиту)
+	*/
+	void loadUserRooms(const std::string& login, std::vector<std::string>& names);
+
+	/**
+	Загрузить статистику фильтров, отсекающих проверки отсутствующих Логинов и Ников
+	\param[in] logins Статистика фильтра Логинов
+	\param[in] nicknames Статистика фильтра Ников
+	*/
+	void loadFilterStatistics(BloomFilter::Statistics& logins,
+		BloomFilter::Statistics& nicknames);
+
+	/**
+	Удалить из базы всех пользователей
+	*/
+	void clear();
+
+	/**
+	Сохранить снимок базы на диск
+	Пользователи распределяются по сегментам по хэшу Логина,
+	каждый сегмент декодируется независимо от остальных.
+	Сообщения из хранилища на диске в снимок не копируются - сохраняется их индекс
+	и поколение файла хранилища, на который он ссылается.
+	Файлы пишутся новым поколением рядом с прежним снимком, манифест заменяется
+	последним - сбой при сохранении оставляет прежний снимок целым.
+	Под блокировкой базы снимается только копия данных в памяти, кодирование
+	и запись на диск идут без неё - запросы на время записи не останавливаются
+	\param[in] directory Каталог снимка
+	\param[in] segments Количество сегментов
+	\return Признак успешного сохранения
+	*/
+	bool save(const std::string& directory, size_t segments);
+
+	/**
+	Восстановить базу из снимка на диске
+	Сегменты декодируются параллельно, индексы сливаются в конце.
+	Индекс хранилища на диске восстанавливается для файла поколения из снимка
+	\param[in] directory Каталог снимка
+	\param[in] threads Количество потоков (0 - по числу ядер)
+	\return Признак успешной загрузки (при ошибке база не изменяется)
+	\throw std::bad_alloc и другие исключения потоков декодирования (база не изменяется)
+	*/
+	bool load(const std::string& directory, size_t threads = 0);
+
+	/**
+	\param[in] directory Каталог снимка
+	\return Признак того, что в каталоге есть снимок (загружается он или нет)
+	*/
+	bool hasSnapshot(const std::string& directory);
+
+	/**
+	Задать политику хранения сообщений для всех пользователей
+	\param[in] policy Политика хранения
+	*/
+	void setRetention(const Retention& policy);
+
+	/**
+	Задать собственную политику хранения сообщений пользователя
+	\param[in] login Логин пользователя
+	\param[in] policy Политика хранения (заменяет общую)
+	*/
+	void setRetention(const std::string& login, const Retention& policy);
+
+	/**
+	Уплотнить списки сообщений очередной группы пользователей
+	Сообщения сверх политики хранения переносятся в garbage целыми хвостами списков,
+	чтобы освободить их память вне блокировки базы. Сообщения сверх объёма в памяти
+	записываются на диск без блокировки и переносятся в garbage после записи.
+	Вызывается из одного потока (фоновой задачи)
+	\param[in] garbage Пакет, в который перенести удаляемые сообщения
+	\param[in] batch Максимальное количество пользователей за вызов
+	\return Объём перенесённых сообщений, байт
+	*/
+	size_t compact(Garbage& garbage, size_t batch);
+
+	/**
+	\return Признак завершения прохода уплотнения по всей базе
+	*/
+	bool isCompactionFinished();
+
+	/**
+	Освободить память удалённых пользователей
+	Сообщения удалённых пользователей и их копии у остальных пользователей
+	переносятся в garbage, чтобы освободить их память вне блокировки базы
+	\param[in] garbage Пакет, в который перенести удаляемые сообщения
+	\param[in] batch Максимальное количество просматриваемых пользователей за вызов
+	\return Объём перенесённых сообщений, байт
+	*/
+	size_t reclaim(Garbage& garbage, size_t batch);
+
+	/**
+	\return Признак того, что память всех удалённых пользователей освобождена
+	*/
+	bool isReclaimFinished();
+
+	/**
+	\param[in] message Сообщение
+	\return Объём памяти, занимаемый сообщением, байт
+	*/
+	size_t getMessageSize(const Message& message);
+
+	/**
+	Открыть хранилище старых сообщений на диске
+	Пока хранилище не открыто, все сообщения остаются в памяти.
+	Файл хранилища - path с номером поколения: при уплотнении, когда забытые записи
+	занимают больше половины файла, он переписывается в следующее поколение.
+	Прежний файл удаляется после сохранения снимка, который на него уже не ссылается
+	\param[in] path Путь к файлам хранилища (без номера поколения)
+	\return Признак успешного открытия
+	*/
+	bool openColdStore(const std::string& path);
+
+	/**
+	Задать допустимый объём сообщений в памяти
+	При уплотнении сообщения сверх доли пользователя в этом объёме переносятся на диск,
+	в памяти остаются самые новые
+	\param[in] bytes Объём, байт (0 - без ограничения)
+	*/
+	void setHotBudget(size_t bytes);
+
+	/**
+	\return Объём сообщений в памяти, байт
+	*/
+	size_t getHotBytes();
+
+	/**
+	Загрузить сообщения пользователю с номерами из диапазона [first, last]
+	Сообщения, перенесённые на диск, считываются обратно
+	\param[in] login Логин пользователя
+	\param[in] first Номер первого сообщения диапазона
+	\param[in] last Номер последнего сообщения диапазона
+	\param[in] messages Список в который поместить сообщения (от новых к старым)
+	*/
+	void loadMessages(const std::string& login, uint64_t first, uint64_t last,
+		std::list<Message>& messages);
+
+	/**
+	Загрузить сообщения пользователю, полученные сервером в интервале времени [from, to]
+	Интервал номеров сообщений находится по индексу времени без просмотра всего списка
+	\param[in] login Логин пользователя
+	\param[in] from Начало интервала времени
+	\param[in] to Конец интервала времени
+	\param[in] before Загрузить сообщения с номерами меньше заданного (0 - все сообщения
+	интервала) - следующая страница после уже полученных
+	\param[in] messages Список в который поместить сообщения (от новых к старым)
+	*/
+	void loadMessagesByTime(const std::string& login, std::time_t from, std::time_t to,
+		uint64_t before, std::list<Message>& messages);
+
+	/**
+	Запустить тесты методов модуля
+	*/
+	void test();
 }
\ No newline at end of file
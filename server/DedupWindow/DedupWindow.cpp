@@ -0,0 +1,88 @@
+#include "DedupWindow.h"
+
+#include <assert.h>
+
+
+DedupWindow::DedupWindow(size_t capacity, std::time_t window) :
+  window_(window),
+  ring_(capacity == 0 ? 1 : capacity)
+{
+  ids_.reserve(ring_.size());
+}
+
+
+
+bool DedupWindow::insert(const std::string& id, std::time_t now)
+{
+  //Забыть идентификаторы старше окна
+  while (size_ > 0 && ring_[head_].time + window_ <= now) {
+    popOldest();
+  }
+  if (ids_.count(id) != 0) {
+    return false;
+  }
+
+  //Окно заполнено - вытеснить самый старый
+  if (size_ == ring_.size()) {
+    popOldest();
+  }
+  Slot& slot = ring_[(head_ + size_) % ring_.size()];
+  slot.time = now;
+  slot.id = id;
+  ++size_;
+  ids_.insert(id);
+  return true;
+}
+
+
+
+void DedupWindow::clear()
+{
+  ids_.clear();
+  head_ = 0;
+  size_ = 0;
+}
+
+
+
+size_t DedupWindow::size() const
+{
+  return size_;
+}
+
+
+
+void DedupWindow::popOldest()
+{
+  ids_.erase(ring_[head_].id);
+  head_ = (head_ + 1) % ring_.size();
+  --size_;
+}
+
+
+
+void dedup_window::test()
+{
+  DedupWindow window(3, 60);
+
+  //Повтор внутри окна не принимается
+  assert(window.insert("a", 1000) == true);
+  assert(window.insert("a", 1001) == false);
+  assert(window.insert("b", 1002) == true);
+  assert(window.insert("c", 1003) == true);
+  assert(window.size() == 3);
+
+  //Переполнение вытесняет самый старый идентификатор
+  assert(window.insert("d", 1004) == true);
+  assert(window.size() == 3);
+  assert(window.insert("a", 1005) == true);
+  assert(window.insert("c", 1005) == false);
+
+  //По истечении окна идентификатор принимается снова
+  assert(window.insert("c", 1070) == true);
+  assert(window.size() == 1);
+
+  window.clear();
+  assert(window.size() == 0);
+  assert(window.insert("c", 1070) == true);
+}
\ No newline at end of file
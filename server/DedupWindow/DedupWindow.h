@@ -0,0 +1,68 @@
+/**
+\file DedupWindow.h
+\brief Класс - окно повторов: идентификаторы, уже принятые за последнее время
+Запоминает идентификаторы запросов на заданное время, но не больше заданного
+количества. Хэш-множество отвечает на вопрос "уже был?", кольцевой буфер хранит
+порядок поступления, чтобы вытеснять самые старые идентификаторы за O(1).
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include <ctime>
+
+
+class DedupWindow {
+  public:
+    /**
+    Параметризованный конструктор
+    \param[in] capacity Максимальное количество запоминаемых идентификаторов
+    \param[in] window Время, в течение которого идентификатор помнится, секунд
+    */
+    DedupWindow(size_t capacity, std::time_t window);
+
+    /**
+    Запомнить идентификатор
+    \param[in] id Идентификатор
+    \param[in] now Текущее время
+    \return false - идентификатор уже есть в окне (повтор)
+    */
+    bool insert(const std::string& id, std::time_t now);
+
+    /**
+    Забыть все идентификаторы
+    */
+    void clear();
+
+    /**
+    \return Количество запомненных идентификаторов
+    */
+    size_t size() const;
+
+  private:
+    //Ячейка кольцевого буфера
+    struct Slot {
+      std::time_t time;   ///<Время поступления
+      std::string id;     ///<Идентификатор
+    };
+
+    //Вытеснить самый старый идентификатор
+    void popOldest();
+
+    std::time_t window_;                  ///<Время жизни идентификатора
+    std::vector<Slot> ring_;              ///<Идентификаторы в порядке поступления
+    size_t head_ = 0;                     ///<Ячейка самого старого идентификатора
+    size_t size_ = 0;                     ///<Занято ячеек
+    std::unordered_set<std::string> ids_; ///<Идентификаторы окна
+};
+
+
+
+namespace dedup_window {
+  /**
+  Запустить тестирование методов класса
+  */
+  void test();
+}
\ No newline at end of file
@@ -1,7 +1,16 @@
 #include "Handler.h"
 
+#include <ctime>
+#include <functional>
+#include <map>
+#include <vector>
+#include <cstdint>
+
 #include "../DataBase/DataBase.h"
 #include "../Network/Network.h"
+#include "../DedupWindow/DedupWindow.h"
+#include "../AuthPool/AuthPool.h"
+#include "../Credential/Credential.h"
 
 
 namespace{
@@ -17,8 +26,54 @@ namespace{
     REQUEST_MESSAGES,
     ADD_USER,
     ADD_MESSAGE,
-    REMOVE_USER
+    REMOVE_USER,
+    REQUEST_MESSAGES_RANGE,
+    REQUEST_NICKNAMES_SINCE,
+    REQUEST_NICKNAMES_PREFIX,
+    CREATE_ROOM,
+    JOIN_ROOM,
+    LEAVE_ROOM,
+    POST_TO_ROOM,
+    REQUEST_ROOM_MESSAGES,
+    REQUEST_ROOMS,
+    ADD_MESSAGE_MULTI,
+    REQUEST_CONVERSATION,
+    REQUEST_MESSAGES_TIME,
+    ACK_READ,
+    REQUEST_UNREAD_SUMMARY,
+    REQUEST_UPDATES
   };
+
+  const size_t MAX_NICKNAMES_PAGE = 50; //MAX количество Ников на странице поиска
+  const size_t MAX_CONVERSATION_PAGE = 50; //MAX количество сообщений на странице переписки
+  const size_t MAX_RESPONSE_LENGTH = 1023;  //MAX длина ответа (ответ дополняется нулями до 1024 байт)
+  const size_t MAX_DIRECTORY_PAGE = 256;    //MAX количество Ников на странице полного списка
+  const size_t PAGE_HEADER_LENGTH = 28;     //MAX длина начала страницы списка "R|VERSION|more|"
+  //MAX сообщений в ответе на REQUEST_MESSAGES: запись NICK:MESSAGE:| не короче 4 байт
+  const size_t MAX_MESSAGES_REPLY = MAX_RESPONSE_LENGTH / 4;
+  //MAX сообщений в ответе на запрос сообщений комнаты: запись SEQUENCE:NICK:MESSAGE:| не короче 5 байт
+  const size_t MAX_ROOM_MESSAGES_REPLY = MAX_RESPONSE_LENGTH / 5;
+
+  //Готовые ответы на запросы списка пользователей - собираются заново, только когда
+  //меняется версия списка, и отправляются без работы на каждый запрос
+  struct {
+    bool isBuilt = false;
+    uint64_t version = 0;                     //Версия списка, по которой собраны страницы
+    std::vector<std::string> pages;           //Страницы END|NICK|NICK|... по алфавиту
+    std::map<std::string, size_t> pageAfter;  //Номер страницы по последнему Нику предыдущей
+  } directoryPages;
+
+  struct {
+    bool isBuilt = false;
+    uint64_t version = 0;     //Версия списка, по которой собран ответ
+    std::string response;     //Ответ на REQUEST_NUMBER_USERS
+  } numberUsers;
+
+  const size_t DEDUP_CAPACITY = 100000;   //MAX количество запоминаемых идентификаторов сообщений
+  const std::time_t DEDUP_WINDOW = 600;   //Время, в течение которого повтор отбрасывается, секунд
+
+  //Идентификаторы недавно принятых сообщений - повтор запроса не добавляет сообщение снова
+  DedupWindow messageIds(DEDUP_CAPACITY, DEDUP_WINDOW);
 }
 
 
@@ -35,23 +90,75 @@ static void isNicknameRegistered(const std::string& request);
 static void sendNickname(const std::string& request);
 
 //Прислать Ники всех пользователей
-static void sendAllNicknames();
+static void sendAllNicknames(const std::string& request);
 
 //Прислать количество зарегистрированных пользователей
 static void sendNumberUsers();
 
+//Прислать изменения списка Ников после заданной версии
+static void sendNicknamesSince(const std::string& request);
+
+//Прислать страницу Ников с заданным началом
+static void sendNicknamesPrefix(const std::string& request);
+
 //Прислать сообщения пользователю
 static void sendMessages(const std::string& request);
 
+//Прислать сообщения пользователю из диапазона порядковых номеров
+static void sendMessagesRange(const std::string& request);
+
+//Прислать страницу переписки пользователя с собеседником
+static void sendConversation(const std::string& request);
+
+//Прислать сообщения пользователю, полученные в интервале времени
+static void sendMessagesTime(const std::string& request);
+
+//Отметить прочитанными сообщения переписок пользователя
+static void acknowledgeRead(const std::string& request);
+
+//Прислать количество непрочитанных сообщений пользователя
+static void sendUnreadSummary(const std::string& request);
+
+//Прислать одним ответом всё, что нужно фоновому опросу клиента: версию списка
+//пользователей, номер последнего сообщения пользователю и непрочитанные сообщения
+static void sendUpdates(const std::string& request);
+
+//Дописать в ответ непрочитанные сообщения пользователя TOTAL|NICK_PEER:COUNT:LAST_SEQUENCE:|...
+static void appendUnreadSummary(std::string& response, const std::string& login);
+
 //Добавить пользователя в Базу
 static void addUser(const std::string& request);
 
 //Добавить сообщение пользователю в Базу
 static void addMessage(const std::string& request);
 
+//Добавить одно сообщение нескольким пользователям в Базу
+static void addMessageMulti(const std::string& request);
+
 //Удалить аккаунт пользователя по Логину
 static void removeUser(const std::string& request);
 
+//Выполнить дорогой расчёт в пуле проверки паролей и ответить клиенту из пула
+static void respondFromPool(std::function<std::string()> work);
+
+//Создать комнату / вступить в комнату / выйти из комнаты
+static void changeRoom(int command, const std::string& request);
+
+//Отправить сообщение в комнату
+static void postToRoom(const std::string& request);
+
+//Прислать непрочитанные сообщения комнаты
+static void sendRoomMessages(const std::string& request);
+
+//Прислать названия комнат пользователя
+static void sendRooms(const std::string& request);
+
+//Дописать в ответ запись ЗАГОЛОВОК:MESSAGE:| целиком, если ответ не превысит MAX длину.
+//Запись, которая не поместилась бы и в пустой ответ, дописывается с обрезанным текстом -
+//иначе клиент не смог бы получить ни её, ни следующие за ней
+//Возвращает признак того, что запись дописана
+static bool appendEntry(std::string& response, const std::string& head, const std::string& text);
+
 
 
 void handler::handle(const std::string& request)
@@ -80,7 +187,7 @@ void handler::handle(const std::string& request)
         break;
       }
       case REQUEST_ALL_NICKNAMES: {
-        sendAllNicknames();
+        sendAllNicknames(request);
         break;
       }
       case REQUEST_NUMBER_USERS: {
@@ -91,6 +198,26 @@ void handler::handle(const std::string& request)
         sendMessages(request);
         break;
       }
+      case REQUEST_CONVERSATION: {
+        sendConversation(request);
+        break;
+      }
+      case REQUEST_MESSAGES_TIME: {
+        sendMessagesTime(request);
+        break;
+      }
+      case ACK_READ: {
+        acknowledgeRead(request);
+        break;
+      }
+      case REQUEST_UNREAD_SUMMARY: {
+        sendUnreadSummary(request);
+        break;
+      }
+      case REQUEST_UPDATES: {
+        sendUpdates(request);
+        break;
+      }
       case ADD_USER: {
         addUser(request);
         break;
@@ -99,16 +226,53 @@ void handler::handle(const std::string& request)
         addMessage(request);
         break;
       }
+      case ADD_MESSAGE_MULTI: {
+        addMessageMulti(request);
+        break;
+      }
       case REMOVE_USER: {
         removeUser(request);
         break;
       }
+      case REQUEST_MESSAGES_RANGE: {
+        sendMessagesRange(request);
+        break;
+      }
+      case REQUEST_NICKNAMES_SINCE: {
+        sendNicknamesSince(request);
+        break;
+      }
+      case REQUEST_NICKNAMES_PREFIX: {
+        sendNicknamesPrefix(request);
+        break;
+      }
+      case CREATE_ROOM:
+      case JOIN_ROOM:
+      case LEAVE_ROOM: {
+        changeRoom(command, request);
+        break;
+      }
+      case POST_TO_ROOM: {
+        postToRoom(request);
+        break;
+      }
+      case REQUEST_ROOM_MESSAGES: {
+        sendRoomMessages(request);
+        break;
+      }
+      case REQUEST_ROOMS: {
+        sendRooms(request);
+        break;
+      }
       default:
         break;
     }
   }
   catch (const std::invalid_argument&) {
   }
+  //Не хватает аргументов или число вне диапазона
+  catch (const std::out_of_range&) {
+  }
 }
 
 
@@ -161,8 +325,6 @@ static void isNicknameRegistered(const std::string& request)
 
 static void isPasswordRight(const std::string& request)
 {
-  std::string response = "false";
-
   //request - Код_Команды|LOGIN|HASHPASSWORD|
   std::string message = request;
 
@@ -170,13 +332,17 @@ static void isPasswordRight(const std::string& request)
   auto result = std::make_shared<std::vector<std::string> >();
   parse(result, message, "|");
   const std::string login = result->at(1);
-  const std::string passwordHash = result->at(2);
+  //Хэш пароля разбирается сразу в 20 байт
+  sha_1::Digest passwordHash;
+  if (!sha_1::fromHex(result->at(2), passwordHash)){
+    network::response("false");
+    return;
+  }
 
   //Проверить Пароль в базе
-  if (database::isPasswordRight(login, passwordHash)){
-    response = "true";
-  }
-  network::response(response);
+  respondFromPool([login, passwordHash]() {
+    return database::isPasswordRight(login, passwordHash) ? "true" : "false";
+  });
 }
 
 
@@ -206,27 +372,204 @@ static void sendNickname(const std::string& request)
 
 
 
-static void sendAllNicknames()
+//Собрать страницу полного списка Ников (по алфавиту) после заданного Ника
+//Возвращает "end|NICK|NICK|..." для последней страницы, иначе "more|NICK|..."
+static std::string makeNicknamesPage(const std::string& after);
+
+//Готовая страница полного списка Ников после заданного Ника (страницы собираются
+//заново, если версия списка изменилась). Возвращает nullptr, если after - не граница
+//готовых страниц (клиент начал листать до изменения списка)
+static const std::string* findNicknamesPage(const std::string& after, uint64_t& version);
+
+
+static void sendAllNicknames(const std::string& request)
+{
+  //request - Код_Команды|[AFTER_NICK|]
+  std::string message = request;
+
+  //Распарсить входное сообщение
+  auto result = std::make_shared<std::vector<std::string> >();
+  parse(result, message, "|");
+  const std::string after = (result->size() > 1) ? result->at(1) : "";
+
+  //Список страницами: следующая страница - после последнего Ника
+  uint64_t version = 0;
+  const std::string* page = findNicknamesPage(after, version);
+  network::response(page != nullptr ? *page : makeNicknamesPage(after));
+}
+
+
+
+static void sendNumberUsers()
 {
   //Message - Код_Команды
-  auto nicknames = std::make_shared<std::vector<std::string> >();
-  database::loadUserNames(nicknames);
+  const uint64_t version = database::getDirectoryVersion();
+  if (!numberUsers.isBuilt || numberUsers.version != version){
+    numberUsers.response = std::to_string(database::getNumberUsers());
+    numberUsers.version = version;
+    numberUsers.isBuilt = true;
+  }
+  network::response(numberUsers.response);
+}
 
-  //Собрать Ники в ответное сообщение
+
+
+static void sendNicknamesSince(const std::string& request)
+{
+  //request - Код_Команды|VERSION|[AFTER_NICK|]
+  std::string message = request;
+
+  //Распарсить входное сообщение
+  auto result = std::make_shared<std::vector<std::string> >();
+  parse(result, message, "|");
+  const uint64_t version = std::stoull(result->at(1));
+  const std::string after = (result->size() > 2) ? result->at(2) : "";
+
+  //Изменения журнала страницами в формате
+  //D|VERSION|END|+NICK_ADDED|-NICK_REMOVED|~OLD_NICK:NEW_NICK|...
+  //VERSION - версия последнего изменения на странице, END - "more", если изменения
+  //поместились не все и клиенту нужно запросить следующие после VERSION, иначе "end"
+  std::vector<database::DirectoryChange> changes;
+  if (after.empty() && database::loadDirectoryChanges(version, changes)){
+    uint64_t newVersion = version;
+    std::string response = "";
+    size_t sent = 0;
+    for (const auto& change : changes) {
+      std::string entry = "";
+      switch (change.type){
+        case database::DirectoryChange::ADDED:
+          entry = "+" + change.name + "|";
+          break;
+        case database::DirectoryChange::REMOVED:
+          entry = "-" + change.name + "|";
+          break;
+        case database::DirectoryChange::RENAMED:
+          entry = "~" + change.oldName + ":" + change.name + "|";
+          break;
+      }
+      if (response.size() + entry.size() > MAX_RESPONSE_LENGTH - PAGE_HEADER_LENGTH) {
+        break;
+      }
+      response += entry;
+      newVersion = change.version;
+      ++sent;
+    }
+    //Изменение, которое не помещается и на пустую страницу, клиент получит
+    //в составе полного списка
+    if (sent != 0 || changes.empty()) {
+      network::response("D|" + std::to_string(newVersion) + "|" +
+                        (sent == changes.size() ? "end" : "more") + "|" + response);
+      return;
+    }
+  }
+
+  //Клиент слишком отстал - полный список страницами (по алфавиту) в формате
+  //R|VERSION|END|NICK|NICK|...
+  //VERSION - версия списка на момент страницы, следующая страница - после последнего
+  //Ника (запрос с AFTER_NICK). Собрав список, клиент догоняет изменения после
+  //версии первой страницы
+  uint64_t directoryVersion = 0;
+  const std::string* page = findNicknamesPage(after, directoryVersion);
+  if (page != nullptr){
+    network::response("R|" + std::to_string(directoryVersion) + "|" + *page);
+    return;
+  }
+  directoryVersion = database::getDirectoryVersion();
+  network::response("R|" + std::to_string(directoryVersion) + "|" + makeNicknamesPage(after));
+}
+
+
+
+static const std::string* findNicknamesPage(const std::string& after, uint64_t& version)
+{
+  //Версия запрашивается до чтения списка - если список изменится в процессе,
+  //страницы просто соберутся заново при следующем запросе
+  version = database::getDirectoryVersion();
+  if (!directoryPages.isBuilt || directoryPages.version != version){
+    std::vector<std::string> nicknames;
+    database::findNicknames("", "", SIZE_MAX, nicknames);
+
+    //Те же границы страниц, что у makeNicknamesPage
+    directoryPages.pages.clear();
+    directoryPages.pageAfter.clear();
+    directoryPages.pageAfter.emplace("", 0);
+    std::string response = "";
+    size_t count = 0;
+    for (size_t i = 0; i <= nicknames.size(); ++i) {
+      const bool isEnd = (i == nicknames.size());
+      if (!isEnd && count < MAX_DIRECTORY_PAGE &&
+          response.size() + nicknames[i].size() + 1 <= MAX_RESPONSE_LENGTH - PAGE_HEADER_LENGTH) {
+        response += nicknames[i] + "|";
+        ++count;
+        continue;
+      }
+      //Страница заполнена, а Ник в пустую страницу не помещается - он пропускается,
+      //как и в makeNicknamesPage
+      if (!isEnd && count == 0) {
+        continue;
+      }
+      directoryPages.pages.push_back(std::string(isEnd ? "end" : "more") + "|" + response);
+      if (isEnd) {
+        break;
+      }
+      directoryPages.pageAfter.emplace(nicknames[i - 1], directoryPages.pages.size());
+      response = "";
+      count = 0;
+      --i;
+    }
+    directoryPages.version = version;
+    directoryPages.isBuilt = true;
+  }
+
+  auto page = directoryPages.pageAfter.find(after);
+  if (page == directoryPages.pageAfter.end()) {
+    return nullptr;
+  }
+  return &directoryPages.pages[page->second];
+}
+
+
+
+static std::string makeNicknamesPage(const std::string& after)
+{
+  std::vector<std::string> nicknames;
+  database::findNicknames("", after, MAX_DIRECTORY_PAGE, nicknames);
   std::string response = "";
-  for (const auto& name : *nicknames) {
+  size_t sent = 0;
+  for (const auto& name : nicknames) {
+    if (response.size() + name.size() + 1 > MAX_RESPONSE_LENGTH - PAGE_HEADER_LENGTH) {
+      break;
+    }
     response += name + "|";
-	}
-  network::response(response);
+    ++sent;
+  }
+  const bool isLast = (sent == nicknames.size() && nicknames.size() < MAX_DIRECTORY_PAGE);
+  return std::string(isLast ? "end" : "more") + "|" + response;
 }
 
 
 
-static void sendNumberUsers()
+static void sendNicknamesPrefix(const std::string& request)
 {
-  //Message - Код_Команды
-  //Запросить в Базе
-  std::string response = std::to_string(database::getNumberUsers());
+  //request - Код_Команды|PREFIX|AFTER_NICK|LIMIT|
+  std::string message = request;
+
+  //Распарсить входное сообщение
+  auto result = std::make_shared<std::vector<std::string> >();
+  parse(result, message, "|");
+  const std::string prefix = result->at(1);
+  const std::string after = result->at(2);
+  const size_t limit = std::min<size_t>(std::stoul(result->at(3)), MAX_NICKNAMES_PAGE);
+
+  //Найти Ники в индексе
+  std::vector<std::string> nicknames;
+  database::findNicknames(prefix, after, limit, nicknames);
+
+  //Собрать Ники в ответное сообщение
+  std::string response = "";
+  for (const auto& name : nicknames) {
+    response += name + "|";
+  }
   network::response(response);
 }
 
@@ -242,17 +585,20 @@ static void sendMessages(const std::string& request)
   parse(result, message, "|");
   const std::string login = result->at(1);
 
-  //Загрузить сообщения
+  //Загрузить только новые сообщения - больше в ответ не поместится
   auto messagesToUser = std::make_shared<std::list<Message> >();
-  database::loadMessages(login, messagesToUser);
+  database::loadMessages(login, messagesToUser, MAX_MESSAGES_REPLY);
 
-  //Сформировать ответное сообщение в формате
+  //Сформировать ответное сообщение в формате (от новых к старым)
   //NICK_FROM:MESSAGE:|NICK_FROM:MESSAGE:|...
+  //В ответ попадают только целые сообщения, более старые - через REQUEST_MESSAGES_RANGE
   std::string response = "";
   if (!messagesToUser->empty()){
     std::cout << "Print messages:\n";
     for (const auto& message : *messagesToUser) {
-      response += message.getNameFrom() + ":" + message.getText() + ":|";
+      if (!appendEntry(response, message.getNameFrom() + ":", message.getText())) {
+        break;
+      }
     }
   }
   std::cout << response << std::endl;
@@ -261,6 +607,109 @@ static void sendMessages(const std::string& request)
 
 
 
+static void sendMessagesRange(const std::string& request)
+{
+  //request - Код_Команды|LOGIN|FIRST_SEQUENCE|LAST_SEQUENCE|
+  std::string message = request;
+
+  //Распарсить входное сообщение
+  auto result = std::make_shared<std::vector<std::string> >();
+  parse(result, message, "|");
+  const std::string login = result->at(1);
+  const uint64_t first = std::stoull(result->at(2));
+  const uint64_t last = std::stoull(result->at(3));
+
+  //Загрузить сообщения - в том числе перенесённые на диск
+  std::list<Message> messagesToUser;
+  database::loadMessages(login, first, last, messagesToUser);
+
+  //Сформировать ответное сообщение в формате
+  //SEQUENCE:NICK_FROM:MESSAGE:|SEQUENCE:NICK_FROM:MESSAGE:|... от старых к новым.
+  //В ответ попадают только целые сообщения: не поместившиеся клиент запросит
+  //следующим запросом, начиная с номера после последнего полученного
+  std::string response = "";
+  for (auto message = messagesToUser.rbegin(); message != messagesToUser.rend(); ++message) {
+    if (!appendEntry(response, std::to_string(message->getSequence()) + ":" +
+                               message->getNameFrom() + ":", message->getText())) {
+      break;
+    }
+  }
+  network::response(response);
+}
+
+
+
+static void sendConversation(const std::string& request)
+{
+  //request - Код_Команды|LOGIN|PEER_NICKNAME|BEFORE_SEQUENCE|LIMIT|
+  std::string message = request;
+
+  //Распарсить входное сообщение
+  auto result = std::make_shared<std::vector<std::string> >();
+  parse(result, message, "|");
+  const std::string login = result->at(1);
+  const std::string peer = result->at(2);
+  const uint64_t before = std::stoull(result->at(3));
+  const size_t limit = std::min<size_t>(std::stoul(result->at(4)), MAX_CONVERSATION_PAGE);
+
+  //Собеседник не зарегистрирован - false
+  std::list<Message> messages;
+  if (!database::loadConversation(login, peer, before, limit, messages)){
+    network::response("false");
+    return;
+  }
+
+  //Сформировать ответное сообщение в формате (от новых к старым)
+  //SEQUENCE:NICK_FROM:MESSAGE:|SEQUENCE:NICK_FROM:MESSAGE:|...
+  //В ответ попадают только целые сообщения: более ранние клиент запросит
+  //следующей страницей, до номера последнего полученного
+  std::string response = "";
+  for (const auto& conversationMessage : messages) {
+    if (!appendEntry(response, std::to_string(conversationMessage.getSequence()) + ":" +
+                               conversationMessage.getNameFrom() + ":",
+                     conversationMessage.getText())) {
+      break;
+    }
+  }
+  network::response(response);
+}
+
+
+
+static void sendMessagesTime(const std::string& request)
+{
+  //request - Код_Команды|LOGIN|FROM_TIME|TO_TIME|[BEFORE_SEQUENCE|]
+  std::string message = request;
+
+  //Распарсить входное сообщение
+  auto result = std::make_shared<std::vector<std::string> >();
+  parse(result, message, "|");
+  const std::string login = result->at(1);
+  const std::time_t from = std::stoll(result->at(2));
+  const std::time_t to = std::stoll(result->at(3));
+  const uint64_t before = (result->size() > 4) ? std::stoull(result->at(4)) : 0;
+
+  //Загрузить сообщения - в том числе перенесённые на диск
+  std::list<Message> messagesToUser;
+  database::loadMessagesByTime(login, from, to, before, messagesToUser);
+
+  //Сформировать ответное сообщение в формате (от новых к старым)
+  //SEQUENCE:TIME:NICK_FROM:MESSAGE:|SEQUENCE:TIME:NICK_FROM:MESSAGE:|...
+  //В ответ попадают только целые сообщения: более ранние клиент запросит
+  //следующим запросом, до номера последнего полученного
+  std::string response = "";
+  for (const auto& message : messagesToUser) {
+    if (!appendEntry(response, std::to_string(message.getSequence()) + ":" +
+                               std::to_string(message.getTime()) + ":" +
+                               message.getNameFrom() + ":", message.getText())) {
+      break;
+    }
+  }
+  network::response(response);
+}
+
+
+
 static void addUser(const std::string& request)
 {
   //Message - Код_Команды|NICKNAME|LOGIN|HASHPASSWORD|
@@ -271,20 +720,42 @@ static void addUser(const std::string& request)
   parse(result, message, "|");
   const std::string name = result->at(1);
   const std::string login = result->at(2);
-  const std::string passwordHash = result->at(3);
+  sha_1::Digest passwordHash;
+  if (!sha_1::fromHex(result->at(3), passwordHash)){
+    network::response("false");
+    return;
+  }
 
-  //Добавить в базу
-  database::addUser(name, login, passwordHash);
+  //Добавить в базу - с учётными данными вместо присланного хэша.
+  //Логин или Ник могли занять после проверок клиента - ответ "false"
+  respondFromPool([name, login, passwordHash]() {
+    return database::addUser(name, login, credential::make(passwordHash)) ? "true" : "false";
+  });
+}
 
-  const std::string response = "true";
-  network::response(response);
+
+
+static void respondFromPool(std::function<std::string()> work)
+{
+  //Ответ будет дан из пула, поток приёма запросов тем временем свободен
+  const int connection = network::detach();
+  const bool isQueued = auth_pool::submit([connection, work]() {
+    network::response(connection, work());
+    network::closeConnection(connection);
+  });
+
+  //Очередь заполнена - клиент повторит запрос позже
+  if (!isQueued){
+    network::response(connection, "busy");
+    network::closeConnection(connection);
+  }
 }
 
 
 
 static void addMessage(const std::string& input)
 {
-  //input - Код_Команды|NICKNAME_TO|NICKNAME_FROM|MESSAGE|
+  //input - Код_Команды|NICKNAME_TO|NICKNAME_FROM|MESSAGE|[MESSAGE_ID|]
   std::string request = input;
 
   //Распарсить входное сообщение
@@ -294,6 +765,14 @@ static void addMessage(const std::string& input)
   const std::string nicknameFrom = result->at(2);
   const std::string message = result->at(3);
 
+  //Идентификатор задаёт клиент - уникален в пределах отправителя.
+  //Повтор уже принятого сообщения подтверждается без повторной рассылки
+  if (result->size() > 4 && !result->at(4).empty() &&
+      !messageIds.insert(nicknameFrom + "|" + result->at(4), std::time(nullptr))) {
+    network::response("true");
+    return;
+  }
+
   //Добавить сообщение в Базу
   database::pushMessage(nicknameTo,
                         Message(nicknameFrom, message));
@@ -304,6 +783,118 @@ static void addMessage(const std::string& input)
 
 
 
+static void acknowledgeRead(const std::string& request)
+{
+  //request - Код_Команды|LOGIN|NICK_PEER:SEQUENCE,NICK_PEER:SEQUENCE,...|
+  std::string message = request;
+
+  //Распарсить входное сообщение
+  auto result = std::make_shared<std::vector<std::string> >();
+  parse(result, message, "|");
+  const std::string login = result->at(1);
+
+  //Пары разделены запятыми (parse ждёт разделитель и после последней)
+  auto pairs = std::make_shared<std::vector<std::string> >();
+  parse(pairs, result->at(2) + ",", ",");
+  std::vector<std::pair<std::string, uint64_t> > acknowledgements;
+  for (const auto& pair : *pairs) {
+    const size_t position = pair.rfind(":");
+    if (position == std::string::npos) {
+      continue;
+    }
+    acknowledgements.emplace_back(pair.substr(0, position),
+                                  std::stoull(pair.substr(position + 1)));
+  }
+
+  //Все подтверждения применяются одним обращением к Базе
+  database::acknowledgeRead(login, acknowledgements);
+  network::response("true");
+}
+
+
+
+static void sendUnreadSummary(const std::string& request)
+{
+  //request - Код_Команды|LOGIN|
+  std::string message = request;
+
+  //Распарсить входное сообщение
+  auto result = std::make_shared<std::vector<std::string> >();
+  parse(result, message, "|");
+  const std::string login = result->at(1);
+
+  //Сформировать ответное сообщение в формате
+  //TOTAL|NICK_PEER:COUNT:LAST_SEQUENCE:|NICK_PEER:COUNT:LAST_SEQUENCE:|...
+  std::string response = "";
+  appendUnreadSummary(response, login);
+  network::response(response);
+}
+
+
+
+static void sendUpdates(const std::string& request)
+{
+  //request - Код_Команды|LOGIN|
+  std::string message = request;
+
+  //Распарсить входное сообщение
+  auto result = std::make_shared<std::vector<std::string> >();
+  parse(result, message, "|");
+  const std::string login = result->at(1);
+
+  //Сформировать ответное сообщение в формате
+  //DIRECTORY_VERSION|LAST_SEQUENCE|TOTAL|NICK_PEER:COUNT:LAST_SEQUENCE:|...
+  std::string response = std::to_string(database::getDirectoryVersion()) + "|" +
+                         std::to_string(database::getLastSequence(login)) + "|";
+  appendUnreadSummary(response, login);
+  network::response(response);
+}
+
+
+
+static void appendUnreadSummary(std::string& response, const std::string& login)
+{
+  std::vector<database::UnreadCount> counts;
+  const size_t total = database::loadUnreadSummary(login, counts);
+  response += std::to_string(total) + "|";
+  for (const auto& count : counts) {
+    response += count.name + ":" + std::to_string(count.count) + ":" +
+                std::to_string(count.lastSequence) + ":|";
+  }
+}
+
+
+
+static void addMessageMulti(const std::string& input)
+{
+  //input - Код_Команды|NICKNAME_TO,NICKNAME_TO,...|NICKNAME_FROM|MESSAGE|
+  std::string request = input;
+
+  //Распарсить входное сообщение
+  auto result = std::make_shared<std::vector<std::string> >();
+  parse(result, request, "|");
+  const std::string nicknamesTo = result->at(1);
+  const std::string nicknameFrom = result->at(2);
+  const std::string message = result->at(3);
+
+  //Ники адресатов разделены запятыми (parse ждёт разделитель и после последнего)
+  auto nicknames = std::make_shared<std::vector<std::string> >();
+  parse(nicknames, nicknamesTo + ",", ",");
+
+  //Добавить сообщение в Базу - текст сохраняется один раз
+  std::vector<bool> delivered;
+  database::pushMessage(*nicknames, Message(nicknameFrom, message), delivered);
+
+  //Признак доставки каждому адресату в порядке запроса: true|false|...
+  std::string response = "";
+  for (bool isDelivered : delivered) {
+    response += isDelivered ? "true|" : "false|";
+  }
+  network::response(response);
+}
+
+
+
 static void removeUser(const std::string& request)
 {
   //request - Код_Команды|LOGIN|
@@ -323,6 +914,133 @@ static void removeUser(const std::string& request)
 
 
 
+static void changeRoom(int command, const std::string& request)
+{
+  //request - Код_Команды|LOGIN|ROOM|
+  std::string message = request;
+
+  //Распарсить входное сообщение
+  auto result = std::make_shared<std::vector<std::string> >();
+  parse(result, message, "|");
+  const std::string login = result->at(1);
+  const std::string room = result->at(2);
+
+  bool isDone = false;
+  switch (command){
+    case CREATE_ROOM:
+      isDone = database::createRoom(room, login);
+      break;
+    case JOIN_ROOM:
+      isDone = database::joinRoom(room, login);
+      break;
+    case LEAVE_ROOM:
+      isDone = database::leaveRoom(room, login);
+      break;
+    default:
+      break;
+  }
+  network::response(isDone ? "true" : "false");
+}
+
+
+
+static void postToRoom(const std::string& request)
+{
+  //request - Код_Команды|LOGIN|ROOM|MESSAGE|
+  std::string message = request;
+
+  //Распарсить входное сообщение
+  auto result = std::make_shared<std::vector<std::string> >();
+  parse(result, message, "|");
+  const std::string login = result->at(1);
+  const std::string room = result->at(2);
+  const std::string text = result->at(3);
+
+  //Сообщение сохраняется один раз - участники прочитают его из журнала комнаты
+  const bool isPosted = database::postToRoom(room, login, text);
+  network::response(isPosted ? "true" : "false");
+}
+
+
+
+static void sendRoomMessages(const std::string& request)
+{
+  //request - Код_Команды|LOGIN|ROOM|
+  std::string message = request;
+
+  //Распарсить входное сообщение
+  auto result = std::make_shared<std::vector<std::string> >();
+  parse(result, message, "|");
+  const std::string login = result->at(1);
+  const std::string room = result->at(2);
+
+  //Не участник комнаты - false. Загрузить только то, что может поместиться в ответ
+  std::list<Message> messages;
+  if (!database::loadRoomMessages(room, login, messages, MAX_ROOM_MESSAGES_REPLY)){
+    network::response("false");
+    return;
+  }
+
+  //Сформировать ответное сообщение в формате
+  //SEQUENCE:NICK_FROM:MESSAGE:|SEQUENCE:NICK_FROM:MESSAGE:|... от старых к новым.
+  //Прочитанными отмечаются только попавшие в ответ сообщения - остальные
+  //клиент получит следующим запросом
+  std::string response = "";
+  uint64_t lastSent = 0;
+  for (const auto& roomMessage : messages) {
+    if (!appendEntry(response, std::to_string(roomMessage.getSequence()) + ":" +
+                               roomMessage.getNameFrom() + ":", roomMessage.getText())) {
+      break;
+    }
+    lastSent = roomMessage.getSequence();
+  }
+  if (lastSent != 0) {
+    database::markRoomRead(room, login, lastSent);
+  }
+  network::response(response);
+}
+
+
+
+static void sendRooms(const std::string& request)
+{
+  //request - Код_Команды|LOGIN|
+  std::string message = request;
+
+  //Распарсить входное сообщение
+  auto result = std::make_shared<std::vector<std::string> >();
+  parse(result, message, "|");
+  const std::string login = result->at(1);
+
+  std::vector<std::string> rooms;
+  database::loadUserRooms(login, rooms);
+
+  //Собрать названия в ответное сообщение ROOM|ROOM|...
+  std::string response = "";
+  for (const auto& room : rooms) {
+    response += room + "|";
+  }
+  network::response(response);
+}
+
+
+
+static bool appendEntry(std::string& response, const std::string& head, const std::string& text)
+{
+  const size_t tailLength = 2;  //Завершение записи ":|"
+  if (response.size() + head.size() + text.size() + tailLength <= MAX_RESPONSE_LENGTH) {
+    response += head + text + ":|";
+    return true;
+  }
+  if (!response.empty() || head.size() + tailLength > MAX_RESPONSE_LENGTH) {
+    return false;
+  }
+  response += head + text.substr(0, MAX_RESPONSE_LENGTH - head.size() - tailLength) + ":|";
+  return true;
+}
+
+
+
 static void parse (std::shared_ptr<std::vector<std::string> > result,
                   const std::string& input,
                   const std::string& delimiter)
@@ -1,39 +1,129 @@
-﻿#include "Message.h"
-
-#include <assert.h>
-
-
-Message::Message(const std::string& nameUserFrom,
-	const std::string& text) :
-	nameUserFrom_(nameUserFrom),
-	text_(text)
-{
-}
-
-
-
-const std::string& Message::getNameFrom() const
-{
-	return nameUserFrom_;
-}
-
-
-
-const std::string& Message::getText() const
-{
-	return text_;
-}
-
-
-
-//========================================================================================================
-void message::test()
-{
-	//Тест параметризованного конструктора и get-методов
-	std::string nameUserFrom = "nameUserFrom";
-	std::string text = "text";
-
-	Message message(nameUserFrom, text);
-	assert(message.getNameFrom() == nameUserFrom);
-	assert(message.getText() == text);
+﻿#include "Message.h"
+
+#include <assert.h>
+
+
+Message::Message(const std::string& nameUserFrom,
+	const std::string& text,
+	std::time_t time,
+	uint64_t sequence,
+	uint64_t senderId) :
+	nameUserFrom_(nameUserFrom),
+	text_(std::make_shared<const std::string>(text)),
+	time_(time),
+	sequence_(sequence),
+	senderId_(senderId)
+{
+}
+
+
+
+Message::Message(const Message& other, uint64_t sequence) :
+	Message(other, sequence, other.senderId_)
+{
+}
+
+
+
+Message::Message(const Message& other, uint64_t sequence, uint64_t senderId) :
+	nameUserFrom_(other.nameUserFrom_),
+	text_(other.text_),
+	time_(other.time_),
+	sequence_(sequence),
+	senderId_(senderId)
+{
+}
+
+
+
+Message::Message(const std::string& nameUserFrom,
+	std::shared_ptr<const std::string> text,
+	std::time_t time,
+	uint64_t sequence,
+	uint64_t senderId) :
+	nameUserFrom_(nameUserFrom),
+	text_(std::move(text)),
+	time_(time),
+	sequence_(sequence),
+	senderId_(senderId)
+{
+}
+
+
+
+const std::string& Message::getNameFrom() const
+{
+	return nameUserFrom_;
+}
+
+
+
+const std::string& Message::getText() const
+{
+	return *text_;
+}
+
+
+
+std::time_t Message::getTime() const
+{
+	return time_;
+}
+
+
+
+uint64_t Message::getSequence() const
+{
+	return sequence_;
+}
+
+
+
+uint64_t Message::getSenderId() const
+{
+	return senderId_;
+}
+
+
+
+//========================================================================================================
+void message::test()
+{
+	//Тест параметризованного конструктора и get-методов
+	std::string nameUserFrom = "nameUserFrom";
+	std::string text = "text";
+
+	Message message(nameUserFrom, text);
+	assert(message.getNameFrom() == nameUserFrom);
+	assert(message.getText() == text);
+
+	//Время сообщения задаётся явно
+	const std::time_t time = 1000;
+	Message messageWithTime(nameUserFrom, text, time);
+	assert(messageWithTime.getTime() == time);
+	assert(messageWithTime.getSequence() == 0);
+
+	//Порядковый номер задаётся явно
+	Message messageWithSequence(nameUserFrom, text, time, 7);
+	assert(messageWithSequence.getSequence() == 7);
+
+	//Копия для другого адресата хранит тот же текст, а не его копию
+	Message copy(messageWithSequence, 8);
+	assert(copy.getSequence() == 8);
+	assert(copy.getTime() == time);
+	assert(&copy.getText() == &messageWithSequence.getText());
+	assert(copy.getSenderId() == 0);
+
+	//Номер отправителя сохраняется в копиях
+	Message stamped(messageWithSequence, 8, 42);
+	assert(stamped.getSenderId() == 42);
+	assert(Message(stamped, 9).getSenderId() == 42);
+	assert(&stamped.getText() == &messageWithSequence.getText());
+
+	//Сообщения с одним общим текстом
+	const auto sharedText = std::make_shared<const std::string>(text);
+	Message first(nameUserFrom, sharedText, time, 9);
+	Message second(nameUserFrom, sharedText, time, 10);
+	assert(&first.getText() == &second.getText());
+	assert(second.getSequence() == 10);
 }
\ No newline at end of file
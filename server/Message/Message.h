@@ -1,51 +1,109 @@
-﻿/**
-\file Message.h
-\brief Класс инкапсулирует данные о сообщении
-
-Содержит поля:
-- имя пользователя от кого сообщение
-- имя пользователя кому сообщение
-- текст сообщения
-*/
-
-#pragma once
-
-#include <string>
-
-
-class Message {
-  public:
-    /**
-    Конструктор по-умолчанию
-    */
-    Message() = delete;
-
-    /**
-    Параметризованный конструктор
-    \param[in] nameUserFrom Ник пользователя от которого сообщение
-    \param[in] text Текст сообщения
-    */
-    Message(const std::string& nameUserFrom, const std::string& text);
-    /**
-    \return Ник пользователя от которого сообщение
-    */
-    const std::string& getNameFrom() const;
-
-    /**
-    \return Ник пользователя кому сообщение
-    */
-    const std::string& getText() const;
-
-  private:
-    const std::string nameUserFrom_;  ///<Имя отправителя сообщения
-    const std::string text_;  ///<Текст сообщения
-};
-
-
-
-namespace message {
-  /**
-  Запустить тестирование методов класса
-  */
-  void test();
+﻿/**
+\file Message.h
+\brief Класс инкапсулирует данные о сообщении
+
+Содержит поля:
+- имя пользователя от кого сообщение
+- имя пользователя кому сообщение
+- текст сообщения
+- время получения сообщения сервером
+- порядковый номер сообщения в списке адресата
+- номер пользователя-отправителя (не меняется при смене Ника)
+Текст неизменяемый и общий у всех копий сообщения (одно сообщение нескольким адресатам
+хранит текст один раз)
+*/
+
+#pragma once
+
+#include <string>
+#include <memory>
+#include <ctime>
+#include <cstdint>
+
+
+class Message {
+  public:
+    /**
+    Конструктор по-умолчанию
+    */
+    Message() = delete;
+
+    /**
+    Параметризованный конструктор
+    \param[in] nameUserFrom Ник пользователя от которого сообщение
+    \param[in] text Текст сообщения
+    \param[in] time Время получения сообщения (по-умолчанию - текущее)
+    \param[in] sequence Порядковый номер сообщения в списке адресата
+    \param[in] senderId Номер отправителя (0 - не задан)
+    */
+    Message(const std::string& nameUserFrom, const std::string& text,
+            std::time_t time = std::time(nullptr), uint64_t sequence = 0,
+            uint64_t senderId = 0);
+
+    /**
+    Копия сообщения для списка другого адресата - текст остаётся общим
+    \param[in] other Исходное сообщение
+    \param[in] sequence Порядковый номер сообщения в списке адресата
+    */
+    Message(const Message& other, uint64_t sequence);
+
+    /**
+    Копия сообщения с заданным номером отправителя - текст остаётся общим
+    \param[in] other Исходное сообщение
+    \param[in] sequence Порядковый номер сообщения в списке адресата
+    \param[in] senderId Номер отправителя
+    */
+    Message(const Message& other, uint64_t sequence, uint64_t senderId);
+
+    /**
+    Сообщение с уже существующим текстом - например, общим текстом из снимка
+    \param[in] nameUserFrom Ник пользователя от которого сообщение
+    \param[in] text Общий текст сообщения
+    \param[in] time Время получения сообщения
+    \param[in] sequence Порядковый номер сообщения в списке адресата
+    \param[in] senderId Номер отправителя (0 - не задан)
+    */
+    Message(const std::string& nameUserFrom, std::shared_ptr<const std::string> text,
+            std::time_t time, uint64_t sequence, uint64_t senderId = 0);
+
+    /**
+    \return Ник пользователя от которого сообщение
+    */
+    const std::string& getNameFrom() const;
+
+    /**
+    \return Ник пользователя кому сообщение
+    */
+    const std::string& getText() const;
+
+    /**
+    \return Время получения сообщения сервером
+    */
+    std::time_t getTime() const;
+
+    /**
+    \return Порядковый номер сообщения в списке адресата
+    */
+    uint64_t getSequence() const;
+
+    /**
+    \return Номер пользователя-отправителя (0 - не задан)
+    */
+    uint64_t getSenderId() const;
+
+  private:
+    const std::string nameUserFrom_;  ///<Имя отправителя сообщения
+    const std::shared_ptr<const std::string> text_;  ///<Текст сообщения (общий у копий)
+    const std::time_t time_;  ///<Время получения сообщения
+    const uint64_t sequence_; ///<Порядковый номер сообщения
+    const uint64_t senderId_; ///<Номер отправителя
+};
+
+
+
+namespace message {
+  /**
+  Запустить тестирование методов класса
+  */
+  void test();
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <unistd.h>
+#include <string.h>
+#include <algorithm>
 
 #include "Exceptions/SocketCreation_Exception.h"
 #include "Exceptions/SocketBinding_Exception.h"
@@ -15,7 +17,7 @@ namespace{
   const uint16_t MAX_CLIENTS = 5;
 
   int socketDescriptor;
-  int connection;
+  int connection = -1;
 
   socklen_t length;
   struct sockaddr_in serverAddress;
@@ -68,7 +70,27 @@ void network::receive(std::string* message)
 
 void network::response(const std::string& message)
 {
-  ssize_t bytes = write(connection, message.c_str(), MAX_LENGTH_MESSAGE);
+  response(connection, message);
+}
+
+
+
+int network::detach()
+{
+  const int detached = connection;
+  connection = -1;
+  return detached;
+}
+
+
+
+void network::response(int client, const std::string& message)
+{
+  //Ответ - всегда MAX_LENGTH_MESSAGE байт, дополненные нулями
+  char buffer[MAX_LENGTH_MESSAGE] = {};
+  memcpy(buffer, message.data(), std::min<size_t>(message.size(), MAX_LENGTH_MESSAGE - 1));
+  //Клиент мог закрыть соединение, пока ответ готовился - без SIGPIPE
+  ssize_t bytes = send(client, buffer, MAX_LENGTH_MESSAGE, MSG_NOSIGNAL);
   //Если передали >= 0 байт, значит пересылка прошла успешно
   if(bytes >= 0){
     // std::cout << "Data send to the server successfully!\n";
@@ -77,6 +99,22 @@ void network::response(const std::string& message)
 
 
 
+void network::closeConnection(int client)
+{
+  if (client != -1){
+    close(client);
+  }
+}
+
+
+
+void network::finish()
+{
+  closeConnection(detach());
+}
+
+
+
 void network::disconnect()
 {
   close(socketDescriptor);
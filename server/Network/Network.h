@@ -32,6 +32,31 @@ namespace network{
   */
   void response(const std::string& message);
 
+  /**
+  Передать текущее соединение вызывающему - ответ на запрос будет дан позже
+  (в том числе из другого потока) через response(connection, message)
+  \return Соединение
+  */
+  int detach();
+
+  /**
+  Ответить клиенту по переданному соединению
+  \param[in] connection Соединение
+  \param[in] message Сообщение - ответ
+  */
+  void response(int connection, const std::string& message);
+
+  /**
+  Закрыть переданное соединение
+  \param[in] connection Соединение
+  */
+  void closeConnection(int connection);
+
+  /**
+  Закрыть текущее соединение после ответа, если оно не передано через detach
+  */
+  void finish();
+
   /**
   Завершить сетевое соединение
   */  
@@ -0,0 +1,116 @@
+#include "TimeIndex.h"
+
+#include <algorithm>
+#include <assert.h>
+
+
+TimeIndex::TimeIndex(uint32_t step) :
+  step_(step == 0 ? 1 : step)
+{
+}
+
+
+
+void TimeIndex::add(uint64_t sequence, std::time_t time)
+{
+  //Время в индексе не убывает - тогда по нему можно искать двоичным поиском
+  lastTime_ = entries_.empty() ? time : std::max(lastTime_, time);
+
+  if (entries_.empty()) {
+    baseTime_ = lastTime_;
+    baseSequence_ = sequence;
+    entries_.push_back(Entry{0, 0});
+  }
+  //Очередная запись - не ближе step_ номеров от предыдущей
+  else if (sequence >= baseSequence_ + entries_.back().sequence + step_) {
+    entries_.push_back(Entry{static_cast<uint32_t>(lastTime_ - baseTime_),
+                             static_cast<uint32_t>(sequence - baseSequence_)});
+  }
+  lastSequence_ = sequence;
+}
+
+
+
+bool TimeIndex::find(std::time_t from, std::time_t to, uint64_t& first, uint64_t& last) const
+{
+  if (entries_.empty() || from > to || to < baseTime_ || from > lastTime_) {
+    return false;
+  }
+  const auto timeLess = [](const Entry& entry, std::time_t offset) {
+    return static_cast<std::time_t>(entry.time) < offset;
+  };
+
+  //Сообщения из интервала начинаются не раньше записи, предшествующей
+  //первой записи со временем >= from
+  auto begin = std::lower_bound(entries_.begin(), entries_.end(),
+                                std::max<std::time_t>(from - baseTime_, 0), timeLess);
+  if (begin != entries_.begin()) {
+    --begin;
+  }
+  first = baseSequence_ + begin->sequence;
+
+  //И заканчиваются до первой записи со временем > to
+  auto end = std::lower_bound(begin, entries_.end(), to - baseTime_ + 1, timeLess);
+  last = (end == entries_.end()) ? lastSequence_ : baseSequence_ + end->sequence - 1;
+  return true;
+}
+
+
+
+void TimeIndex::clear()
+{
+  entries_.clear();
+  baseTime_ = 0;
+  baseSequence_ = 0;
+  lastTime_ = 0;
+  lastSequence_ = 0;
+}
+
+
+
+size_t TimeIndex::size() const
+{
+  return entries_.size();
+}
+
+
+
+//========================================================================================================
+void time_index::test()
+{
+  TimeIndex index(4);
+  uint64_t first = 0;
+  uint64_t last = 0;
+  assert(index.find(0, 100, first, last) == false);
+
+  //Сообщения 1..20, по одному в 10 секунд, начиная с 1000
+  for (uint64_t sequence = 1; sequence <= 20; ++sequence) {
+    index.add(sequence, 1000 + (sequence - 1) * 10);
+  }
+  assert(index.size() == 5);
+
+  //Интервал номеров накрывает все сообщения интервала времени
+  assert(index.find(1050, 1080, first, last) == true);
+  assert(first <= 6 && last >= 9);
+  assert(last - first < 12);
+
+  //Вся история
+  assert(index.find(0, 5000, first, last) == true);
+  assert(first == 1 && last == 20);
+
+  //Последние сообщения
+  assert(index.find(1185, 5000, first, last) == true);
+  assert(first <= 20 && last == 20);
+
+  //Интервал вне истории
+  assert(index.find(0, 999, first, last) == false);
+  assert(index.find(1191, 5000, first, last) == false);
+
+  //Время назад (часы сервера переведены) не ломает поиск
+  index.add(21, 900);
+  assert(index.find(1190, 5000, first, last) == true);
+  assert(last == 21);
+
+  index.clear();
+  assert(index.size() == 0);
+}
\ No newline at end of file
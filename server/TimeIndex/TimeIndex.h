@@ -0,0 +1,74 @@
+/**
+\file TimeIndex.h
+\brief Класс - разреженный индекс "время -> номер сообщения" списка сообщений
+Хранит время каждого STEP-го сообщения списка, чтобы по интервалу времени
+двоичным поиском найти интервал номеров сообщений вместо просмотра всего списка.
+Время и номера записей хранятся 32-битными смещениями от первой записи.
+Время в индексе не убывает: запись хранит наибольшее время сообщений до неё.
+*/
+
+#pragma once
+
+#include <vector>
+#include <ctime>
+#include <cstdint>
+
+
+class TimeIndex {
+  public:
+    /**
+    Параметризованный конструктор
+    \param[in] step Количество сообщений между записями индекса
+    */
+    explicit TimeIndex(uint32_t step = 64);
+
+    /**
+    Учесть новое сообщение списка (номера сообщений возрастают)
+    \param[in] sequence Порядковый номер сообщения
+    \param[in] time Время получения сообщения
+    */
+    void add(uint64_t sequence, std::time_t time);
+
+    /**
+    Найти интервал номеров, в котором лежат все сообщения из интервала времени
+    \param[in] from Начало интервала времени
+    \param[in] to Конец интервала времени
+    \param[in] first Номер, с которого искать сообщения
+    \param[in] last Номер, до которого искать сообщения
+    \return false - в интервале времени сообщений точно нет
+    */
+    bool find(std::time_t from, std::time_t to, uint64_t& first, uint64_t& last) const;
+
+    /**
+    Удалить все записи
+    */
+    void clear();
+
+    /**
+    \return Количество записей индекса
+    */
+    size_t size() const;
+
+  private:
+    //Запись индекса - смещения от первой записи
+    struct Entry {
+      uint32_t time;      ///<Смещение времени, секунд
+      uint32_t sequence;  ///<Смещение номера сообщения
+    };
+
+    uint32_t step_;               ///<Сообщений между записями
+    std::time_t baseTime_ = 0;    ///<Время первой записи
+    uint64_t baseSequence_ = 0;   ///<Номер сообщения первой записи
+    std::time_t lastTime_ = 0;    ///<Наибольшее время учтённых сообщений
+    uint64_t lastSequence_ = 0;   ///<Номер последнего учтённого сообщения
+    std::vector<Entry> entries_;  ///<Записи (по возрастанию номеров и времени)
+};
+
+
+
+namespace time_index {
+  /**
+  Запустить тестирование методов класса
+  */
+  void test();
+}
\ No newline at end of file
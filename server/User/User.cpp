@@ -1,189 +1,286 @@
-#include "User.h"
-
-#include <assert.h>
-
-
-User::User() : name_(""), login_(""), hashPassword_(""),
-	messages_(std::make_shared<std::list<Message> >())
-{
-}
-
-User::User(const std::string& name,
-	const std::string& login,
-	const std::string& hashPassword):
-	name_(name), login_(login), hashPassword_(hashPassword),
-	messages_(std::make_shared<std::list<Message> >())
-{
-}
-
-
-
-bool User::operator==(User other) const
-{
-	//Объекты равны если совпадает Логин
-	if (login_ == other.login_) {
-		return true;
-	}
-	return false;
-}
-
-
-
-std::string User::getName() const
-{
-	return name_;
-}
-
-
-
-std::string User::getLogin() const
-{
-	return login_;
-}
-
-
-
-std::shared_ptr<std::list<Message> > User::getMessageList() const
-{
-	return messages_;
-}
-
-
-
-std::string User::getHashPassword() const
-{
-	return hashPassword_;
-}
-
-
-
-void User::setName(const std::string& name)
-{
-	name_ = name;
-}
-
-
-
-void User::setLogin(const std::string& login)
-{
-	login_ = login;
-}
-
-
-
-void User::setMessage(const Message& message)
-{
-	messages_->push_front(message);
-}
-
-
-
-void User::reset()
-{
-	name_.clear();
-	login_.clear();
-	hashPassword_.clear();
-	messages_->clear();
-}
-
-
-//========================================================================================================
-static void testConstructorDefault();
-static void testConstructorParameterized();
-static void testSet();
-static void testOperatorEquality();
-static void testReset();
-static void testMessages();
-
-
-void user::test()
-{
-	testConstructorDefault();
-	testConstructorParameterized();
-	testSet();
-	testOperatorEquality();
-	testReset();
-	testMessages();
-}
-
-
-
-static void testConstructorDefault()
-{
-	User user;
-	assert(user.getName() == "");
-	assert(user.getLogin() == "");
-	assert(user.getHashPassword() == "");
-}
-
-
-
-static void testConstructorParameterized()
-{
-	const std::string name = "name";
-	const std::string login = "login";
-	const std::string hashPassword = "5baa61e4c9b93f3f0682250b6cf8331b7ee68fd8";
-
-	User user(name, login, hashPassword);
-	assert(user.getName() == name);
-	assert(user.getLogin() == login);
-	assert(user.getHashPassword() == hashPassword);
-}
-
-
-
-static void testSet()
-{
-	User user;
-	const std::string name = "name";
-	const std::string login = "login";
-	user.setName(name);
-	user.setLogin(login);
-	assert(user.getName() == name);
-	assert(user.getLogin() == login);
-}
-
-
-
-static void testOperatorEquality()
-{
-	User user1;
-	User user2("name", "login", "5baa61e4c9b93f3f0682250b6cf8331b7ee68fd8");
-	User user3("name", "login", "d63d5c2879619d7ffd81d029490b4e69b81ff55d");
-	User user4("new_name", "new_login", "d63d5c2879619d7ffd81d029490b4e69b81ff55d");
-
-	assert((user1 == user2) == false);
-	assert((user2 == user3) == true);
-	assert((user2 == user4) == false);
-}
-
-
-
-static void testReset()
-{
-	const std::string name = "name";
-	const std::string login = "login";
-	const std::string hashPassword = "5baa61e4c9b93f3f0682250b6cf8331b7ee68fd8";
-
-	User user(name, login, hashPassword);
-
-	user.reset();
-	assert(user.getName() == "");
-	assert(user.getLogin() == "");
-	assert(user.getHashPassword() == "");
-	assert(user.getMessageList()->empty() == true);
-}
-
-
-
-static void testMessages()
-{
-	User user("name", "login", "1");
-
-	const std::string nameUserFrom = "nameUserFrom";
-	const std::string messageText = "Message to User";
-
-	user.setMessage(Message(nameUserFrom, messageText));
-
-	assert(user.getMessageList()->front().getText() == messageText);
+#include "User.h"
+
+#include <assert.h>
+
+
+User::User() : name_(""), login_(""), id_(0), credential_(),
+	messages_(std::make_shared<std::list<Message> >()),
+	lastSequence_(0), messageBytes_(0)
+{
+}
+
+User::User(const std::string& name,
+	const std::string& login,
+	const credential::Record& credential):
+	name_(name), login_(login), id_(0), credential_(credential),
+	messages_(std::make_shared<std::list<Message> >()),
+	lastSequence_(0), messageBytes_(0)
+{
+}
+
+
+
+bool User::operator==(User other) const
+{
+	//Объекты равны если совпадает Логин
+	if (login_ == other.login_) {
+		return true;
+	}
+	return false;
+}
+
+
+
+std::string User::getName() const
+{
+	return name_;
+}
+
+
+
+std::string User::getLogin() const
+{
+	return login_;
+}
+
+
+
+std::shared_ptr<std::list<Message> > User::getMessageList() const
+{
+	return messages_;
+}
+
+
+
+uint64_t User::getId() const
+{
+	return id_;
+}
+
+
+
+const credential::Record& User::getCredential() const
+{
+	return credential_;
+}
+
+
+
+void User::setName(const std::string& name)
+{
+	name_ = name;
+}
+
+
+
+void User::setLogin(const std::string& login)
+{
+	login_ = login;
+}
+
+
+
+void User::setId(uint64_t id)
+{
+	id_ = id;
+}
+
+
+
+void User::setMessage(const Message& message)
+{
+	//Текст сообщения не копируется - он общий для всех адресатов
+	messages_->push_front(Message(message, ++lastSequence_));
+	timeIndex_.add(lastSequence_, message.getTime());
+}
+
+
+
+uint64_t User::getLastSequence() const
+{
+	return lastSequence_;
+}
+
+
+
+void User::setLastSequence(uint64_t sequence)
+{
+	lastSequence_ = sequence;
+}
+
+
+
+size_t User::getMessageBytes() const
+{
+	return messageBytes_;
+}
+
+
+
+void User::setMessageBytes(size_t bytes)
+{
+	messageBytes_ = bytes;
+}
+
+
+
+void User::reset()
+{
+	name_.clear();
+	login_.clear();
+	id_ = 0;
+	credential_ = credential::Record();
+	messages_->clear();
+	lastSequence_ = 0;
+	messageBytes_ = 0;
+	timeIndex_.clear();
+}
+
+
+
+const TimeIndex& User::getTimeIndex() const
+{
+	return timeIndex_;
+}
+
+
+
+void User::indexMessages()
+{
+	//Список - от новых сообщений к старым, индекс заполняется от старых
+	timeIndex_.clear();
+	for (auto message = messages_->rbegin(); message != messages_->rend(); ++message) {
+		timeIndex_.add(message->getSequence(), message->getTime());
+	}
+}
+
+
+//========================================================================================================
+static void testConstructorDefault();
+static void testConstructorParameterized();
+static void testSet();
+static void testOperatorEquality();
+static void testReset();
+static void testMessages();
+
+//Учётные данные для тестов - без расчёта ключа
+static credential::Record makeCredential(const std::string& password);
+
+
+void user::test()
+{
+	testConstructorDefault();
+	testConstructorParameterized();
+	testSet();
+	testOperatorEquality();
+	testReset();
+	testMessages();
+}
+
+
+
+static void testConstructorDefault()
+{
+	User user;
+	assert(user.getName() == "");
+	assert(user.getLogin() == "");
+	assert(user.getCredential().iterations == 0);
+}
+
+
+
+static void testConstructorParameterized()
+{
+	const std::string name = "name";
+	const std::string login = "login";
+	const credential::Record credential = makeCredential("password");
+
+	User user(name, login, credential);
+	assert(user.getName() == name);
+	assert(user.getLogin() == login);
+	assert(user.getCredential().iterations == credential.iterations);
+	assert(user.getCredential().key == credential.key);
+}
+
+
+
+static void testSet()
+{
+	User user;
+	const std::string name = "name";
+	const std::string login = "login";
+	user.setName(name);
+	user.setLogin(login);
+	user.setId(7);
+	assert(user.getName() == name);
+	assert(user.getLogin() == login);
+	assert(user.getId() == 7);
+}
+
+
+
+static void testOperatorEquality()
+{
+	User user1;
+	User user2("name", "login", makeCredential("password"));
+	User user3("name", "login", makeCredential("new_password"));
+	User user4("new_name", "new_login", makeCredential("new_password"));
+
+	assert((user1 == user2) == false);
+	assert((user2 == user3) == true);
+	assert((user2 == user4) == false);
+}
+
+
+
+static void testReset()
+{
+	const std::string name = "name";
+	const std::string login = "login";
+
+	User user(name, login, makeCredential("password"));
+
+	user.setMessageBytes(100);
+	user.reset();
+	assert(user.getMessageBytes() == 0);
+	assert(user.getName() == "");
+	assert(user.getLogin() == "");
+	assert(user.getCredential().iterations == 0);
+	assert(user.getMessageList()->empty() == true);
+}
+
+
+
+static void testMessages()
+{
+	User user("name", "login", credential::Record());
+
+	const std::string nameUserFrom = "nameUserFrom";
+	const std::string messageText = "Message to User";
+
+	user.setMessage(Message(nameUserFrom, messageText));
+
+	assert(user.getMessageList()->front().getText() == messageText);
+	assert(user.getMessageList()->front().getSequence() == 1);
+
+	//Номера сообщений растут
+	user.setMessage(Message(nameUserFrom, messageText));
+	assert(user.getMessageList()->front().getSequence() == 2);
+	assert(user.getLastSequence() == 2);
+
+	//Сообщения попадают в индекс времени
+	uint64_t first = 0;
+	uint64_t last = 0;
+	assert(user.getTimeIndex().find(0, std::time(nullptr) + 1, first, last) == true);
+	assert(first == 1 && last == 2);
+}
+
+
+
+static credential::Record makeCredential(const std::string& password)
+{
+	credential::Record record;
+	record.iterations = 1;
+	record.key = sha_1::digest(password);
+	return record;
 }
\ No newline at end of file
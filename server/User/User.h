@@ -1,89 +1,140 @@
-/**
-\file User.h
-\brief Класс содержит данные о пользователе
-Класс инкапсулирует в себе параметры пользователя:
-- Ник (имя) - по нику он будет известен другим пользователям
-- Логин - имя по которому он будет заходить в чат
-- Хэш Пароля
-*/
-
-#pragma once
-
-#include <string>
-#include <list>
-#include <memory>
-
-#include "../Message/Message.h"
-
-
-class User {
-	public:
-		User();
-		User(const std::string& name,
-			const std::string& login,
-			const std::string& hashPassword);
-
-		/**
-		Перегрузка оператора '==' для поиска пользователя в базе данных
-		с использованием алгоритмов STL
-		*/
-		bool operator==(User other) const;
-
-		/**
-		\return Ник пользователя
-		*/
-		std::string getName() const;
-
-		/**
-		\return Логин пользователя
-		*/
-		std::string getLogin() const;
-
-		/**
-		\return Хеш Пароля
-		*/
-		std::string getHashPassword() const;
-
-		/**
-		\return Указатель на список сообщений пользователю
-		*/
-		std::shared_ptr<std::list<Message> > getMessageList() const;
-
-		/**
-		Задать пользователю Имя
-		\param[in] name Имя
-		*/
-		void setName(const std::string& name);
-
-		/**
-		Задать пользователю Логин
-		\param[in] login Логин
-		*/
-		void setLogin(const std::string& login);
-
-		/**
-		Задать пользователю Сообщение
-		\param[in] message Сообщение
-		*/
-		void setMessage(const Message& message);
-
-		/**
-		Присвоить значения полей класса - пустая строка
-		*/
-		void reset();
-
-	private:
-		std::string name_;		///<Ник
-		std::string login_;		///<Логин
-		std::string hashPassword_;	///<Хеш Пароля
-		std::shared_ptr<std::list<Message> > messages_;	///<Сообщения пользователю
-};
-
-
-
-namespace user {
-	/**
-	Запустить тестирование методов класса
-	*/
-	void test();
+/**
+\file User.h
+\brief Класс содержит данные о пользователе
+Класс инкапсулирует в себе параметры пользователя:
+- Ник (имя) - по нику он будет известен другим пользователям
+- Логин - имя по которому он будет заходить в чат
+- Учётные данные (запись фиксированного размера, хранится в самом объекте)
+*/
+
+#pragma once
+
+#include <string>
+#include <list>
+#include <memory>
+
+#include "../Message/Message.h"
+#include "../TimeIndex/TimeIndex.h"
+#include "../Credential/Credential.h"
+
+
+class User {
+	public:
+		User();
+		User(const std::string& name,
+			const std::string& login,
+			const credential::Record& credential);
+
+		/**
+		Перегрузка оператора '==' для поиска пользователя в базе данных
+		с использованием алгоритмов STL
+		*/
+		bool operator==(User other) const;
+
+		/**
+		\return Ник пользователя
+		*/
+		std::string getName() const;
+
+		/**
+		\return Логин пользователя
+		*/
+		std::string getLogin() const;
+
+		/**
+		\return Номер пользователя (не меняется при смене Ника, 0 - не задан)
+		*/
+		uint64_t getId() const;
+
+		/**
+		\return Учётные данные (без копирования)
+		*/
+		const credential::Record& getCredential() const;
+
+		/**
+		\return Указатель на список сообщений пользователю
+		*/
+		std::shared_ptr<std::list<Message> > getMessageList() const;
+
+		/**
+		Задать пользователю Имя
+		\param[in] name Имя
+		*/
+		void setName(const std::string& name);
+
+		/**
+		Задать пользователю Логин
+		\param[in] login Логин
+		*/
+		void setLogin(const std::string& login);
+
+		/**
+		Задать пользователю номер (назначает База данных, номера не повторяются)
+		\param[in] id Номер пользователя
+		*/
+		void setId(uint64_t id);
+
+		/**
+		Задать пользователю Сообщение
+		Сообщению присваивается следующий порядковый номер в списке пользователя
+		\param[in] message Сообщение
+		*/
+		void setMessage(const Message& message);
+
+		/**
+		\return Порядковый номер последнего сообщения пользователю
+		*/
+		uint64_t getLastSequence() const;
+
+		/**
+		Задать порядковый номер последнего сообщения (при восстановлении из снимка)
+		\param[in] sequence Порядковый номер
+		*/
+		void setLastSequence(uint64_t sequence);
+
+		/**
+		\return Объём сообщений в списке, байт (ведёт База данных)
+		*/
+		size_t getMessageBytes() const;
+
+		/**
+		Задать объём сообщений в списке
+		\param[in] bytes Объём, байт
+		*/
+		void setMessageBytes(size_t bytes);
+
+		/**
+		\return Индекс "время -> номер" сообщений пользователю
+		*/
+		const TimeIndex& getTimeIndex() const;
+
+		/**
+		Построить индекс "время -> номер" заново по списку сообщений
+		(после заполнения списка в обход setMessage, например из снимка)
+		*/
+		void indexMessages();
+
+		/**
+		Присвоить значения полей класса - пустая строка
+		*/
+		void reset();
+
+	private:
+		std::string name_;		///<Ник
+		std::string login_;		///<Логин
+		uint64_t id_;		///<Номер пользователя
+		credential::Record credential_;	///<Учётные данные
+		std::shared_ptr<std::list<Message> > messages_;	///<Сообщения пользователю
+		uint64_t lastSequence_;	///<Порядковый номер последнего сообщения
+		size_t messageBytes_;	///<Объём сообщений в списке, байт
+		TimeIndex timeIndex_;	///<Индекс "время -> номер" сообщений
+};
+
+
+
+namespace user {
+	/**
+	Запустить тестирование методов класса
+	*/
+	void test();
 }
\ No newline at end of file
@@ -0,0 +1,188 @@
+#include "UserTable.h"
+
+#include <assert.h>
+
+
+namespace{
+  //Переписывать Ники, когда мёртвые байты занимают больше половины строки
+  const size_t MIN_DEAD_BYTES = 4096;
+}
+
+
+
+UserTable::Id UserTable::insert(const std::string& name, User* user)
+{
+  Id id = 0;
+  if (freeIds_.empty()) {
+    id = static_cast<Id>(users_.size());
+    nameOffsets_.push_back(0);
+    nameLengths_.push_back(0);
+    flags_.push_back(0);
+    users_.push_back(nullptr);
+  }
+  else {
+    id = freeIds_.back();
+    freeIds_.pop_back();
+  }
+
+  nameOffsets_[id] = static_cast<uint32_t>(names_.size());
+  nameLengths_[id] = static_cast<uint32_t>(name.size());
+  names_ += name;
+  flags_[id] = ALIVE;
+  users_[id] = user;
+  return id;
+}
+
+
+
+void UserTable::erase(Id id)
+{
+  if (id >= users_.size() || !(flags_[id] & ALIVE)) {
+    return;
+  }
+  deadBytes_ += nameLengths_[id];
+  nameLengths_[id] = 0;
+  flags_[id] = 0;
+  users_[id] = nullptr;
+  freeIds_.push_back(id);
+
+  if (deadBytes_ > MIN_DEAD_BYTES && deadBytes_ * 2 > names_.size()) {
+    compactNames();
+  }
+}
+
+
+
+void UserTable::rename(Id id, const std::string& name)
+{
+  if (id >= users_.size() || !(flags_[id] & ALIVE)) {
+    return;
+  }
+  //Старый Ник остаётся на месте до следующего переписывания
+  deadBytes_ += nameLengths_[id];
+  nameOffsets_[id] = static_cast<uint32_t>(names_.size());
+  nameLengths_[id] = static_cast<uint32_t>(name.size());
+  names_ += name;
+
+  if (deadBytes_ > MIN_DEAD_BYTES && deadBytes_ * 2 > names_.size()) {
+    compactNames();
+  }
+}
+
+
+
+std::string_view UserTable::getName(Id id) const
+{
+  return std::string_view(names_.data() + nameOffsets_[id], nameLengths_[id]);
+}
+
+
+
+User* UserTable::getUser(Id id) const
+{
+  return users_[id];
+}
+
+
+
+size_t UserTable::size() const
+{
+  return users_.size() - freeIds_.size();
+}
+
+
+
+void UserTable::clear()
+{
+  nameOffsets_.clear();
+  nameLengths_.clear();
+  flags_.clear();
+  users_.clear();
+  freeIds_.clear();
+  names_.clear();
+  deadBytes_ = 0;
+}
+
+
+
+void UserTable::loadNames(std::vector<std::string>& names) const
+{
+  names.clear();
+  names.reserve(size());
+  const char* arena = names_.data();
+  for (size_t id = 0; id < flags_.size(); ++id) {
+    if (flags_[id] & ALIVE) {
+      names.emplace_back(arena + nameOffsets_[id], nameLengths_[id]);
+    }
+  }
+}
+
+
+
+void UserTable::compactNames()
+{
+  std::string names;
+  names.reserve(names_.size() - deadBytes_);
+  for (size_t id = 0; id < flags_.size(); ++id) {
+    if (flags_[id] & ALIVE) {
+      const uint32_t offset = static_cast<uint32_t>(names.size());
+      names.append(names_, nameOffsets_[id], nameLengths_[id]);
+      nameOffsets_[id] = offset;
+    }
+  }
+  names_.swap(names);
+  deadBytes_ = 0;
+}
+
+
+
+//========================================================================================================
+void user_table::test()
+{
+  User first("name_1", "login_1", credential::Record());
+  User second("name_2", "login_2", credential::Record());
+  User third("name_3", "login_3", credential::Record());
+
+  UserTable table;
+  const UserTable::Id id_1 = table.insert("name_1", &first);
+  const UserTable::Id id_2 = table.insert("name_2", &second);
+  assert(table.size() == 2);
+  assert(table.getName(id_1) == "name_1");
+  assert(table.getName(id_2) == "name_2");
+  assert(table.getUser(id_2) == &second);
+
+  //Смена Ника
+  table.rename(id_1, "renamed");
+  assert(table.getName(id_1) == "renamed");
+  assert(table.getName(id_2) == "name_2");
+
+  //Номер удалённого пользователя используется повторно
+  table.erase(id_1);
+  assert(table.size() == 1);
+  const UserTable::Id id_3 = table.insert("name_3", &third);
+  assert(id_3 == id_1);
+  assert(table.getName(id_3) == "name_3");
+
+  //Перебор в порядке номеров
+  std::vector<std::string> names;
+  table.loadNames(names);
+  assert(names.size() == 2);
+  assert(names[0] == "name_3");
+  assert(names[1] == "name_2");
+
+  size_t count = 0;
+  table.forEachUser([&count](User& user) {
+    count += user.getLogin().size();
+  });
+  assert(count == 14);
+
+  //Переписывание Ников сохраняет их
+  for (size_t i = 0; i < 1000; ++i) {
+    table.rename(id_2, "long_nickname_" + std::to_string(i));
+  }
+  assert(table.getName(id_2) == "long_nickname_999");
+  assert(table.getName(id_3) == "name_3");
+
+  table.clear();
+  assert(table.size() == 0);
+}
\ No newline at end of file
@@ -0,0 +1,119 @@
+/**
+\file UserTable.h
+\brief Класс - таблица пользователей, хранящая данные по столбцам
+Часто читаемые при переборе всех пользователей данные (Ники, признаки) лежат
+в плотных массивах по номеру пользователя, Ники - подряд в одной строке.
+Остальные данные пользователя доступны по указателю и при переборе Ников не читаются.
+Номера освободившихся строк таблицы используются повторно.
+*/
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+#include "../User/User.h"
+
+
+class UserTable {
+  public:
+    using Id = uint32_t;  ///<Номер пользователя в таблице
+
+    /**
+    Добавить пользователя
+    \param[in] name Ник пользователя
+    \param[in] user Данные пользователя (должны существовать, пока он в таблице)
+    \return Номер пользователя в таблице
+    */
+    Id insert(const std::string& name, User* user);
+
+    /**
+    Удалить пользователя
+    \param[in] id Номер пользователя в таблице
+    */
+    void erase(Id id);
+
+    /**
+    Сменить Ник пользователя
+    \param[in] id Номер пользователя в таблице
+    \param[in] name Новый Ник
+    */
+    void rename(Id id, const std::string& name);
+
+    /**
+    \param[in] id Номер пользователя в таблице
+    \return Ник пользователя (действителен до следующего изменения таблицы)
+    */
+    std::string_view getName(Id id) const;
+
+    /**
+    \param[in] id Номер пользователя в таблице
+    \return Данные пользователя
+    */
+    User* getUser(Id id) const;
+
+    /**
+    \return Количество пользователей в таблице
+    */
+    size_t size() const;
+
+    /**
+    Удалить всех пользователей
+    */
+    void clear();
+
+    /**
+    Загрузить Ники всех пользователей (в порядке номеров)
+    \param[in] names Вектор в который поместить Ники
+    */
+    void loadNames(std::vector<std::string>& names) const;
+
+    /**
+    Вызвать функцию для данных каждого пользователя (в порядке номеров)
+    \param[in] function Функция вида void(User&)
+    */
+    template <typename Function>
+    void forEachUser(Function function) const;
+
+  private:
+    /**
+    Переписать Ники подряд, убрав место удалённых и старых Ников
+    */
+    void compactNames();
+
+    //Признаки строки таблицы
+    enum Flag : uint8_t {
+      ALIVE = 1 ///<Строка занята пользователем
+    };
+
+    std::vector<uint32_t> nameOffsets_; ///<Начало Ника в names_
+    std::vector<uint32_t> nameLengths_; ///<Длина Ника
+    std::vector<uint8_t> flags_;        ///<Признаки строки
+    std::vector<User*> users_;          ///<Остальные данные пользователя
+    std::vector<Id> freeIds_;           ///<Номера свободных строк
+    std::string names_;                 ///<Ники подряд
+    size_t deadBytes_ = 0;              ///<Байт в names_, не принадлежащих ни одному Нику
+};
+
+
+
+template <typename Function>
+void UserTable::forEachUser(Function function) const
+{
+  for (size_t id = 0; id < users_.size(); ++id) {
+    if (flags_[id] & ALIVE) {
+      function(*users_[id]);
+    }
+  }
+}
+
+
+
+namespace user_table {
+  /**
+  Запустить тестирование методов класса
+  */
+  void test();
+}
\ No newline at end of file
@@ -3,31 +3,113 @@
 #include <netinet/in.h>
 #include <unistd.h>
 #include <string.h>
+#include <thread>
 
 #include "Network/Network.h"
 #include "Handler/Handler.h"
 #include "DataBase/DataBase.h"
+#include "User/User.h"
+#include "Message/Message.h"
+#include "ColdStore/ColdStore.h"
+#include "BloomFilter/BloomFilter.h"
+#include "UserTable/UserTable.h"
+#include "TimeIndex/TimeIndex.h"
+#include "DedupWindow/DedupWindow.h"
+#include "SHA_1/SHA_1_Wrapper.h"
+#include "Credential/Credential.h"
+#include "AuthPool/AuthPool.h"
+#include "Benchmark/Benchmark.h"
+#include "Compactor/Compactor.h"
 
 namespace{
   const int PORT = 7777;
+
+  const std::string SNAPSHOT_DIRECTORY = "snapshot"; //Каталог снимка базы
+  const size_t SNAPSHOT_SEGMENTS = 16;  //Количество сегментов снимка
+  const std::chrono::seconds SNAPSHOT_INTERVAL(60); //Период сохранения снимка
+  const size_t METRICS_INTERVAL = 100;  //Выводить метрики каждые N запросов
+
+  //Политика хранения сообщений для всех пользователей (0 - без ограничения)
+  const size_t RETENTION_MAX_MESSAGES = 0;  //Сообщений в списке пользователя
+  const size_t RETENTION_MAX_BYTES = 0;     //Байт в списке пользователя
+  const std::time_t RETENTION_MAX_AGE = 0;  //Возраст сообщения, секунд
+  const std::chrono::seconds COMPACTION_INTERVAL(10); //Период уплотнения базы
+
+  const std::string COLD_STORE_PATH = "cold_messages";  //Файлы старых сообщений (без поколения)
+  const size_t HOT_MESSAGES_BUDGET = 64 * 1024 * 1024;  //Объём сообщений в памяти, байт
+
+  //Проверка паролей
+  const uint32_t AUTH_COST = 10000;   //Итераций PBKDF2 для новых учётных данных
+  const size_t AUTH_QUEUE = 256;      //Наибольшая очередь пула проверки паролей
 }
 
 
+//Вывести метрики пула проверки паролей
+static void printAuthMetrics();
+
 
-int main()
+
+int main(int argc, char* argv[])
 {
   try{
+    //Режим замеров производительности
+    if (argc > 1 && std::string(argv[1]) == "benchmark"){
+      benchmark::run();
+      return EXIT_SUCCESS;
+    }
+
+    user::test();
+    message::test();
+    cold_store::test();
+    bloom_filter::test();
+    user_table::test();
+    time_index::test();
+    dedup_window::test();
+    sha_1::test();
+    credential::test();
+    auth_pool::test();
     database::test();
-    database::initialize();
+    //Восстановить базу из снимка, если его нет - заполнить начальными значениями.
+    //Снимок есть, но не загружен - не запускаться: сохранение затёрло бы его
+    if (!database::hasSnapshot(SNAPSHOT_DIRECTORY)){
+      database::initialize();
+    }
+    else if (!database::load(SNAPSHOT_DIRECTORY)){
+      std::cerr << "Unable to load snapshot " << SNAPSHOT_DIRECTORY << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    database::Retention retention;
+    retention.maxCount = RETENTION_MAX_MESSAGES;
+    retention.maxBytes = RETENTION_MAX_BYTES;
+    retention.maxAge = RETENTION_MAX_AGE;
+    database::setRetention(retention);
+    //Старые сообщения переносить на диск
+    if (database::openColdStore(COLD_STORE_PATH)){
+      database::setHotBudget(HOT_MESSAGES_BUDGET);
+    }
+    //Снимок сохраняет фоновая задача, а не поток запросов
+    compactor::setSnapshot(SNAPSHOT_DIRECTORY, SNAPSHOT_SEGMENTS, SNAPSHOT_INTERVAL);
+    compactor::start(COMPACTION_INTERVAL);
+    credential::setCost(AUTH_COST);
+    //Одно ядро оставить потоку приёма запросов
+    const unsigned cores = std::thread::hardware_concurrency();
+    auth_pool::start(cores > 1 ? cores - 1 : 1, AUTH_QUEUE);
+
     network::initialize(PORT);
+    size_t requests = 0;
     while(true){
       network::startListen();
       // while(true){
         std::string message = "";
         network::receive(&message);
         handler::handle(message);
+        network::finish();
         message.clear();
       // }
+      if (++requests % METRICS_INTERVAL == 0){
+        printAuthMetrics();
+      }
     }
     network::disconnect();
   }
@@ -37,5 +119,20 @@ int main()
 	catch (...) {
 		std::cerr << "Undefined exception" << std::endl;
 	}
+  auth_pool::stop();
+  compactor::stop();
   return EXIT_SUCCESS;
+}
+
+
+
+static void printAuthMetrics()
+{
+  const auth_pool::Metrics metrics = auth_pool::getMetrics();
+  const uint64_t completed = metrics.completed == 0 ? 1 : metrics.completed;
+  std::cout << "auth: completed " << metrics.completed
+            << ", rejected " << metrics.rejected
+            << ", queued " << metrics.queued << " (max " << metrics.maxQueued << ")"
+            << ", wait " << metrics.waitMicroseconds / completed << " us"
+            << ", work " << metrics.workMicroseconds / completed << " us" << std::endl;
 }
\ No newline at end of file